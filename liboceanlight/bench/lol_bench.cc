@@ -0,0 +1,517 @@
+#include <algorithm>
+#include <chrono>
+#include <config.h>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <liboceanlight/lol_engine.hpp>
+#include <liboceanlight/lol_engine_init.hpp>
+#include <liboceanlight/lol_engine_shutdown.hpp>
+#include <liboceanlight/lol_image_batch.hpp>
+#include <liboceanlight/lol_obj_parser.hpp>
+#include <liboceanlight/lol_thread_pool.hpp>
+#include <liboceanlight/lol_utility.hpp>
+#include <liboceanlight/lol_vertex_welder.hpp>
+#include <liboceanlight/lol_window.hpp>
+#include <map>
+#include <memory>
+#include <stb_image.h>
+#include <string>
+#include <thread>
+#include <tiny_obj_loader.h>
+#include <unordered_map>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif /* _WIN32 */
+
+using liboceanlight::engine::vertex;
+using clock_type = std::chrono::high_resolution_clock;
+
+namespace
+{
+	double elapsed_ms(clock_type::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(clock_type::now() -
+														 start)
+			.count();
+	}
+
+	void report(const std::string& name,
+				double ms,
+				size_t items,
+				const std::string& unit = "M/s")
+	{
+		std::cout << std::fixed << std::setprecision(2) << "  " << std::left
+				  << std::setw(28) << name << std::right << std::setw(10)
+				  << ms << " ms " << std::setw(10)
+				  << static_cast<double>(items) / ms / 1000.0 << " " << unit
+				  << "\n"
+				  << std::defaultfloat;
+	}
+
+	/* Peak resident set so far in MiB, 0 where unsupported */
+	long peak_rss_mib()
+	{
+#ifndef _WIN32
+		rusage usage {};
+		getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+		return usage.ru_maxrss >> 20;
+#else
+		return usage.ru_maxrss >> 10;
+#endif /* __APPLE__ */
+#else
+		return 0;
+#endif /* _WIN32 */
+	}
+
+	/* Per-corner triangle soup of a grid, as an OBJ expands it */
+	std::vector<vertex> make_grid_soup(uint32_t n)
+	{
+		std::vector<vertex> corners;
+		corners.reserve(static_cast<size_t>(n) * n * 6);
+
+		auto corner = [n](uint32_t x, uint32_t y) {
+			vertex v {};
+			v.pos = {static_cast<float>(x), 0.0f, static_cast<float>(y)};
+			v.color = {1.0f, 1.0f, 1.0f};
+			v.texcoord = {static_cast<float>(x) / static_cast<float>(n),
+						  static_cast<float>(y) / static_cast<float>(n)};
+			return v;
+		};
+
+		for (uint32_t y {0}; y < n; ++y)
+		{
+			for (uint32_t x {0}; x < n; ++x)
+			{
+				corners.push_back(corner(x, y));
+				corners.push_back(corner(x, y + 1));
+				corners.push_back(corner(x + 1, y));
+				corners.push_back(corner(x + 1, y));
+				corners.push_back(corner(x, y + 1));
+				corners.push_back(corner(x + 1, y + 1));
+			}
+		}
+
+		return corners;
+	}
+
+	int bench_weld(int argc, char** argv)
+	{
+		const uint32_t n {argc > 0 ? static_cast<uint32_t>(std::atoi(argv[0]))
+								   : 1000u};
+		const auto corners {make_grid_soup(n)};
+		std::cout << "weld: " << corners.size() << " indices, "
+				  << static_cast<size_t>(n + 1) * (n + 1)
+				  << " unique vertices\n";
+
+		std::vector<vertex> map_vertices;
+		std::vector<uint32_t> map_indices;
+		auto start {clock_type::now()};
+		{
+			std::unordered_map<vertex, uint32_t> unique_vertices {};
+			for (const auto& v : corners)
+			{
+				if (unique_vertices.count(v) == 0)
+				{
+					unique_vertices[v] = static_cast<uint32_t>(
+						map_vertices.size());
+					map_vertices.push_back(v);
+				}
+
+				map_indices.push_back(unique_vertices[v]);
+			}
+		}
+		report("std::unordered_map", elapsed_ms(start), corners.size());
+
+		std::vector<vertex> weld_vertices;
+		std::vector<uint32_t> weld_indices;
+		start = clock_type::now();
+		{
+			liboceanlight::models::vertex_welder welder {weld_vertices,
+														 corners.size()};
+			weld_indices.reserve(corners.size());
+			for (const auto& v : corners)
+			{
+				weld_indices.push_back(welder.weld(v));
+			}
+		}
+		report("vertex_welder", elapsed_ms(start), corners.size());
+
+		if (map_vertices.size() != weld_vertices.size() ||
+			map_indices != weld_indices)
+		{
+			std::cerr << "weld: results differ\n";
+			return EXIT_FAILURE;
+		}
+
+		return EXIT_SUCCESS;
+	}
+
+	/* Scanned-grid style OBJ with positions, texcoords and normals */
+	void write_grid_obj(const std::string& path, uint32_t n)
+	{
+		std::ofstream file {path};
+		for (uint32_t y {0}; y <= n; ++y)
+		{
+			for (uint32_t x {0}; x <= n; ++x)
+			{
+				file << "v " << x * 0.013f << " " << (x ^ y) % 7 * 0.001f
+					 << " " << y * 0.013f << "\n";
+			}
+		}
+
+		for (uint32_t y {0}; y <= n; ++y)
+		{
+			for (uint32_t x {0}; x <= n; ++x)
+			{
+				file << "vt " << static_cast<float>(x) / n << " "
+					 << static_cast<float>(y) / n << "\n";
+			}
+		}
+
+		file << "vn 0 1 0\n";
+		for (uint32_t y {0}; y < n; ++y)
+		{
+			for (uint32_t x {0}; x < n; ++x)
+			{
+				const uint32_t i {y * (n + 1) + x + 1};
+				const uint32_t j {i + n + 1};
+				file << "f " << i << "/" << i << "/1 " << j << "/" << j
+					 << "/1 " << i + 1 << "/" << i + 1 << "/1\n";
+				file << "f " << i + 1 << "/" << i + 1 << "/1 " << j << "/"
+					 << j << "/1 " << j + 1 << "/" << j + 1 << "/1\n";
+			}
+		}
+	}
+
+	/* The loader used before lol_obj_parser: tinyobj, then welding */
+	void load_tinyobj(const std::string& path,
+					  std::vector<vertex>& vertices,
+					  std::vector<uint32_t>& indices)
+	{
+		tinyobj::attrib_t attrib;
+		std::vector<tinyobj::shape_t> shapes;
+		std::vector<tinyobj::material_t> materials;
+		std::string warn, err;
+
+		if (!tinyobj::LoadObj(
+				&attrib, &shapes, &materials, &warn, &err, path.c_str()))
+		{
+			throw std::runtime_error("tinyobj failed: " + err);
+		}
+
+		size_t index_count {0};
+		for (const auto& shape : shapes)
+		{
+			index_count += shape.mesh.indices.size();
+		}
+
+		liboceanlight::models::vertex_welder welder {vertices, index_count};
+		for (const auto& shape : shapes)
+		{
+			for (const auto& index : shape.mesh.indices)
+			{
+				vertex v {};
+				v.pos = {attrib.vertices[3 * index.vertex_index + 0],
+						 attrib.vertices[3 * index.vertex_index + 1],
+						 attrib.vertices[3 * index.vertex_index + 2]};
+				v.texcoord = {
+					attrib.texcoords[2 * index.texcoord_index + 0],
+					1.0f - attrib.texcoords[2 * index.texcoord_index + 1]};
+				v.color = {1.0f, 1.0f, 1.0f};
+				indices.push_back(welder.weld(v));
+			}
+		}
+	}
+
+	/* The same split, parse and weld stages load_model_files runs */
+	void load_chunked(const std::string& path,
+					  liboceanlight::thread_pool& pool,
+					  size_t chunk_bytes,
+					  std::vector<vertex>& vertices,
+					  std::vector<uint32_t>& indices)
+	{
+		liboceanlight::mapped_file file {path};
+		std::vector<std::future<liboceanlight::models::obj_chunk>> jobs;
+		for (auto range :
+			 liboceanlight::models::split_obj_chunks(file.bytes(),
+													 chunk_bytes))
+		{
+			jobs.push_back(pool.submit([range, &path] {
+				return liboceanlight::models::parse_obj_chunk(range, path);
+			}));
+		}
+
+		std::vector<liboceanlight::models::obj_chunk> chunks;
+		for (auto& job : jobs)
+		{
+			chunks.push_back(job.get());
+		}
+
+		liboceanlight::models::weld_obj_chunks(
+			chunks, path, vertices, indices);
+	}
+
+	/* lol_bench obj [grid size] [all|tinyobj|stream|chunked]. Run one
+	 * variant at a time for a meaningful peak RSS. */
+	int bench_obj(int argc, char** argv)
+	{
+		const uint32_t n {argc > 0 ? static_cast<uint32_t>(std::atoi(argv[0]))
+								   : 1000u};
+		const std::string variant {argc > 1 ? argv[1] : "all"};
+		const auto path {(std::filesystem::temp_directory_path() /
+						  "lol_bench_grid.obj")
+							 .string()};
+
+		write_grid_obj(path, n);
+		const auto bytes {std::filesystem::file_size(path)};
+		std::cout << "obj: " << bytes / (1 << 20) << " MiB, "
+				  << static_cast<size_t>(n) * n * 6 << " indices\n";
+
+		liboceanlight::thread_pool pool {0};
+		std::map<std::string,
+				 std::function<void(std::vector<vertex>&,
+									std::vector<uint32_t>&)>>
+			variants {
+				{"tinyobj",
+				 [&](auto& vertices, auto& indices) {
+					 load_tinyobj(path, vertices, indices);
+				 }},
+				{"stream",
+				 [&](auto& vertices, auto& indices) {
+					 liboceanlight::models::load_obj(path, vertices, indices);
+				 }},
+				{"chunked", [&](auto& vertices, auto& indices) {
+					 load_chunked(path, pool, 8 << 20, vertices, indices);
+				 }}};
+
+		int rv {EXIT_SUCCESS};
+		size_t expected_vertices {0};
+		for (const auto& [name, load] : variants)
+		{
+			if (variant != "all" && variant != name)
+			{
+				continue;
+			}
+
+			std::vector<vertex> vertices;
+			std::vector<uint32_t> indices;
+			auto start {clock_type::now()};
+			load(vertices, indices);
+			report(name, elapsed_ms(start), bytes, "MB/s");
+
+			if (expected_vertices != 0 && vertices.size() != expected_vertices)
+			{
+				std::cerr << "obj: " << name << " vertex count differs\n";
+				rv = EXIT_FAILURE;
+			}
+			expected_vertices = vertices.size();
+		}
+
+		std::cout << "  peak RSS " << peak_rss_mib() << " MiB\n";
+		std::filesystem::remove(path);
+		return rv;
+	}
+
+	void report_textures(const std::string& name,
+						 double ms,
+						 size_t bytes,
+						 size_t count)
+	{
+		report(name, ms, bytes, "MB/s");
+		std::cout << std::fixed << std::setprecision(2) << "  " << std::left
+				  << std::setw(28) << "" << std::right << std::setw(24)
+				  << static_cast<double>(count) / ms * 1000.0
+				  << " textures/s\n"
+				  << std::defaultfloat;
+	}
+
+	/* lol_bench textures [count] [image]. Decodes count copies of one
+	 * image into staging memory, one after another with a staging
+	 * allocation each as create_texture_img does, then as one batch on
+	 * the worker pool as create_textures does. No GPU is involved. */
+	int bench_textures(int argc, char** argv)
+	{
+		const size_t count {argc > 0 ? static_cast<size_t>(std::atoi(argv[0]))
+									 : 64u};
+		const std::string path {argc > 1 ? argv[1]
+										 : TEXTURE_PATH "viking_room.png"};
+
+		int width {}, height {}, channels {};
+		if (!stbi_info(path.c_str(), &width, &height, &channels))
+		{
+			std::cerr << "textures: cannot read " << path << "\n";
+			return EXIT_FAILURE;
+		}
+
+		const size_t image_bytes {static_cast<size_t>(width) * height * 4};
+		std::cout << "textures: " << count << " x " << width << "x" << height
+				  << " " << path << "\n";
+
+		std::unique_ptr<uint8_t[]> first;
+		auto start {clock_type::now()};
+		for (size_t i {0}; i < count; ++i)
+		{
+			stbi_uc* pixels {stbi_load(
+				path.c_str(), &width, &height, &channels, STBI_rgb_alpha)};
+			auto staging {std::make_unique_for_overwrite<uint8_t[]>(
+				image_bytes)};
+			std::memcpy(staging.get(), pixels, image_bytes);
+			stbi_image_free(pixels);
+			if (i == 0)
+			{
+				first = std::move(staging);
+			}
+		}
+		report_textures(
+			"per texture", elapsed_ms(start), image_bytes * count, count);
+
+		liboceanlight::thread_pool pool {0};
+		std::vector<liboceanlight::textures::staged_image> images(count);
+		for (auto& image : images)
+		{
+			image.path = path;
+		}
+
+		start = clock_type::now();
+		liboceanlight::textures::read_image_headers(images, false, &pool);
+		const size_t total {
+			liboceanlight::textures::layout_image_batch(images, 16)};
+		auto staging {std::make_unique_for_overwrite<uint8_t[]>(total)};
+		liboceanlight::textures::decode_image_batch(
+			images, {staging.get(), total}, &pool);
+		report_textures("batch (" + std::to_string(pool.size()) + " threads)",
+						elapsed_ms(start),
+						image_bytes * count,
+						count);
+
+		for (const auto& image : images)
+		{
+			if (!image.decoded ||
+				std::memcmp(staging.get() + image.offset,
+							first.get(),
+							image_bytes) != 0)
+			{
+				std::cerr << "textures: results differ\n";
+				return EXIT_FAILURE;
+			}
+		}
+
+		return EXIT_SUCCESS;
+	}
+
+	/* lol_bench record [copies] [threads] [frames]. Records the scene,
+	 * its model list repeated copies times, frames times on each of 1 to
+	 * threads recording threads, without submitting. Needs a display and
+	 * a Vulkan device, and is skipped without them. */
+	int bench_record(int argc, char** argv)
+	{
+		const size_t copies {argc > 0 ? static_cast<size_t>(std::atoi(argv[0]))
+									  : 1000u};
+		const unsigned int max_threads {
+			argc > 1 ? static_cast<unsigned int>(std::atoi(argv[1]))
+					 : std::max(std::thread::hardware_concurrency(), 1u)};
+		const int frames {argc > 2 ? std::atoi(argv[2]) : 100};
+
+		std::unique_ptr<liboceanlight::window> window;
+		liboceanlight::engine::engine_data eng_data;
+		eng_data.async_streaming = false;
+		eng_data.hot_reload_enabled = false;
+		try
+		{
+			window = std::make_unique<liboceanlight::window>(800, 600);
+			liboceanlight::engine::init(*window, eng_data);
+		}
+		catch (const std::exception& e)
+		{
+			std::cout << "record: skipped, " << e.what() << "\n";
+			return EXIT_SUCCESS;
+		}
+
+		/* The copies share the scene's geometry; only what recording
+		 * reads is kept */
+		auto scene {std::move(eng_data.model_list)};
+		eng_data.model_list.clear();
+		for (size_t i {0}; i < copies; ++i)
+		{
+			for (const auto& model : scene)
+			{
+				auto& copy {eng_data.model_list.emplace_back(model)};
+				copy.vertices = {};
+				copy.indices = {};
+			}
+		}
+
+		const size_t model_count {eng_data.model_list.size()};
+		std::cout << "record: " << model_count << " models, " << frames
+				  << " frames\n";
+
+		liboceanlight::engine::update_uniform_buffer(
+			eng_data, *window, eng_data.current_frame, 0.0);
+		auto cmd_buffer {
+			eng_data.command_buffers.at(eng_data.current_frame)};
+		eng_data.record_min_models = 1;
+		for (unsigned int threads {1}; threads <= max_threads; ++threads)
+		{
+			liboceanlight::engine::cleanup_record_pools(eng_data);
+			eng_data.record_threads = threads;
+			liboceanlight::engine::create_record_pools(eng_data);
+
+			auto start {clock_type::now()};
+			for (int frame {0}; frame < frames; ++frame)
+			{
+				vkResetCommandBuffer(cmd_buffer, 0);
+				liboceanlight::engine::record_cmd_buffer(
+					eng_data, cmd_buffer, 0);
+			}
+			report(std::to_string(threads) + " threads",
+				   elapsed_ms(start),
+				   model_count * static_cast<size_t>(frames),
+				   "M models/s");
+		}
+
+		eng_data.model_list = std::move(scene);
+		liboceanlight::engine::shutdown(eng_data);
+		return EXIT_SUCCESS;
+	}
+} /* namespace */
+
+int main(int argc, char** argv)
+{
+	const std::map<std::string, std::function<int(int, char**)>> benches {
+		{"obj", bench_obj},
+		{"record", bench_record},
+		{"textures", bench_textures},
+		{"weld", bench_weld}};
+
+	if (argc < 2)
+	{
+		int rv {EXIT_SUCCESS};
+		for (const auto& [name, bench] : benches)
+		{
+			rv |= bench(0, nullptr);
+		}
+		return rv;
+	}
+
+	const auto bench {benches.find(argv[1])};
+	if (bench == benches.end())
+	{
+		std::cerr << "Usage: lol_bench [";
+		for (const auto& [name, func] : benches)
+		{
+			std::cerr << " " << name;
+		}
+		std::cerr << " ] [args...]\n";
+		return EXIT_FAILURE;
+	}
+
+	return bench->second(argc - 2, argv + 2);
+}
@@ -0,0 +1,61 @@
+#ifndef LIBOCEANLIGHT_ASSET_STREAM_HPP_INCLUDED
+#define LIBOCEANLIGHT_ASSET_STREAM_HPP_INCLUDED
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace liboceanlight
+{
+	/* Hands assets decoded on a loader thread to the render thread. The
+	 * loader pushes each asset as an upload to run between frames, which
+	 * returns the swap to run once no frame in flight uses what it
+	 * replaces. */
+	class asset_stream
+	{
+	  public:
+		using swap_task = std::move_only_function<void()>;
+		using upload_task = std::move_only_function<swap_task()>;
+
+		struct staged_asset
+		{
+			size_t bytes {0};
+			upload_task upload;
+		};
+
+	  private:
+		std::mutex ready_mtx;
+		std::deque<staged_asset> ready;
+		size_t outstanding {0};
+		std::chrono::steady_clock::time_point start_time;
+
+		/* Last, so it is joined before the queue goes away */
+		std::jthread loader;
+
+	  public:
+		using load_task =
+			std::move_only_function<void(std::stop_token, asset_stream&)>;
+
+		/* Runs load on its own thread, expecting asset_count pushes or
+		 * skips. load should return early once stop is requested. */
+		asset_stream(size_t asset_count, load_task load);
+		asset_stream(const asset_stream&) = delete;
+		asset_stream& operator=(const asset_stream&) = delete;
+
+		/* LOADER THREAD */
+		void push(staged_asset);
+		void skip();
+
+		/* RENDER THREAD */
+		/* At least one asset when any is ready, then more while their
+		 * total stays within byte_budget */
+		std::vector<staged_asset> take(size_t byte_budget);
+		bool done();
+		double elapsed_ms() const;
+	};
+} /* namespace liboceanlight */
+#endif /* LIBOCEANLIGHT_ASSET_STREAM_HPP_INCLUDED */
@@ -0,0 +1,41 @@
+#ifndef LIBOCEANLIGHT_BLOCK_COMPRESS_HPP_INCLUDED
+#define LIBOCEANLIGHT_BLOCK_COMPRESS_HPP_INCLUDED
+#include <array>
+#include <cstdint>
+#include <liboceanlight/lol_mipmap.hpp>
+#include <liboceanlight/lol_thread_pool.hpp>
+#include <span>
+#include <vulkan/vulkan_core.h>
+
+namespace liboceanlight::textures
+{
+	/* What the texels mean decides the block format */
+	enum class texture_kind
+	{
+		color, /* sRGB RGBA, BC7 */
+		normal, /* XY in red and green, BC5 */
+		mask /* one channel in red, BC4 */
+	};
+
+	VkFormat block_format(texture_kind);
+	size_t block_bytes(texture_kind);
+
+	/* 4x4 RGBA8 texels, row by row */
+	using texel_block = std::array<uint8_t, 64>;
+
+	/* BC7 mode 6: one subset, RGBA endpoints with a p-bit each and 4 bit
+	 * indices, fit along the principal axis then refined by least
+	 * squares */
+	std::array<uint8_t, 16> encode_bc7_block(const texel_block&);
+
+	/* BC4 of one channel, 0 red, 1 green */
+	std::array<uint8_t, 8> encode_bc4_block(const texel_block&,
+											size_t channel);
+
+	/* Every level of chain as kind's blocks, edge texels repeated to fill
+	 * partial blocks. Rows of blocks are encoded on pool when given. */
+	mip_chain compress_mip_chain(const mip_chain&,
+								 texture_kind,
+								 liboceanlight::thread_pool*);
+} /* namespace liboceanlight::textures */
+#endif /* LIBOCEANLIGHT_BLOCK_COMPRESS_HPP_INCLUDED */
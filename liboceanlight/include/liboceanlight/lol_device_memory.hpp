@@ -0,0 +1,129 @@
+#ifndef LIBOCEANLIGHT_DEVICE_MEMORY_HPP_INCLUDED
+#define LIBOCEANLIGHT_DEVICE_MEMORY_HPP_INCLUDED
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <liboceanlight/lol_range_allocator.hpp>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace liboceanlight
+{
+	/* What a block of device memory is shared between. Buffers and
+	 * optimally tiled images never share a block, so no two of them can
+	 * sit within bufferImageGranularity of each other. */
+	enum class memory_usage : uint8_t
+	{
+		buffer,	   /* buffers and linear images */
+		image,	   /* optimally tiled images */
+		transient, /* staging, freed right after its copy */
+	};
+
+	/* What an allocation is for, only to account for memory by */
+	enum class memory_category : uint8_t
+	{
+		geometry,
+		textures,
+		attachments,
+		staging,
+		uniforms,
+	};
+
+	constexpr std::array memory_category_names {
+		"geometry", "textures", "attachments", "staging", "uniforms"};
+	constexpr size_t memory_category_count {memory_category_names.size()};
+
+	using memory_category_stats = struct lol_memory_category_stats_struct
+	{
+		VkDeviceSize bytes {0};
+		uint32_t allocations {0};
+	};
+
+	using device_allocation = struct lol_device_allocation_struct
+	{
+		VkDeviceMemory memory {nullptr};
+		VkDeviceSize offset {0};
+		VkDeviceSize size {0};
+		void* mapped {nullptr}; /* at offset, when host visible */
+		uint32_t block {UINT32_MAX}; /* UINT32_MAX when dedicated */
+		uint32_t type_index {0};
+		memory_category category {memory_category::geometry};
+	};
+
+	using memory_heap_stats = struct lol_memory_heap_stats_struct
+	{
+		VkDeviceSize heap_size {0};
+		VkDeviceSize allocated {0}; /* in VkDeviceMemory objects */
+		VkDeviceSize used {0};		/* by resources within them */
+		uint32_t memory_objects {0};
+		uint32_t allocations {0};
+		/* What the process may and does use of the heap, per
+		 * VK_EXT_memory_budget. heap_size and allocated without it. */
+		VkDeviceSize budget {0};
+		VkDeviceSize usage {0};
+	};
+
+	/* Carves blocks of block_size bytes per memory type into the
+	 * allocations of buffers and images, so vkAllocateMemory is called
+	 * once per block rather than per resource. Host visible blocks stay
+	 * mapped. Allocations larger than half a block get their own memory
+	 * object. */
+	class device_allocator
+	{
+		struct block
+		{
+			VkDeviceMemory memory {nullptr};
+			void* mapped {nullptr};
+			uint32_t type_index {0};
+			memory_usage usage {memory_usage::buffer};
+			range_allocator ranges;
+			linear_allocator transient;
+			uint32_t allocations {0};
+		};
+
+		VkDevice device {nullptr};
+		VkPhysicalDeviceMemoryProperties props {};
+		VkDeviceSize block_size {0};
+		std::vector<block> blocks; /* freed ones keep their slot */
+		std::array<memory_heap_stats, VK_MAX_MEMORY_HEAPS> dedicated {};
+		std::array<memory_category_stats, memory_category_count>
+			categories {};
+		mutable std::mutex blocks_mtx;
+
+		VkDeviceMemory allocate_memory(uint32_t type_index,
+									   VkDeviceSize size,
+									   void*& mapped);
+		void free_memory(VkDeviceMemory, void* mapped);
+		bool sub_allocate(block&,
+						  const VkMemoryRequirements&,
+						  device_allocation&);
+		uint32_t heap_of(uint32_t type_index) const;
+
+	  public:
+		device_allocator(VkDevice,
+						 const VkPhysicalDeviceMemoryProperties&,
+						 VkDeviceSize block_size);
+		device_allocator(const device_allocator&) = delete;
+		device_allocator& operator=(const device_allocator&) = delete;
+		~device_allocator() noexcept;
+
+		/* The first memory type in type_bits with every one of flags */
+		uint32_t find_type(uint32_t type_bits,
+						   VkMemoryPropertyFlags flags) const;
+
+		device_allocation allocate(const VkMemoryRequirements&,
+								   VkMemoryPropertyFlags,
+								   memory_usage,
+								   memory_category);
+		/* Resets alloc, which may be empty */
+		void free(device_allocation& alloc);
+
+		/* One entry per memory heap */
+		std::vector<memory_heap_stats> heap_stats() const;
+		/* Indexed by memory_category */
+		std::array<memory_category_stats, memory_category_count>
+		category_stats() const;
+	};
+} /* namespace liboceanlight */
+#endif /* LIBOCEANLIGHT_DEVICE_MEMORY_HPP_INCLUDED */
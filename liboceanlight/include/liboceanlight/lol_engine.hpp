@@ -1,11 +1,25 @@
 #ifndef LIBOCEANLIGHT_ENGINE_HPP_INCLUDED
 #define LIBOCEANLIGHT_ENGINE_HPP_INCLUDED
 #include <array>
+#include <chrono>
 #include <config.h>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/glm.hpp>
 #include <glm/gtx/hash.hpp>
+#include <liboceanlight/lol_asset_stream.hpp>
+#include <liboceanlight/lol_device_memory.hpp>
+#include <liboceanlight/lol_file_watcher.hpp>
+#include <liboceanlight/lol_mipmap.hpp>
+#include <liboceanlight/lol_range_allocator.hpp>
+#include <liboceanlight/lol_thread_pool.hpp>
+#include <liboceanlight/lol_vertex_format.hpp>
 #include <liboceanlight/lol_window.hpp>
+#include <memory>
+#include <span>
+#include <string>
 #include <vector>
 #include <vulkan/vulkan_core.h>
 
@@ -24,49 +38,120 @@ namespace liboceanlight::engine
 		glm::vec3 color;
 		glm::vec2 texcoord;
 
-		static VkVertexInputBindingDescription get_binding_desc()
+		static constexpr const char* shader {"vertex_shader.spv"};
+
+		static constexpr std::array<vertex_attribute, 3> layout()
 		{
-			VkVertexInputBindingDescription binding_desc {};
-			binding_desc.binding = 0;
-			binding_desc.stride = sizeof(lol_vertex_struct);
-			binding_desc.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-			return binding_desc;
+			return {{{0,
+					  VK_FORMAT_R32G32B32_SFLOAT,
+					  offsetof(lol_vertex_struct, pos)},
+					 {1,
+					  VK_FORMAT_R32G32B32_SFLOAT,
+					  offsetof(lol_vertex_struct, color)},
+					 {2,
+					  VK_FORMAT_R32G32_SFLOAT,
+					  offsetof(lol_vertex_struct, texcoord)}}};
+		}
+
+		static constexpr VkVertexInputBindingDescription get_binding_desc()
+		{
+			return make_binding_desc<lol_vertex_struct>();
 		};
 
-		static std::array<VkVertexInputAttributeDescription, 3>
+		static constexpr std::array<VkVertexInputAttributeDescription, 3>
 		get_attribute_descs()
 		{
-			std::array<VkVertexInputAttributeDescription, 3>
-				attribute_descs {};
-
-			attribute_descs[0].binding = 0;
-			attribute_descs[0].location = 0;
-			attribute_descs[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-			attribute_descs[0].offset = offsetof(lol_vertex_struct, pos);
-
-			attribute_descs[1].binding = 0;
-			attribute_descs[1].location = 1;
-			attribute_descs[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-			attribute_descs[1].offset = offsetof(lol_vertex_struct, color);
-
-			attribute_descs[2].binding = 0;
-			attribute_descs[2].location = 2;
-			attribute_descs[2].format = VK_FORMAT_R32G32_SFLOAT;
-			attribute_descs[2].offset = offsetof(lol_vertex_struct, texcoord);
-			return attribute_descs;
+			return make_attribute_descs<lol_vertex_struct>();
 		};
 	};
+
+	/* 12 bytes: positions and texcoords are unorm16 within the mesh
+	 * bounds (dequantized with vertex_quantization) and the color is
+	 * dropped since loaded meshes are always white */
+	using packed_vertex = struct lol_packed_vertex_struct
+	{
+		std::array<uint16_t, 4> pos;
+		std::array<uint16_t, 2> texcoord;
+
+		static constexpr const char* shader {"vertex_shader_packed.spv"};
+
+		static constexpr std::array<vertex_attribute, 2> layout()
+		{
+			return {{{0,
+					  VK_FORMAT_R16G16B16A16_UNORM,
+					  offsetof(lol_packed_vertex_struct, pos)},
+					 {2,
+					  VK_FORMAT_R16G16_UNORM,
+					  offsetof(lol_packed_vertex_struct, texcoord)}}};
+		}
+
+		static constexpr VkVertexInputBindingDescription get_binding_desc()
+		{
+			return make_binding_desc<lol_packed_vertex_struct>();
+		};
+
+		static constexpr std::array<VkVertexInputAttributeDescription, 2>
+		get_attribute_descs()
+		{
+			return make_attribute_descs<lol_packed_vertex_struct>();
+		};
+	};
+
+	constexpr uint32_t vertex_stride(vertex_format format)
+	{
+		return format == vertex_format::packed ? sizeof(packed_vertex)
+											   : sizeof(vertex);
+	}
+
+	constexpr uint32_t index_size(VkIndexType type)
+	{
+		return type == VK_INDEX_TYPE_UINT16 ? 2 : 4;
+	}
 } /* namespace liboceanlight::engine */
 
 namespace liboceanlight::models
 {
+	/* One vkCmdDrawIndexed worth of a model's index buffer */
+	using draw_range = struct lol_draw_range_struct
+	{
+		uint32_t first_index {0};
+		uint32_t index_count {0};
+		int32_t vertex_offset {0};
+	};
+
+	/* Bytes of one of the geometry pools, empty when size is 0 */
+	using geometry_range = struct lol_geometry_range_struct
+	{
+		VkDeviceSize offset {0};
+		VkDeviceSize size {0};
+	};
+
+	/* One level of detail: a run of the model's indices sharing its
+	 * vertices, error is the object space distance to the full mesh.
+	 * first_draw and draw_count select its entries in draws. */
+	using mesh_lod = struct lol_mesh_lod_struct
+	{
+		uint32_t first_index {0};
+		uint32_t index_count {0};
+		float error {0.0f};
+		uint32_t first_draw {0};
+		uint32_t draw_count {0};
+	};
+
 	using lol_model = struct lol_model_struct
 	{
 		std::string name;
 		std::vector<liboceanlight::engine::vertex> vertices;
 		std::vector<uint32_t> indices;
-		VkBuffer vertex_buffer, index_buffer;
-		VkDeviceMemory vertex_buffer_mem, index_buffer_mem;
+		std::vector<mesh_lod> lods;
+		glm::vec4 bounds {0.0f}; /* center and radius */
+		VkIndexType index_type {VK_INDEX_TYPE_UINT32};
+		std::vector<draw_range> draws;
+		liboceanlight::engine::vertex_format format {
+			liboceanlight::engine::vertex_format::full};
+		liboceanlight::engine::vertex_quantization quantization {};
+		uint32_t material_index {0};
+		geometry_range vertex_range, index_range;
 	};
 }; /* namespace liboceanlight::models */
 
@@ -95,6 +180,90 @@ namespace liboceanlight::engine
 		glm::mat4 proj {glm::mat4(1.0f)};
 	};
 
+	/* One slot of the bindless texture array. Until img_view is made the
+	 * slot samples the placeholder texture. With texture residency img
+	 * holds the levels of source from base_level down. */
+	using texture = struct lol_texture_struct
+	{
+		std::string path;
+		VkImage img {nullptr};
+		liboceanlight::device_allocation img_mem {};
+		VkImageView img_view {nullptr};
+		uint32_t mip_levels {1};
+		VkFormat format {VK_FORMAT_R8G8B8A8_SRGB};
+		uint32_t base_level {0};
+		std::shared_ptr<const textures::mip_chain> source;
+		bool swap_pending {false}; /* a replacement is uploading */
+	};
+
+	/* Bytes of the staging ring one submission copies from */
+	using staging_region = struct lol_staging_region_struct
+	{
+		VkBuffer buffer {nullptr};
+		VkDeviceSize offset {0};
+		uint8_t* data {nullptr};
+	};
+
+	/* The serial of the submission an upload goes out with */
+	using upload_ticket = uint64_t;
+
+	/* A submitted upload batch and what it frees once it has run */
+	using pending_upload = struct lol_pending_upload_struct
+	{
+		upload_ticket serial {0};
+		VkCommandBuffer cmd_buffer {nullptr};
+		VkCommandBuffer transfer_cmd_buffer {nullptr};
+		std::vector<std::pair<VkBuffer, liboceanlight::device_allocation>>
+			buffers;
+	};
+
+	/* One buffer the geometry of every model shares, in ranges handed
+	 * out and freed as models come and go, so a frame binds it once.
+	 * Replaced by a larger copy when a range no longer fits. */
+	using geometry_pool = struct lol_geometry_pool_struct
+	{
+		VkBuffer buffer {nullptr};
+		liboceanlight::device_allocation mem {};
+		liboceanlight::range_allocator ranges;
+		VkBufferUsageFlags usage {0};
+		VkMemoryPropertyFlags props {0};
+	};
+
+	/* std430 layout of one material buffer entry */
+	using material = struct lol_material_struct
+	{
+		glm::vec4 base_color {1.0f};
+		uint32_t texture_index {0};
+		std::array<uint32_t, 3> padding {};
+	};
+	static_assert(sizeof(material) == 32);
+
+	/* What snapshot_memory saw */
+	using memory_snapshot = struct lol_memory_snapshot_struct
+	{
+		std::array<liboceanlight::memory_category_stats,
+				   liboceanlight::memory_category_count>
+			categories {};
+		std::vector<liboceanlight::memory_heap_stats> heaps;
+		bool driver_budget {false}; /* from VK_EXT_memory_budget */
+	};
+
+	/* A recording thread's command pool for one frame in flight, reset
+	 * whole when the frame comes round again */
+	using record_slot = struct lol_record_slot_struct
+	{
+		VkCommandPool pool {nullptr};
+		VkCommandBuffer cmd_buffer {nullptr}; /* secondary */
+	};
+
+	/* A command buffer kept recorded for one frame in flight and
+	 * swapchain image */
+	using recorded_frame = struct lol_recorded_frame_struct
+	{
+		VkCommandBuffer cmd_buffer {nullptr};
+		bool dirty {true};
+	};
+
 	using engine_data = struct lol_engine_data_struct
 	{
 		/* INSTANCE */
@@ -114,6 +283,42 @@ namespace liboceanlight::engine
 		VkPhysicalDeviceProperties device_props {};
 		VkPhysicalDeviceFeatures supported_device_features {};
 
+		/* MEMORY */
+		VkPhysicalDeviceMemoryProperties memory_props {};
+		VkDeviceSize memory_block_size {64ull << 20};
+		std::unique_ptr<liboceanlight::device_allocator> allocator;
+		/* Enabled when the device has it */
+		bool memory_budget_supported {false};
+		/* Of the VRAM budget, kept out of vram_headroom for whatever is
+		 * allocated next */
+		VkDeviceSize memory_reserve {64ull << 20};
+		/* Seconds between log_memory printouts, 0 for none */
+		double memory_log_interval {0.0};
+		std::chrono::steady_clock::time_point memory_logged {};
+		/* Write geometry straight into device local memory rather than
+		 * stage it, when the host can map all of that memory */
+		bool direct_device_writes {true};
+		/* The heap of device local memory the host can map, 0 without */
+		VkDeviceSize mappable_vram {0};
+
+		/* STAGING */
+		VkDeviceSize staging_ring_size {64ull << 20};
+		VkBuffer staging_buffer {nullptr};
+		liboceanlight::device_allocation staging_buffer_mem {};
+		liboceanlight::ring_allocator staging_ring;
+
+		/* UPLOAD */
+		upload_ticket upload_serial {0};
+		VkCommandBuffer upload_cmd {nullptr};	/* of the open batch */
+		VkCommandBuffer transfer_cmd {nullptr}; /* likewise, when used */
+		uint32_t upload_depth {0};
+		/* Signalled with the serial of each submission on its queue */
+		VkSemaphore transfer_timeline {nullptr};
+		VkSemaphore upload_timeline {nullptr};
+		std::vector<std::pair<VkBuffer, liboceanlight::device_allocation>>
+			upload_garbage;
+		std::deque<pending_upload> pending_uploads;
+
 		/* SURFACE */
 		VkSurfaceKHR window_surface {nullptr};
 		VkSurfaceCapabilitiesKHR capabilities {};
@@ -122,6 +327,9 @@ namespace liboceanlight::engine
 		/* QUEUE */
 		uint32_t graphics_queue_index {UINT32_MAX};
 		VkQueue graphics_queue {nullptr};
+		bool dedicated_transfer_queue {true};
+		uint32_t transfer_queue_index {UINT32_MAX};
+		VkQueue transfer_queue {nullptr};
 
 		/* SWAPCHAIN */
 		VkSwapchainKHR swap_chain {nullptr};
@@ -135,18 +343,50 @@ namespace liboceanlight::engine
 		VkDescriptorSetLayout descriptor_set_layout {nullptr};
 		VkPipelineLayout pipeline_layout {nullptr};
 		VkRenderPass render_pass {nullptr};
-		VkPipeline graphics_pipeline {nullptr};
+		std::array<VkPipeline, vertex_format_count> graphics_pipelines {};
 
 		/* COMMAND */
 		static constexpr int max_frames_in_flight {2};
 		VkCommandPool command_pool {nullptr};
+		VkCommandPool transfer_cmd_pool {nullptr};
 		std::array<VkCommandBuffer, max_frames_in_flight> command_buffers;
+		/* Threads record_cmd_buffer splits the model list between, when
+		 * each gets at least record_min_models */
+		unsigned int record_threads {4};
+		size_t record_min_models {256};
+		std::array<std::vector<record_slot>, max_frames_in_flight>
+			record_slots;
+		std::unique_ptr<liboceanlight::thread_pool> record_workers;
+		/* Submit the command buffer recorded for the frame and image
+		 * again, recording only once something it draws has changed */
+		bool reuse_cmd_buffers {false};
+		std::array<std::vector<recorded_frame>, max_frames_in_flight>
+			recorded_frames;
+		std::vector<uint32_t> recorded_lods;
 
 		/* TEXTURE */
-		VkImage texture_img {nullptr};
-		VkDeviceMemory texture_img_mem {nullptr};
-		VkImageView texture_img_view {nullptr};
+		static constexpr uint32_t max_textures {1024};
+		std::vector<texture> textures;
+		texture placeholder_texture {};
 		VkSampler texture_sampler {nullptr};
+		std::string texture_path {TEXTURE_PATH "viking_room.png"};
+		bool texture_blit_mips {false};
+		bool texture_compression_enabled {true};
+		bool texture_bc_supported {false};
+		VkDeviceSize texture_batch_bytes {32ull << 20};
+
+		/* TEXTURE RESIDENCY */
+		bool texture_residency_enabled {true};
+		size_t texture_budget {512ull << 20};
+		uint32_t texture_initial_size {64};
+		uint32_t texture_residency_uploads {2};
+
+		/* MATERIAL */
+		static constexpr uint32_t max_materials {1024};
+		std::vector<material> materials;
+		VkBuffer material_buffer {nullptr};
+		liboceanlight::device_allocation material_buffer_mem {};
+		void* material_buffer_mapped {nullptr};
 
 		/* DRAW */
 		int current_frame {1};
@@ -154,18 +394,20 @@ namespace liboceanlight::engine
 		std::array<VkSemaphore, max_frames_in_flight> wait_sems;
 		std::array<VkFence, max_frames_in_flight> in_flight_fences;
 
-		/* VERTEX BUFFER */
-		VkBuffer vertex_buffer {nullptr};
-		VkDeviceMemory vertex_buffer_mem {nullptr};
-
-		/* INDEX BUFFER */
-		VkBuffer index_buffer {nullptr};
-		VkDeviceMemory index_buffer_mem {nullptr};
+		/* GEOMETRY */
+		/* Pool sizes at least, more when the models loaded at init need
+		 * it; the pools grow when full */
+		VkDeviceSize geometry_vertex_bytes {128ull << 20};
+		VkDeviceSize geometry_index_bytes {64ull << 20};
+		geometry_pool vertex_pool;
+		geometry_pool index_pool;
 
 		/* UNIFORM BUFFER */
 		std::array<VkBuffer, max_frames_in_flight> uniform_buffers;
-		std::array<VkDeviceMemory, max_frames_in_flight> uniform_buffers_mem;
+		std::array<liboceanlight::device_allocation, max_frames_in_flight>
+			uniform_buffers_mem;
 		std::array<void*, max_frames_in_flight> uniform_buffers_mapped;
+		uniform_buffer_object ubo {};
 
 		/* DESCRIPTOR */
 		VkDescriptorPool descriptor_pool {nullptr};
@@ -173,7 +415,7 @@ namespace liboceanlight::engine
 
 		/* DEPTH BUFFER */
 		VkImage depth_img {nullptr};
-		VkDeviceMemory depth_img_mem {nullptr};
+		liboceanlight::device_allocation depth_img_mem {};
 		VkImageView depth_img_view {nullptr};
 		VkFormat depth_fmt {VK_FORMAT_D32_SFLOAT};
 
@@ -183,24 +425,78 @@ namespace liboceanlight::engine
 
 		/* MODELS */
 		std::vector<liboceanlight::models::lol_model> model_list;
+		bool parallel_model_loading {true};
+		std::uintmax_t model_split_bytes {8ull << 20};
+		bool mesh_cache_enabled {true};
+		bool mesh_optimization_enabled {true};
+		vertex_format preferred_vertex_format {vertex_format::packed};
+		bool index16_enabled {true};
+		size_t index16_max_draws {64};
+		bool lod_enabled {true};
+		float lod_pixel_error {1.0f};
+
+		/* WORKERS */
+		unsigned int worker_count {0};
+		std::unique_ptr<liboceanlight::thread_pool> workers;
+
+		/* HOT RELOAD */
+		bool hot_reload_enabled {true};
+		std::unique_ptr<liboceanlight::file_watcher> watcher;
+
+		/* STREAMING */
+		bool async_streaming {true};
+		size_t stream_upload_budget {32ull << 20};
+		std::unique_ptr<liboceanlight::asset_stream> stream;
+		std::deque<std::pair<upload_ticket,
+							 std::vector<std::move_only_function<void()>>>>
+			upload_swaps;
 	};
 
 	void start(liboceanlight::window&, engine_data&);
 	void run(liboceanlight::window&, engine_data&);
 	void draw_frame(liboceanlight::window&, engine_data&, double);
 	void record_cmd_buffer(engine_data&, VkCommandBuffer&, uint32_t);
+	/* Of record_threads, as many as the model list has enough models for.
+	 * Reused command buffers are recorded on the calling thread, as the
+	 * next frame resets the pools of their secondaries. */
+	unsigned int record_thread_count(engine_data&);
+	/* The recorded_frames entry for the frame and image, recorded first
+	 * when dirty or the LOD of a model has changed */
+	VkCommandBuffer reuse_cmd_buffer(engine_data&, uint32_t image_index);
+	/* Call when the models, their materials or the pipelines change */
+	void invalidate_recorded_frames(engine_data&);
+	/* The lod index of each model of model_list for this frame */
+	std::vector<uint32_t> select_lods(engine_data&);
+	/* The draws of model_list, with every binding they need, so into a
+	 * secondary command buffer as well as a primary one */
+	void record_models(engine_data&,
+					   VkCommandBuffer,
+					   std::span<const models::lol_model> model_list,
+					   const glm::mat4& model_view,
+					   float pixels_per_radian);
 	void recreate_swapchain(liboceanlight::window&, engine_data&);
-	void upload_buffer(engine_data&,
-					   const void*,
-					   VkDeviceSize,
-					   VkBufferUsageFlagBits,
-					   VkBuffer&,
-					   VkDeviceMemory&);
+	/* Copies size bytes of data to dst at dst_offset */
+	void upload_to_buffer(engine_data&,
+						  const void* data,
+						  VkDeviceSize size,
+						  VkBuffer dst,
+						  VkDeviceSize dst_offset);
 	void update_uniform_buffer(engine_data&,
 							   liboceanlight::window&,
 							   uint32_t,
 							   double);
 	void update_camera(liboceanlight::window&, float);
+
+	/* MEMORY */
+	/* The engine's allocations by category and heap, and each heap's
+	 * budget and usage from the driver when VK_EXT_memory_budget is on */
+	memory_snapshot snapshot_memory(engine_data&);
+	/* What can still be allocated from the largest device local heap
+	 * within its budget, less memory_reserve */
+	VkDeviceSize vram_headroom(engine_data&);
+	/* Prints a snapshot every memory_log_interval seconds */
+	void log_memory(engine_data&);
+	void print_memory_snapshot(const memory_snapshot&);
 } /* namespace liboceanlight::engine */
 
 namespace std
@@ -1,8 +1,12 @@
 #ifndef LIBOCEANLIGHT_ENGINE_INIT_HPP_INCLUDED
 #define LIBOCEANLIGHT_ENGINE_INIT_HPP_INCLUDED
+#include <cstddef>
 #include <liboceanlight/lol_debug_messenger.hpp>
 #include <liboceanlight/lol_engine.hpp>
+#include <liboceanlight/lol_mipmap.hpp>
+#include <liboceanlight/lol_models.hpp>
 #include <liboceanlight/lol_window.hpp>
+#include <span>
 #include <string>
 #include <vector>
 #include <vulkan/vulkan_core.h>
@@ -32,11 +36,80 @@ namespace liboceanlight::engine
 	void create_surface(window&, engine_data&);
 
 	/* QUEUE */
+	/* Also picks a transfer only family for uploads when
+	 * dedicated_transfer_queue is set and there is one */
 	void get_queue_fams(engine_data&);
+	bool use_transfer_queue(engine_data&);
 
 	/* LOGICAL DEVICE */
 	void create_logical_device(engine_data&);
 
+	/* MEMORY */
+	void create_allocator(engine_data&);
+	void find_mappable_vram(engine_data&);
+	/* Set on UMA, resizable BAR and software devices, where the mappable
+	 * heap is the largest device local one, not a small window of it */
+	bool write_vram_directly(engine_data&);
+	/* For buffers the host rewrites every frame: device local too when
+	 * there is any mappable VRAM */
+	VkMemoryPropertyFlags host_write_mem_props(engine_data&);
+
+	/* STAGING */
+	/* A persistently mapped buffer uploads are staged in, reused once
+	 * the submissions reading it have finished */
+	void create_staging_ring(engine_data&);
+	/* The most one submission should stage: half the ring, so the next
+	 * one can be written while it runs */
+	VkDeviceSize staging_chunk_bytes(engine_data&);
+	/* size bytes of the ring for the next submission, at most
+	 * staging_chunk_bytes, waiting for earlier uploads when it is full.
+	 * That may submit the open batch, so record into begin_single_time_cmds
+	 * only after this. */
+	staging_region acquire_staging(engine_data&, VkDeviceSize size);
+	/* Copies levels, which span bytes, into img through the ring a chunk
+	 * per submission. img goes from undefined to transfer dst, then to
+	 * shader read when to_shader_read is set. */
+	void stage_img_upload(engine_data&,
+						  VkImage,
+						  VkFormat,
+						  std::span<const textures::mip_level> levels,
+						  std::span<const uint8_t> bytes,
+						  uint32_t level_count,
+						  bool to_shader_read);
+
+	/* UPLOAD */
+	void create_upload_timelines(engine_data&);
+	/* Until the matching end_upload_batch, the single time commands are
+	 * recorded into one command buffer rather than each submitted and
+	 * waited for. Batches nest. */
+	void begin_upload_batch(engine_data&);
+	/* Submits the batch, without waiting, once the outermost one ends */
+	upload_ticket end_upload_batch(engine_data&);
+	/* Submits what the open batch has recorded and carries on in a new
+	 * command buffer */
+	void flush_upload_batch(engine_data&);
+	/* Waits for the uploads up to ticket and reuses their staging */
+	void wait_upload(engine_data&, upload_ticket);
+	bool upload_finished(engine_data&, upload_ticket);
+	/* Frees what the uploads that have run no longer need */
+	void retire_uploads(engine_data&);
+	/* Like begin_single_time_cmds, for copies only: they run on the
+	 * transfer queue when there is one. End with end_single_time_cmds. */
+	VkCommandBuffer begin_transfer_cmds(engine_data&);
+	/* Hand what begin_transfer_cmds wrote over to the graphics queue,
+	 * the image going from transfer dst to shader read */
+	void release_buffer_to_graphics(engine_data&,
+									VkBuffer,
+									VkDeviceSize offset,
+									VkDeviceSize size);
+	void release_img_to_graphics(engine_data&,
+								 VkImage,
+								 uint32_t level_count);
+	/* Destroys buff once the commands recorded so far have run */
+	void destroy_buffer_after_upload(engine_data&,
+									 VkBuffer&,
+									 liboceanlight::device_allocation&);
+
 	/* SWAPCHAIN */
 	void get_swapchain_details(liboceanlight::window&, engine_data&);
 	VkExtent2D choose_swap_extent(const VkSurfaceCapabilitiesKHR&);
@@ -45,7 +118,8 @@ namespace liboceanlight::engine
 	VkImageView create_image_view(engine_data&,
 								  VkImage,
 								  VkFormat,
-								  VkImageAspectFlags);
+								  VkImageAspectFlags,
+								  uint32_t mip_levels);
 
 	/* PIPELINE */
 	void create_render_pass(engine_data&);
@@ -58,46 +132,160 @@ namespace liboceanlight::engine
 	/* COMMAND */
 	void create_cmd_pool(engine_data&);
 	void create_cmd_buffer(engine_data&);
+	/* record_threads pools per frame in flight, each with one secondary
+	 * command buffer, and the threads to record into them */
+	void create_record_pools(engine_data&);
+	/* One primary command buffer per frame in flight and swapchain image
+	 * when reuse_cmd_buffers, all dirty */
+	void create_recorded_frames(engine_data&);
 	VkCommandBuffer begin_single_time_cmds(engine_data&);
 	void end_single_time_cmds(engine_data&, VkCommandBuffer&);
 
 	/* TEXTURE */
-	void create_texture_img(engine_data&);
+	/* Loads tex.path into tex */
+	void create_texture_img(engine_data&, texture&);
+	/* pixels are width * height RGBA8, the mips are blitted on the GPU
+	 * when use_gpu_mipmaps and filtered on the CPU otherwise */
+	void create_texture_img_from_pixels(engine_data&,
+										texture&,
+										const void*,
+										uint32_t,
+										uint32_t);
+	/* Every level of chain is uploaded as is, in fmt. With texture
+	 * residency only the levels within texture_initial_size are, and tex
+	 * keeps the chain to stream the rest in from. */
+	void create_texture_img_from_mips(engine_data&,
+									  texture&,
+									  const textures::mip_chain&,
+									  VkFormat);
+	/* Uploads the levels of chain from base_level down into a new tex.img */
+	void upload_texture_levels(engine_data&,
+							   texture&,
+							   const textures::mip_chain&,
+							   VkFormat,
+							   uint32_t base_level);
+	/* Blitting needs every level on the GPU, so texture residency filters
+	 * the mips on the CPU */
+	bool use_gpu_mipmaps(engine_data&);
+	/* BC7 cooked into a KTX2 next to the source, when the device can */
+	bool use_compressed_textures(engine_data&);
 	void create_image(engine_data&,
 					  uint32_t,
 					  uint32_t,
+					  uint32_t mip_levels,
 					  VkFormat,
 					  VkImageTiling,
 					  VkImageUsageFlags,
 					  VkMemoryPropertyFlags,
 					  VkImage&,
-					  VkDeviceMemory&);
+					  liboceanlight::device_allocation&,
+					  memory_category);
 	void transition_img_layout(engine_data&,
 							   VkImage,
 							   VkFormat,
 							   VkImageLayout,
-							   VkImageLayout);
-	void copy_buffer_to_img(engine_data&,
-							VkBuffer,
+							   VkImageLayout,
+							   uint32_t mip_levels);
+	void record_img_barrier(VkCommandBuffer,
 							VkImage,
-							uint32_t,
-							uint32_t);
-	void create_texture_img_view(engine_data&);
+							VkFormat,
+							VkImageLayout,
+							VkImageLayout,
+							uint32_t base_level,
+							uint32_t level_count);
+	void generate_mipmaps(engine_data&,
+						  VkImage,
+						  uint32_t,
+						  uint32_t,
+						  uint32_t mip_levels);
+	void record_mipmaps(VkCommandBuffer,
+						VkImage,
+						uint32_t,
+						uint32_t,
+						uint32_t mip_levels);
+	/* levels are relative to buff_offset */
+	void record_copy_mips(VkCommandBuffer,
+						  VkBuffer,
+						  VkDeviceSize buff_offset,
+						  VkImage,
+						  std::span<const textures::mip_level>);
+	void create_texture_img_view(engine_data&, texture&);
 	void create_texture_sampler(engine_data&);
+	/* The grey 1x1 texture empty slots sample */
+	void create_placeholder_texture(engine_data&);
+	/* Loads every slot of the texture table that has no image yet with
+	 * load_texture_batch */
+	void create_textures(engine_data&);
+	/* Decodes or cooks the slots on the worker pool into one staging
+	 * buffer per texture_batch_bytes and uploads each buffer with one
+	 * submission. A texture that fails keeps the placeholder. Returns
+	 * the bytes uploaded. */
+	VkDeviceSize load_texture_batch(engine_data&,
+									std::span<const uint32_t> slots);
+	void destroy_texture(engine_data&, texture&);
+
+	/* MATERIAL */
+	void create_material_buffer(engine_data&);
+	/* TEXTURE_PATH/<model stem>.png when there is one, texture_path
+	 * otherwise */
+	std::string find_model_texture(engine_data&, const std::string&);
+	/* The slot of the texture table holding path, reserving an empty one
+	 * when there is none */
+	uint32_t find_texture(engine_data&, const std::string&);
+	/* The material sampling the texture at path, added when missing */
+	uint32_t find_material(engine_data&, const std::string&);
+	/* Gives every model in model_list its material */
+	void assign_materials(engine_data&);
+
+	/* GEOMETRY */
+	/* Large enough for model_list, and for the defaults */
+	void create_geometry_pools(engine_data&);
+	/* size bytes of pool at a multiple of alignment, which need not be a
+	 * power of two. Grows the pool when no free range fits. */
+	models::geometry_range allocate_geometry(engine_data&,
+											 geometry_pool&,
+											 VkDeviceSize size,
+											 VkDeviceSize alignment);
+	/* Moves pool into a buffer of capacity bytes, keeping its ranges, and
+	 * re-records the frames that bound the old one */
+	void grow_geometry_pool(engine_data&,
+							geometry_pool&,
+							VkDeviceSize capacity);
+	/* Resets range, which may be empty */
+	void free_geometry(geometry_pool&, models::geometry_range&);
+	/* Into the pools, at the model's vertex_range and index_range.
+	 * Copied in place when write_vram_directly, staged otherwise. */
+	void upload_vertices(engine_data&,
+						 models::lol_model&,
+						 std::span<const std::byte>);
+	void upload_indices(engine_data&,
+						models::lol_model&,
+						std::span<const std::byte>);
 
 	/* VERTEX BUFFER */
 	void create_vertex_buffers(engine_data&);
+	VkDeviceSize upload_vertex_buffer(engine_data&, models::lol_model&);
+	/* The bytes upload_vertex_buffer sends, filling in the quantization */
+	std::vector<std::byte> pack_vertex_data(models::lol_model&);
 	uint32_t find_mem_type(engine_data&, uint32_t, VkMemoryPropertyFlags);
+	/* Staging buffers are transient: they are freed once copied from */
 	void create_buffer(engine_data&,
 					   VkDeviceSize,
 					   VkBufferUsageFlags,
 					   VkMemoryPropertyFlags,
 					   VkBuffer&,
-					   VkDeviceMemory&);
+					   liboceanlight::device_allocation&,
+					   memory_category,
+					   memory_usage = memory_usage::buffer);
+	void destroy_buffer(engine_data&,
+						VkBuffer&,
+						liboceanlight::device_allocation&);
 	void copy_buffer(engine_data&, VkBuffer, VkBuffer, VkDeviceSize);
 
 	/* INDEX BUFFER */
 	void create_index_buffers(engine_data&);
+	VkDeviceSize upload_index_buffer(engine_data&, models::lol_model&);
+	std::vector<std::byte> pack_index_data(const models::lol_model&);
 
 	/* UNIFORM BUFFER */
 	void create_uniform_buffers(engine_data&);
@@ -105,11 +293,21 @@ namespace liboceanlight::engine
 	/* DESCRIPTOR */
 	void create_descriptor_pool(engine_data&);
 	void create_descriptor_sets(engine_data&);
+	void write_descriptor_sets(engine_data&);
+	/* Points one slot of the texture array at its image. The set is
+	 * update after bind, so slots no frame in flight samples can be
+	 * written while those frames run. */
+	void write_texture_descriptor(engine_data&, uint32_t);
 
 	/* DEPTH BUFFER */
 	void create_depth_resources(engine_data&);
 
 	/* MODELS */
 	void load_models(engine_data&);
+	models::load_options get_model_load_options(engine_data&);
+	void prepare_model(engine_data&, models::lol_model&);
+
+	/* WORKERS */
+	void create_thread_pool(engine_data&);
 } /* namespace liboceanlight::engine */
 #endif /* LIBOCEANLIGHT_ENGINE_INIT_HPP_INCLUDED */
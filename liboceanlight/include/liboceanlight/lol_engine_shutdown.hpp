@@ -12,14 +12,26 @@ namespace liboceanlight::engine
 	void cleanup_surface(engine_data&);
 	void cleanup_swapchain(engine_data&);
 	void cleanup_images(engine_data&);
-	void cleanup_vertex_buffer(engine_data&, VkBuffer&, VkDeviceMemory&);
-	void cleanup_index_buffer(engine_data&, VkBuffer&, VkDeviceMemory&);
+	/* Return the model's range to its geometry pool */
+	void cleanup_vertex_buffer(engine_data&, models::geometry_range&);
+	void cleanup_index_buffer(engine_data&, models::geometry_range&);
+	void cleanup_geometry_pools(engine_data&);
 	void cleanup_uniform_buffers(engine_data&);
+	void cleanup_material_buffer(engine_data&);
+	/* Waits for the uploads, which free their command buffers */
+	void cleanup_staging(engine_data&);
+	void cleanup_staging_buffer(engine_data&);
+	void cleanup_allocator(engine_data&);
 	void cleanup_descriptor_pool(engine_data&);
 	void cleanup_pipeline(engine_data&);
 	void cleanup_commands(engine_data&);
+	void cleanup_record_pools(engine_data&);
+	void cleanup_recorded_frames(engine_data&);
 	void cleanup_semaphores(engine_data&);
 	void cleanup_fences(engine_data&);
+	void cleanup_thread_pool(engine_data&);
+	void cleanup_hot_reload(engine_data&);
+	void cleanup_streaming(engine_data&);
 	void deinitialize(engine_data&);
 	void shutdown(engine_data&);
 } /* namespace liboceanlight::engine */
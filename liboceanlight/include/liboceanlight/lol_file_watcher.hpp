@@ -0,0 +1,40 @@
+#ifndef LIBOCEANLIGHT_FILE_WATCHER_HPP_INCLUDED
+#define LIBOCEANLIGHT_FILE_WATCHER_HPP_INCLUDED
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace liboceanlight
+{
+	/* Reports files in the watched directories that were written or
+	 * renamed into place. Uses inotify on Linux, elsewhere it compares
+	 * modification times at most every scan_interval. Not recursive. */
+	class file_watcher
+	{
+#ifdef __linux__
+		int inotify_fd {-1};
+		std::map<int, std::string> watches;
+#else
+		std::vector<std::string> dirs;
+		std::map<std::string, std::filesystem::file_time_type> mtimes;
+		std::chrono::steady_clock::time_point last_scan {};
+		void scan(std::vector<std::string>*);
+#endif /* __linux__ */
+
+	  public:
+		static constexpr std::chrono::milliseconds scan_interval {500};
+
+		file_watcher();
+		file_watcher(const file_watcher&) = delete;
+		file_watcher& operator=(const file_watcher&) = delete;
+		~file_watcher() noexcept;
+
+		void watch(const std::string& dir);
+
+		/* Never blocks, each changed path is reported once per call */
+		std::vector<std::string> poll();
+	};
+} /* namespace liboceanlight */
+#endif /* LIBOCEANLIGHT_FILE_WATCHER_HPP_INCLUDED */
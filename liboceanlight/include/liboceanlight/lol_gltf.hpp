@@ -0,0 +1,25 @@
+#ifndef LIBOCEANLIGHT_GLTF_HPP_INCLUDED
+#define LIBOCEANLIGHT_GLTF_HPP_INCLUDED
+#include <cstdint>
+#include <cstddef>
+#include <liboceanlight/lol_engine.hpp>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace liboceanlight::models
+{
+	/* Loads the default scene of a .gltf or .glb file as one indexed
+	 * mesh: every triangle primitive of every node, with node transforms
+	 * baked into the positions. Throws std::runtime_error on failure. */
+	void load_gltf(const std::string&,
+				   std::vector<liboceanlight::engine::vertex>&,
+				   std::vector<uint32_t>&);
+	/* The same, from the file's bytes already in memory. The path names
+	 * the directory external buffers are found in. */
+	void load_gltf(const std::string&,
+				   std::span<const std::byte>,
+				   std::vector<liboceanlight::engine::vertex>&,
+				   std::vector<uint32_t>&);
+} /* namespace liboceanlight::models */
+#endif /* LIBOCEANLIGHT_GLTF_HPP_INCLUDED */
@@ -0,0 +1,42 @@
+#ifndef LIBOCEANLIGHT_HOT_RELOAD_HPP_INCLUDED
+#define LIBOCEANLIGHT_HOT_RELOAD_HPP_INCLUDED
+#include <functional>
+#include <liboceanlight/lol_engine.hpp>
+#include <liboceanlight/lol_models.hpp>
+#include <string>
+#include <vector>
+
+namespace liboceanlight::engine
+{
+	/* Work to run once no frame in flight uses the old resources */
+	using retire_list = std::vector<std::move_only_function<void()>>;
+
+	/* Watches MODEL_PATH, TEXTURE_PATH and SHADER_PATH when
+	 * hot_reload_enabled is set */
+	void create_hot_reload(engine_data&);
+
+	/* Rebuilds what changed on disk since the last call, then waits for
+	 * the in-flight fences and swaps the new resources in. Call between
+	 * frames. A file that fails to load keeps its old resources. */
+	void process_hot_reload(engine_data&);
+
+	/* Waits for the in-flight fences, then runs and clears retire */
+	void run_retired(engine_data&, retire_list&);
+
+	/* Replaces the model_list entry of the same name, destroying its
+	 * buffers, or appends model. Returns whether one was replaced. Only
+	 * safe once no frame in flight draws the old model. */
+	bool swap_model(engine_data&, models::lol_model&);
+
+	/* Gives model its material, loading its texture when that has a new
+	 * slot. A texture that fails to load leaves the placeholder. */
+	void load_model_material(engine_data&, models::lol_model&);
+
+	/* Each builds replacements and queues the swap on retire_list */
+	void reload_models(engine_data&,
+					   const std::vector<std::string>&,
+					   retire_list&);
+	void reload_texture(engine_data&, uint32_t, retire_list&);
+	void reload_pipelines(engine_data&, retire_list&);
+} /* namespace liboceanlight::engine */
+#endif /* LIBOCEANLIGHT_HOT_RELOAD_HPP_INCLUDED */
@@ -0,0 +1,68 @@
+#ifndef LIBOCEANLIGHT_IMAGE_BATCH_HPP_INCLUDED
+#define LIBOCEANLIGHT_IMAGE_BATCH_HPP_INCLUDED
+#include <cstddef>
+#include <cstdint>
+#include <liboceanlight/lol_mipmap.hpp>
+#include <liboceanlight/lol_thread_pool.hpp>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace liboceanlight::textures
+{
+	/* One image of a batch sharing a staging buffer. levels are relative
+	 * to the start of its slice, offset is where that slice starts. */
+	using staged_image = struct lol_staged_image_struct
+	{
+		std::string path;
+		uint32_t width {0};
+		uint32_t height {0};
+		std::vector<mip_level> levels;
+		size_t size {0};
+		size_t offset {0};
+		bool decoded {false};
+	};
+
+	/* Fills in the size and RGBA8 levels of each image from its header,
+	 * read on pool: every level when mips is set, only the largest
+	 * otherwise. Images whose header cannot be read keep a zero width. */
+	void read_image_headers(std::span<staged_image> images,
+							bool mips,
+							liboceanlight::thread_pool* pool);
+
+	/* Places the slices back to back, each at a multiple of alignment.
+	 * Returns the bytes the batch needs. */
+	size_t layout_image_batch(std::span<staged_image> images,
+							  size_t alignment);
+
+	/* Decodes each image with a width that is not yet decoded on pool
+	 * into its slice of staging and filters the rest of its levels
+	 * there, as sRGB colors, marking the ones that decoded. stb
+	 * decodes into its own allocation, so the largest level is copied
+	 * once; the smaller ones are written in place. */
+	void decode_image_batch(std::span<staged_image> images,
+							std::span<uint8_t> staging,
+							liboceanlight::thread_pool* pool);
+
+	/* A band of rows of one level, bytes [offset, offset + size) of the
+	 * levels laid out back to back */
+	using image_copy_piece = struct lol_image_copy_piece_struct
+	{
+		size_t offset {0};
+		size_t size {0};
+		uint32_t level {0};
+		uint32_t y {0};
+		uint32_t width {0};
+		uint32_t height {0};
+	};
+
+	/* Cuts levels, which span size bytes, into pieces of at most
+	 * max_bytes where it can. Levels larger than that are cut between
+	 * rows of block_height texels; a single row is never cut. */
+	std::vector<image_copy_piece> split_image_copy(
+		std::span<const mip_level> levels,
+		size_t size,
+		uint32_t block_height,
+		size_t max_bytes);
+} /* namespace liboceanlight::textures */
+#endif /* LIBOCEANLIGHT_IMAGE_BATCH_HPP_INCLUDED */
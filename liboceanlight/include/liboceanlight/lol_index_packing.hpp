@@ -0,0 +1,27 @@
+#ifndef LIBOCEANLIGHT_INDEX_PACKING_HPP_INCLUDED
+#define LIBOCEANLIGHT_INDEX_PACKING_HPP_INCLUDED
+#include <cstdint>
+#include <liboceanlight/lol_engine.hpp>
+#include <span>
+#include <vector>
+
+namespace liboceanlight::models
+{
+	constexpr uint32_t index16_vertex_limit {1u << 16};
+
+	/* Consecutive triangle runs whose vertices all fall within
+	 * index16_vertex_limit of the run's lowest one, which becomes the
+	 * draw's vertex_offset. Few runs after optimize_vertex_fetch. */
+	std::vector<draw_range> split_index16(std::span<const uint32_t>);
+
+	/* Indices rebased onto the vertex_offset of their draw */
+	std::vector<uint16_t> pack_indices16(std::span<const uint32_t>,
+										 std::span<const draw_range>);
+
+	/* Sets index_type, draws and each level's draw range: 16 bit when
+	 * every level splits into at most max_draws ranges on average,
+	 * otherwise one 32 bit draw per level. A model without levels gets
+	 * one covering all its indices. */
+	void choose_index_type(lol_model&, bool allow_index16, size_t max_draws);
+} /* namespace liboceanlight::models */
+#endif /* LIBOCEANLIGHT_INDEX_PACKING_HPP_INCLUDED */
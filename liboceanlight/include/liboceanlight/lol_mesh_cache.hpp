@@ -0,0 +1,68 @@
+#ifndef LIBOCEANLIGHT_MESH_CACHE_HPP_INCLUDED
+#define LIBOCEANLIGHT_MESH_CACHE_HPP_INCLUDED
+#include <array>
+#include <cstdint>
+#include <liboceanlight/lol_engine.hpp>
+#include <liboceanlight/lol_utility.hpp>
+#include <string>
+#include <vector>
+
+namespace liboceanlight::models
+{
+	constexpr std::array<char, 8> mesh_cache_magic {
+		'L', 'O', 'L', 'M', 'E', 'S', 'H', '\0'};
+	constexpr uint32_t mesh_cache_version {3};
+	constexpr uint64_t mesh_cache_alignment {64};
+
+	/* Processing applied to the cooked data, part of the cache key */
+	constexpr uint64_t mesh_cook_optimized {1ull << 0};
+	constexpr uint64_t mesh_cook_lods {1ull << 1};
+
+	/* On-disk layout: header, then the vertex, index and LOD arrays, each
+	 * starting on a mesh_cache_alignment boundary so they can be used
+	 * straight out of the mapping. */
+	using mesh_cache_header = struct lol_mesh_cache_header_struct
+	{
+		std::array<char, 8> magic {mesh_cache_magic};
+		uint32_t version {mesh_cache_version};
+		uint32_t vertex_stride {sizeof(liboceanlight::engine::vertex)};
+		uint64_t path_hash {0};
+		uint64_t source_size {0};
+		int64_t source_mtime {0};
+		uint64_t source_hash {0};
+		uint64_t cook_flags {0};
+		uint64_t vertex_count {0};
+		uint64_t vertex_offset {0};
+		uint64_t index_count {0};
+		uint64_t index_offset {0};
+		uint64_t lod_count {0};
+		uint64_t lod_offset {0};
+	};
+
+	/* Identifies the source bytes a cache was cooked from */
+	using mesh_cache_key = struct lol_mesh_cache_key_struct
+	{
+		uint64_t path_hash {0};
+		uint64_t source_size {0};
+		int64_t source_mtime {0};
+		uint64_t source_hash {0};
+	};
+
+	std::string mesh_cache_path(const std::string&);
+	/* Maps the source for parsing and fills in the key of exactly the
+	 * bytes mapped, so a save while it cooks is not cached as current */
+	liboceanlight::mapped_file map_mesh_source(const std::string&,
+												mesh_cache_key&);
+	bool read_mesh_cache(const std::string&,
+						 uint64_t cook_flags,
+						 std::vector<liboceanlight::engine::vertex>&,
+						 std::vector<uint32_t>&,
+						 std::vector<mesh_lod>&);
+	void write_mesh_cache(const std::string&,
+						  const mesh_cache_key&,
+						  uint64_t cook_flags,
+						  const std::vector<liboceanlight::engine::vertex>&,
+						  const std::vector<uint32_t>&,
+						  const std::vector<mesh_lod>&);
+} /* namespace liboceanlight::models */
+#endif /* LIBOCEANLIGHT_MESH_CACHE_HPP_INCLUDED */
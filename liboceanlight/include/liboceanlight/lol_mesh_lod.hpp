@@ -0,0 +1,60 @@
+#ifndef LIBOCEANLIGHT_MESH_LOD_HPP_INCLUDED
+#define LIBOCEANLIGHT_MESH_LOD_HPP_INCLUDED
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <liboceanlight/lol_engine.hpp>
+#include <span>
+#include <vector>
+
+namespace liboceanlight::models
+{
+	/* Each level aims for this fraction of the previous level's
+	 * triangles, the chain ends once a level shrinks by less than
+	 * lod_min_reduction or drops below lod_min_triangles */
+	constexpr float lod_reduction {0.5f};
+	constexpr float lod_min_reduction {0.85f};
+	constexpr size_t lod_min_triangles {64};
+	constexpr size_t lod_max_count {6};
+
+	/* SIMPLIFICATION */
+
+	/* Quadric error metric edge collapse onto existing vertices, so the
+	 * result indexes the same vertex array. Texture seams (positions
+	 * shared by several vertices) are locked and open borders only
+	 * collapse along themselves. Stops at target_index_count or when
+	 * the next collapse would exceed max_error (object space distance).
+	 * The error reached is stored in result_error. */
+	std::vector<uint32_t> simplify_mesh(
+		std::span<const uint32_t>,
+		std::span<const liboceanlight::engine::vertex>,
+		size_t target_index_count,
+		float max_error,
+		float& result_error);
+
+	/* Appends coarser levels to indices, each cache optimized, and
+	 * returns the chain including the full mesh as level 0 */
+	std::vector<mesh_lod> build_lods(
+		std::span<const liboceanlight::engine::vertex>,
+		std::vector<uint32_t>&,
+		size_t max_lods = lod_max_count);
+
+	/* SELECTION */
+
+	/* Bounding sphere as center and radius */
+	glm::vec4 mesh_bounds(std::span<const liboceanlight::engine::vertex>);
+
+	/* Coarsest level whose error projects to at most pixel_error pixels.
+	 * pixels_per_radian is proj[1][1] times half the viewport height. */
+	size_t select_lod(std::span<const mesh_lod>,
+					  const glm::vec4& bounds,
+					  const glm::mat4& model_view,
+					  float pixels_per_radian,
+					  float pixel_error);
+
+	/* Pixels the bounding sphere spans across the screen, infinite from
+	 * inside it. pixels_per_radian is as for select_lod. */
+	float projected_size(const glm::vec4& bounds,
+						 const glm::mat4& model_view,
+						 float pixels_per_radian);
+} /* namespace liboceanlight::models */
+#endif /* LIBOCEANLIGHT_MESH_LOD_HPP_INCLUDED */
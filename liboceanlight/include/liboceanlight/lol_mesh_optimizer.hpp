@@ -0,0 +1,54 @@
+#ifndef LIBOCEANLIGHT_MESH_OPTIMIZER_HPP_INCLUDED
+#define LIBOCEANLIGHT_MESH_OPTIMIZER_HPP_INCLUDED
+#include <cstdint>
+#include <liboceanlight/lol_engine.hpp>
+#include <span>
+#include <vector>
+
+namespace liboceanlight::models
+{
+	/* Small enough to be a lower bound on any GPU we target */
+	constexpr unsigned int vertex_cache_size {16};
+
+	/* ACMR is transforms per triangle (0.5 is ideal on a closed mesh),
+	 * ATVR is transforms per unique vertex (1.0 is ideal) */
+	using vertex_cache_stats = struct lol_vertex_cache_stats_struct
+	{
+		size_t triangles {0};
+		size_t vertices {0};
+		size_t transforms {0};
+	};
+
+	using mesh_optimize_stats = struct lol_mesh_optimize_stats_struct
+	{
+		vertex_cache_stats before {};
+		vertex_cache_stats after {};
+	};
+
+	/* ANALYSIS */
+	vertex_cache_stats analyze_vertex_cache(std::span<const uint32_t>,
+											size_t vertex_count,
+											unsigned int cache_size =
+												vertex_cache_size);
+	double acmr(const vertex_cache_stats&);
+	double atvr(const vertex_cache_stats&);
+
+	/* REORDERING */
+	std::vector<uint32_t> optimize_vertex_cache(std::span<const uint32_t>,
+												size_t vertex_count,
+												unsigned int cache_size =
+													vertex_cache_size);
+	std::vector<uint32_t> optimize_overdraw(
+		std::span<const uint32_t>,
+		std::span<const liboceanlight::engine::vertex>,
+		float threshold = 1.05f,
+		unsigned int cache_size = vertex_cache_size);
+	void optimize_vertex_fetch(std::vector<liboceanlight::engine::vertex>&,
+							   std::vector<uint32_t>&);
+
+	/* All three passes in order: cache, overdraw, fetch */
+	mesh_optimize_stats optimize_mesh(
+		std::vector<liboceanlight::engine::vertex>&,
+		std::vector<uint32_t>&);
+} /* namespace liboceanlight::models */
+#endif /* LIBOCEANLIGHT_MESH_OPTIMIZER_HPP_INCLUDED */
@@ -0,0 +1,51 @@
+#ifndef LIBOCEANLIGHT_MIPMAP_HPP_INCLUDED
+#define LIBOCEANLIGHT_MIPMAP_HPP_INCLUDED
+#include <cstddef>
+#include <cstdint>
+#include <liboceanlight/lol_thread_pool.hpp>
+#include <span>
+#include <vector>
+
+namespace liboceanlight::textures
+{
+	using mip_level = struct lol_mip_level_struct
+	{
+		size_t offset {0}; /* bytes into mip_chain::pixels */
+		uint32_t width {0};
+		uint32_t height {0};
+	};
+
+	/* RGBA8 levels back to back, largest first */
+	using mip_chain = struct lol_mip_chain_struct
+	{
+		std::vector<uint8_t> pixels;
+		std::vector<mip_level> levels;
+	};
+
+	/* Levels down to and including 1x1 */
+	uint32_t mip_level_count(uint32_t width, uint32_t height);
+
+	/* Offsets and sizes of the first level_count levels of an RGBA8
+	 * chain laid out as mip_chain::pixels is */
+	std::vector<mip_level> rgba_mip_levels(uint32_t width,
+										   uint32_t height,
+										   uint32_t level_count);
+
+	/* Filters every level after the first from the one above it, in
+	 * place, as build_mip_chain does */
+	void filter_mip_levels(std::span<uint8_t> pixels,
+						   std::span<const mip_level> levels,
+						   bool srgb,
+						   liboceanlight::thread_pool* pool);
+
+	/* Box filters each level from the one above, for devices that cannot
+	 * blit the format with a linear filter. With srgb set the colors are
+	 * averaged in linear space, alpha never is. Bands of rows of the
+	 * larger levels are filtered on pool when one is given. */
+	mip_chain build_mip_chain(std::span<const uint8_t> rgba,
+							  uint32_t width,
+							  uint32_t height,
+							  bool srgb,
+							  liboceanlight::thread_pool* pool);
+} /* namespace liboceanlight::textures */
+#endif /* LIBOCEANLIGHT_MIPMAP_HPP_INCLUDED */
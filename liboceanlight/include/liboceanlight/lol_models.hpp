@@ -0,0 +1,58 @@
+#ifndef LIBOCEANLIGHT_MODELS_HPP_INCLUDED
+#define LIBOCEANLIGHT_MODELS_HPP_INCLUDED
+#include <cstdint>
+#include <liboceanlight/lol_engine.hpp>
+#include <liboceanlight/lol_mesh_optimizer.hpp>
+#include <liboceanlight/lol_thread_pool.hpp>
+#include <string>
+#include <vector>
+
+namespace liboceanlight::models
+{
+	using load_stats = struct lol_load_stats_struct
+	{
+		double wall_ms {0.0};
+		double work_ms {0.0};
+		unsigned int threads {1};
+		size_t model_count {0};
+		size_t cache_hits {0};
+		size_t vertex_count {0};
+		size_t index_count {0};
+
+		/* Summed over the models optimized in this load */
+		size_t optimized_count {0};
+		vertex_cache_stats cache_before {};
+		vertex_cache_stats cache_after {};
+
+		/* Levels beyond the full meshes, index_count includes them */
+		size_t lod_count {0};
+	};
+
+	using load_options = struct lol_load_options_struct
+	{
+		/* null loads everything on the calling thread */
+		liboceanlight::thread_pool* pool {nullptr};
+
+		/* OBJ files are parsed in chunks of about this many bytes */
+		std::uintmax_t split_bytes {8ull << 20};
+
+		/* read and write cooked .lolmesh files next to the sources */
+		bool use_cache {true};
+
+		/* reorder for vertex cache, overdraw and vertex fetch */
+		bool optimize {true};
+
+		/* append simplified levels of detail to each model's indices */
+		bool lods {true};
+	};
+
+	/* .obj, .gltf or .glb */
+	bool is_model_file(const std::string&);
+	std::vector<std::string> find_model_files(const std::string&);
+	load_stats load_model_files(const std::vector<std::string>&,
+								std::vector<lol_model>&,
+								const load_options&);
+
+	void print_load_stats(const load_stats&);
+} /* namespace liboceanlight::models */
+#endif /* LIBOCEANLIGHT_MODELS_HPP_INCLUDED */
@@ -0,0 +1,59 @@
+#ifndef LIBOCEANLIGHT_OBJ_PARSER_HPP_INCLUDED
+#define LIBOCEANLIGHT_OBJ_PARSER_HPP_INCLUDED
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <liboceanlight/lol_engine.hpp>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace liboceanlight::models
+{
+	/* A face corner as written in the file, 0 based. Negative (relative)
+	 * OBJ indices are stored relative to the first element of the chunk
+	 * and flagged, since that only becomes known once every earlier
+	 * chunk is parsed. */
+	using obj_corner = struct lol_obj_corner_struct
+	{
+		int32_t position;
+		int32_t texcoord;
+		bool position_relative;
+		bool texcoord_relative;
+	};
+
+	constexpr int32_t obj_no_texcoord {INT32_MIN};
+
+	/* Everything parsed from one newline aligned range of an OBJ file.
+	 * Faces are fan triangulated, normals, groups and materials are
+	 * skipped since vertex has no use for them. */
+	using obj_chunk = struct lol_obj_chunk_struct
+	{
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec2> texcoords;
+		std::vector<obj_corner> corners;
+	};
+
+	/* Ranges of about chunk_bytes, each ending after a newline */
+	std::vector<std::span<const std::byte>> split_obj_chunks(
+		std::span<const std::byte>,
+		size_t chunk_bytes);
+
+	/* Thread safe, chunks of one file can be parsed concurrently. The
+	 * path is only used in error messages. */
+	obj_chunk parse_obj_chunk(std::span<const std::byte>, const std::string&);
+
+	/* Resolves the corners of all chunks of one file, in file order,
+	 * and welds them straight into vertices and indices. The path is
+	 * only used in error messages. */
+	void weld_obj_chunks(std::span<const obj_chunk>,
+						 const std::string& path,
+						 std::vector<liboceanlight::engine::vertex>&,
+						 std::vector<uint32_t>&);
+
+	/* Single threaded map, parse and weld of a whole file */
+	void load_obj(const std::string&,
+				  std::vector<liboceanlight::engine::vertex>&,
+				  std::vector<uint32_t>&);
+} /* namespace liboceanlight::models */
+#endif /* LIBOCEANLIGHT_OBJ_PARSER_HPP_INCLUDED */
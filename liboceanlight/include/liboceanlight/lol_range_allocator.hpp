@@ -0,0 +1,94 @@
+#ifndef LIBOCEANLIGHT_RANGE_ALLOCATOR_HPP_INCLUDED
+#define LIBOCEANLIGHT_RANGE_ALLOCATOR_HPP_INCLUDED
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <utility>
+
+namespace liboceanlight
+{
+	/* Hands out offsets into [0, capacity) for long lived resources.
+	 * Picks the smallest free range that fits and merges ranges with
+	 * their neighbours when freed, so the space does not splinter. */
+	class range_allocator
+	{
+		uint64_t total {0};
+		uint64_t in_use {0};
+		std::map<uint64_t, uint64_t> by_offset;		/* offset to size */
+		std::multimap<uint64_t, uint64_t> by_size; /* size to offset */
+
+		void insert(uint64_t offset, uint64_t size);
+		void erase(std::map<uint64_t, uint64_t>::iterator);
+
+	  public:
+		static constexpr uint64_t npos {UINT64_MAX};
+
+		explicit range_allocator(uint64_t capacity = 0);
+
+		/* The offset of size bytes at a multiple of alignment, or npos
+		 * when no free range fits */
+		uint64_t allocate(uint64_t size, uint64_t alignment = 1);
+		/* size must be what offset was allocated with */
+		void free(uint64_t offset, uint64_t size);
+		/* Extends the space to capacity, keeping every allocation */
+		void grow(uint64_t capacity);
+
+		uint64_t capacity() const { return total; }
+		uint64_t used() const { return in_use; }
+		bool empty() const { return in_use == 0; }
+		size_t free_ranges() const { return by_offset.size(); }
+	};
+
+	/* Hands out offsets front to back for short lived resources, all
+	 * reused at once when the last of them is freed */
+	class linear_allocator
+	{
+		uint64_t total {0};
+		uint64_t head {0};
+		uint64_t in_use {0};
+		size_t live {0};
+
+	  public:
+		static constexpr uint64_t npos {range_allocator::npos};
+
+		explicit linear_allocator(uint64_t capacity = 0);
+
+		uint64_t allocate(uint64_t size, uint64_t alignment = 1);
+		void free(uint64_t size);
+
+		uint64_t capacity() const { return total; }
+		uint64_t used() const { return in_use; }
+		bool empty() const { return live == 0; }
+	};
+
+	/* Hands out offsets around [0, capacity) in order, for data a GPU
+	 * submission reads once. submit tags what was handed out since the
+	 * last call with the serial of the submission reading it, and
+	 * complete makes that space reusable. */
+	class ring_allocator
+	{
+		uint64_t total {0};
+		uint64_t head {0}; /* bytes handed out, ever */
+		uint64_t tail {0}; /* bytes reusable, ever */
+		std::deque<std::pair<uint64_t, uint64_t>> pending; /* serial, head */
+
+	  public:
+		static constexpr uint64_t npos {range_allocator::npos};
+
+		explicit ring_allocator(uint64_t capacity = 0);
+
+		/* npos until enough completes to make room. Never splits an
+		 * allocation around the end. */
+		uint64_t allocate(uint64_t size, uint64_t alignment = 1);
+		void submit(uint64_t serial);
+		/* Every submission up to serial has finished */
+		void complete(uint64_t serial);
+
+		/* The serial to wait for to free space, 0 when none is pending */
+		uint64_t oldest_pending() const;
+		uint64_t capacity() const { return total; }
+		uint64_t used() const { return head - tail; }
+	};
+} /* namespace liboceanlight */
+#endif /* LIBOCEANLIGHT_RANGE_ALLOCATOR_HPP_INCLUDED */
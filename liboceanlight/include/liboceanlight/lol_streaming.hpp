@@ -0,0 +1,35 @@
+#ifndef LIBOCEANLIGHT_STREAMING_HPP_INCLUDED
+#define LIBOCEANLIGHT_STREAMING_HPP_INCLUDED
+#include <liboceanlight/lol_engine.hpp>
+#include <liboceanlight/lol_hot_reload.hpp>
+
+namespace liboceanlight::engine
+{
+	/* A small cube named after each model file, with its material
+	 * sampling the placeholder texture, so the first frame does not wait
+	 * for the real assets */
+	void create_placeholders(engine_data&);
+
+	/* When async_streaming is set, decodes the textures and the models
+	 * on a loader thread, replacing the placeholders as they finish */
+	void start_streaming(engine_data&);
+
+	/* Uploads the assets the loader finished, about stream_upload_budget
+	 * bytes per call, and swaps them in once uploaded. Call between
+	 * frames. */
+	void process_streaming(engine_data&);
+
+	/* With texture_residency_enabled, picks the levels each texture needs
+	 * from how large its models are on screen, assuming a texture covers
+	 * its model once, and re-uploads up to texture_residency_uploads of
+	 * them per call within texture_budget bytes, or less when the VRAM
+	 * budget has less room. Call between frames. */
+	void update_texture_residency(engine_data&);
+
+	/* Runs retire once the uploads up to ticket have finished, so the
+	 * render thread never waits for them */
+	void swap_when_uploaded(engine_data&, upload_ticket, retire_list&);
+	/* Runs the swaps whose uploads have finished. Call between frames. */
+	void swap_uploaded(engine_data&);
+} /* namespace liboceanlight::engine */
+#endif /* LIBOCEANLIGHT_STREAMING_HPP_INCLUDED */
@@ -0,0 +1,52 @@
+#ifndef LIBOCEANLIGHT_TEXTURE_CACHE_HPP_INCLUDED
+#define LIBOCEANLIGHT_TEXTURE_CACHE_HPP_INCLUDED
+#include <array>
+#include <cstdint>
+#include <liboceanlight/lol_block_compress.hpp>
+#include <liboceanlight/lol_mipmap.hpp>
+#include <liboceanlight/lol_thread_pool.hpp>
+#include <string>
+#include <vulkan/vulkan_core.h>
+
+namespace liboceanlight::textures
+{
+	constexpr std::array<uint8_t, 12> ktx2_identifier {
+		0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+	constexpr uint32_t texture_cache_version {1};
+
+	/* Key/value entry recording what the texture was cooked from */
+	constexpr const char* texture_source_key {"LOLsource"};
+	using texture_source = struct lol_texture_source_struct
+	{
+		uint32_t version {texture_cache_version};
+		uint32_t kind {0};
+		uint64_t size {0};
+		int64_t mtime {0};
+		uint64_t hash {0};
+	};
+
+	/* Levels ready to copy into an image, chain.pixels holds blocks */
+	using compressed_texture = struct lol_compressed_texture_struct
+	{
+		VkFormat format {VK_FORMAT_UNDEFINED};
+		mip_chain chain;
+	};
+
+	std::string texture_cache_path(const std::string&);
+
+	/* A 2D KTX2 without supercompression, one BC format per file. Levels
+	 * are stored smallest first as the format recommends. */
+	void write_ktx2(const std::string&,
+					const compressed_texture&,
+					const texture_source&);
+
+	/* Throws on anything but what write_ktx2 produces */
+	compressed_texture read_ktx2(const std::string&, texture_source&);
+
+	/* The cooked KTX2 of source, encoded and written first when it is
+	 * missing or older than the source */
+	compressed_texture cook_texture(const std::string& source,
+									texture_kind,
+									liboceanlight::thread_pool*);
+} /* namespace liboceanlight::textures */
+#endif /* LIBOCEANLIGHT_TEXTURE_CACHE_HPP_INCLUDED */
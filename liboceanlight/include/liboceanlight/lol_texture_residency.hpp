@@ -0,0 +1,40 @@
+#ifndef LIBOCEANLIGHT_TEXTURE_RESIDENCY_HPP_INCLUDED
+#define LIBOCEANLIGHT_TEXTURE_RESIDENCY_HPP_INCLUDED
+#include <cstddef>
+#include <cstdint>
+#include <liboceanlight/lol_mipmap.hpp>
+#include <span>
+#include <vector>
+
+namespace liboceanlight::textures
+{
+	/* Bytes of chain from level to the smallest */
+	size_t resident_bytes(const mip_chain& chain, uint32_t level);
+
+	/* The largest level no bigger than max_size on either side */
+	uint32_t first_level_within(std::span<const mip_level> levels,
+								uint32_t max_size);
+
+	/* The largest level worth sampling when the texture covers about
+	 * screen_pixels pixels across: one texel per pixel, rounded towards
+	 * the sharper level */
+	uint32_t screen_mip_level(std::span<const mip_level> levels,
+							  float screen_pixels);
+
+	using residency_request = struct lol_residency_request_struct
+	{
+		const mip_chain* source {nullptr};
+		uint32_t resident {0}; /* the largest level uploaded now */
+		uint32_t wanted {0};   /* the largest level the screen needs */
+	};
+
+	/* The largest level to keep of each source so they all fit in budget
+	 * bytes. Missing levels are loaded and, to avoid thrashing, a texture
+	 * only drops levels when it holds two more than it needs. When the
+	 * budget is short the largest levels go first; every texture keeps
+	 * its smallest level. */
+	std::vector<uint32_t> plan_residency(
+		std::span<const residency_request> requests,
+		size_t budget);
+} /* namespace liboceanlight::textures */
+#endif /* LIBOCEANLIGHT_TEXTURE_RESIDENCY_HPP_INCLUDED */
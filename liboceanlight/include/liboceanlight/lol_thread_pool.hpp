@@ -0,0 +1,46 @@
+#ifndef LIBOCEANLIGHT_THREAD_POOL_HPP_INCLUDED
+#define LIBOCEANLIGHT_THREAD_POOL_HPP_INCLUDED
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace liboceanlight
+{
+	class thread_pool
+	{
+		std::vector<std::jthread> workers;
+		std::deque<std::move_only_function<void()>> tasks;
+		std::mutex tasks_mtx;
+		std::condition_variable tasks_cv;
+		bool stopping {false};
+
+		void enqueue(std::move_only_function<void()>);
+		void worker_loop();
+
+	  public:
+		/* 0 threads means one per hardware thread */
+		explicit thread_pool(unsigned int thread_count = 0);
+		thread_pool(const thread_pool&) = delete;
+		thread_pool& operator=(const thread_pool&) = delete;
+		~thread_pool() noexcept;
+
+		unsigned int size() const;
+
+		template <typename F>
+		auto submit(F&& func) -> std::future<std::invoke_result_t<F>>
+		{
+			std::packaged_task<std::invoke_result_t<F>()> task {
+				std::forward<F>(func)};
+			auto result {task.get_future()};
+			enqueue(std::move(task));
+			return result;
+		}
+	};
+} /* namespace liboceanlight */
+#endif /* LIBOCEANLIGHT_THREAD_POOL_HPP_INCLUDED */
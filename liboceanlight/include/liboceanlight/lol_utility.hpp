@@ -1,6 +1,10 @@
 #ifndef LOL_UTILITY_HPP_INCLUDED
 #define LOL_UTILITY_HPP_INCLUDED
+#include <cstddef>
+#include <cstdint>
+#include <span>
 #include <string>
+#include <utility>
 #include <vector>
 #include <vulkan/vulkan_core.h>
 
@@ -9,5 +13,64 @@ namespace liboceanlight
 	std::string queue_flags_to_string(const VkQueueFlags&);
 	std::vector<char> read_file(const std::string&);
 	int test_func(int, int);
+
+	/* XXH64 */
+	uint64_t hash_bytes(std::span<const std::byte>, uint64_t seed = 0);
+
+	/* Read-only memory mapping of a whole file */
+	class mapped_file
+	{
+		const std::byte* data_pointer {nullptr};
+		size_t data_size {0};
+#ifdef _WIN32
+		void* file_handle {nullptr};
+		void* mapping_handle {nullptr};
+#endif /* _WIN32 */
+
+		void unmap() noexcept;
+
+	  public:
+		mapped_file() = default;
+		explicit mapped_file(const std::string&);
+		mapped_file(const mapped_file&) = delete;
+		mapped_file& operator=(const mapped_file&) = delete;
+		mapped_file(mapped_file&& old) noexcept :
+			data_pointer(std::exchange(old.data_pointer, nullptr)),
+			data_size(std::exchange(old.data_size, 0))
+#ifdef _WIN32
+			,
+			file_handle(std::exchange(old.file_handle, nullptr)),
+			mapping_handle(std::exchange(old.mapping_handle, nullptr))
+#endif /* _WIN32 */
+		{
+		}
+
+		mapped_file& operator=(mapped_file&& old) noexcept
+		{
+			unmap();
+			data_pointer = std::exchange(old.data_pointer, nullptr);
+			data_size = std::exchange(old.data_size, 0);
+#ifdef _WIN32
+			file_handle = std::exchange(old.file_handle, nullptr);
+			mapping_handle = std::exchange(old.mapping_handle, nullptr);
+#endif /* _WIN32 */
+			return *this;
+		}
+
+		~mapped_file() noexcept
+		{
+			unmap();
+		}
+
+		std::span<const std::byte> bytes() const
+		{
+			return {data_pointer, data_size};
+		}
+
+		size_t size() const
+		{
+			return data_size;
+		}
+	};
 } /* namespace liboceanlight */
 #endif /* LOL_UTILITY_HPP_INCLUDED */
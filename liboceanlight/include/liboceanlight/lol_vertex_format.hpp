@@ -0,0 +1,105 @@
+#ifndef LIBOCEANLIGHT_VERTEX_FORMAT_HPP_INCLUDED
+#define LIBOCEANLIGHT_VERTEX_FORMAT_HPP_INCLUDED
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan_core.h>
+
+namespace liboceanlight::engine
+{
+	/* Indexes engine_data::graphics_pipelines */
+	enum class vertex_format : uint32_t
+	{
+		full,
+		packed
+	};
+	constexpr size_t vertex_format_count {2};
+
+	/* One entry per shader input, see the layout() of each vertex type */
+	using vertex_attribute = struct lol_vertex_attribute_struct
+	{
+		uint32_t location;
+		VkFormat format;
+		uint32_t offset;
+	};
+
+	/* Per draw position and texcoord dequantization, pushed as vertex
+	 * push constants. texcoord holds the offset in xy and the scale in
+	 * zw. vec4 keeps the std430 push constant block layout trivial. */
+	using vertex_quantization = struct lol_vertex_quantization_struct
+	{
+		glm::vec4 offset {0.0f, 0.0f, 0.0f, 0.0f};
+		glm::vec4 scale {1.0f, 1.0f, 1.0f, 1.0f};
+		glm::vec4 texcoord {0.0f, 0.0f, 1.0f, 1.0f};
+	};
+
+	constexpr uint32_t vertex_format_size(VkFormat format)
+	{
+		switch (format)
+		{
+			case VK_FORMAT_R32G32B32A32_SFLOAT:
+				return 16;
+			case VK_FORMAT_R32G32B32_SFLOAT:
+				return 12;
+			case VK_FORMAT_R32G32_SFLOAT:
+			case VK_FORMAT_R16G16B16A16_UNORM:
+			case VK_FORMAT_R16G16B16A16_SFLOAT:
+				return 8;
+			case VK_FORMAT_R16G16_UNORM:
+			case VK_FORMAT_R16G16_SFLOAT:
+			case VK_FORMAT_R8G8B8A8_UNORM:
+				return 4;
+			default:
+				return 0;
+		}
+	}
+
+	/* Every attribute has a known format and lies inside the stride */
+	template <typename V>
+	constexpr bool vertex_layout_valid()
+	{
+		for (const auto& attribute : V::layout())
+		{
+			const uint32_t size {vertex_format_size(attribute.format)};
+			if (size == 0 || attribute.offset + size > sizeof(V))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	template <typename V>
+	constexpr VkVertexInputBindingDescription make_binding_desc(
+		uint32_t binding = 0)
+	{
+		static_assert(vertex_layout_valid<V>(), "Bad vertex layout");
+
+		VkVertexInputBindingDescription binding_desc {};
+		binding_desc.binding = binding;
+		binding_desc.stride = sizeof(V);
+		binding_desc.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+		return binding_desc;
+	}
+
+	template <typename V>
+	constexpr auto make_attribute_descs(uint32_t binding = 0)
+	{
+		constexpr auto layout {V::layout()};
+		std::array<VkVertexInputAttributeDescription, layout.size()>
+			attribute_descs {};
+
+		for (size_t i {0}; i < layout.size(); ++i)
+		{
+			attribute_descs[i].binding = binding;
+			attribute_descs[i].location = layout[i].location;
+			attribute_descs[i].format = layout[i].format;
+			attribute_descs[i].offset = layout[i].offset;
+		}
+
+		return attribute_descs;
+	}
+} /* namespace liboceanlight::engine */
+#endif /* LIBOCEANLIGHT_VERTEX_FORMAT_HPP_INCLUDED */
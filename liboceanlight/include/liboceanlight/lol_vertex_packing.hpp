@@ -0,0 +1,25 @@
+#ifndef LIBOCEANLIGHT_VERTEX_PACKING_HPP_INCLUDED
+#define LIBOCEANLIGHT_VERTEX_PACKING_HPP_INCLUDED
+#include <liboceanlight/lol_engine.hpp>
+#include <liboceanlight/lol_vertex_format.hpp>
+#include <span>
+#include <vector>
+
+namespace liboceanlight::models
+{
+	/* unorm16 texcoords over at most this span are within an eighth of a
+	 * texel on 2048 texel textures, meshes tiling further stay in full
+	 * floats */
+	constexpr float packed_texcoord_span {8.0f};
+
+	/* preferred, unless the mesh needs data packed_vertex cannot hold */
+	liboceanlight::engine::vertex_format choose_vertex_format(
+		std::span<const liboceanlight::engine::vertex>,
+		liboceanlight::engine::vertex_format preferred);
+
+	/* Fills in the dequantization for the mesh bounds */
+	std::vector<liboceanlight::engine::packed_vertex> pack_vertices(
+		std::span<const liboceanlight::engine::vertex>,
+		liboceanlight::engine::vertex_quantization&);
+} /* namespace liboceanlight::models */
+#endif /* LIBOCEANLIGHT_VERTEX_PACKING_HPP_INCLUDED */
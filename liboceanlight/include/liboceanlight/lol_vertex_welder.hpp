@@ -0,0 +1,38 @@
+#ifndef LIBOCEANLIGHT_VERTEX_WELDER_HPP_INCLUDED
+#define LIBOCEANLIGHT_VERTEX_WELDER_HPP_INCLUDED
+#include <cstdint>
+#include <liboceanlight/lol_engine.hpp>
+#include <vector>
+
+namespace liboceanlight::models
+{
+	/* Bit-exact: 0.0f and -0.0f hash differently, identical NaNs weld */
+	uint64_t hash_vertex(const liboceanlight::engine::vertex&);
+
+	/* Open-addressing (linear probing) table mapping vertices to their
+	 * index in an output vector. Each slot keeps the upper hash bits so
+	 * most probes are rejected without touching the vertex data. */
+	class vertex_welder
+	{
+		struct slot
+		{
+			uint32_t tag;
+			uint32_t index_plus_one;
+		};
+
+		std::vector<liboceanlight::engine::vertex>& vertices;
+		std::vector<slot> slots;
+		size_t mask {0};
+
+		void rehash(size_t);
+
+	  public:
+		/* Sized for index_count corners, appends new vertices to out and
+		 * welds to the ones already there */
+		vertex_welder(std::vector<liboceanlight::engine::vertex>& out,
+					  size_t index_count);
+
+		uint32_t weld(const liboceanlight::engine::vertex&);
+	};
+} /* namespace liboceanlight::models */
+#endif /* LIBOCEANLIGHT_VERTEX_WELDER_HPP_INCLUDED */
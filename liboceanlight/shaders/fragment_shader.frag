@@ -1,11 +1,29 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+struct material
+{
+    vec4 base_color;
+    uint texture_index;
+};
 
 layout(location = 0) in vec3 fragment_color;
 layout(location = 1) in vec2 frag_texcoord;
 layout(location = 0) out vec4 output_color;
-layout(binding = 1) uniform sampler2D tex_sampler;
+layout(binding = 1) uniform sampler2D textures[];
+layout(std430, binding = 2) readonly buffer material_buffer
+{
+    material materials[];
+};
+layout(push_constant) uniform draw_material
+{
+    layout(offset = 48) uint index;
+} draw;
 
 void main()
 {
-    output_color = texture(tex_sampler, frag_texcoord);
+    /* The index is the same for the whole draw */
+    material mat = materials[draw.index];
+    output_color = mat.base_color *
+                   texture(textures[mat.texture_index], frag_texcoord);
 }
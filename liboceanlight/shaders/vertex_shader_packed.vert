@@ -0,0 +1,26 @@
+#version 450
+
+layout(location = 0) in vec4 in_position;
+layout(location = 2) in vec2 in_texcoord;
+layout(location = 0) out vec3 fragment_color;
+layout(location = 1) out vec2 frag_texcoord;
+layout(binding = 0) uniform uniform_buffer_object
+{
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+} ubo;
+layout(push_constant) uniform vertex_quantization
+{
+    vec4 offset;
+    vec4 scale;
+    vec4 texcoord;
+} quant;
+
+void main()
+{
+    vec3 position = quant.offset.xyz + in_position.xyz * quant.scale.xyz;
+    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(position, 1.0);
+    fragment_color = vec3(1.0);
+    frag_texcoord = quant.texcoord.xy + in_texcoord * quant.texcoord.zw;
+}
@@ -0,0 +1,58 @@
+#include <chrono>
+#include <liboceanlight/lol_asset_stream.hpp>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+liboceanlight::asset_stream::asset_stream(size_t asset_count,
+										  load_task load) :
+	outstanding(asset_count), start_time(std::chrono::steady_clock::now()),
+	loader([this, load = std::move(load)](std::stop_token stop) mutable {
+		load(stop, *this);
+	})
+{
+}
+
+void liboceanlight::asset_stream::push(staged_asset asset)
+{
+	std::scoped_lock lock {ready_mtx};
+	ready.push_back(std::move(asset));
+}
+
+void liboceanlight::asset_stream::skip()
+{
+	std::scoped_lock lock {ready_mtx};
+	--outstanding;
+}
+
+std::vector<liboceanlight::asset_stream::staged_asset> liboceanlight::
+	asset_stream::take(size_t byte_budget)
+{
+	std::vector<staged_asset> taken;
+	size_t taken_bytes {0};
+
+	std::scoped_lock lock {ready_mtx};
+	while (!ready.empty() &&
+		   (taken.empty() || taken_bytes + ready.front().bytes <= byte_budget))
+	{
+		taken_bytes += ready.front().bytes;
+		taken.push_back(std::move(ready.front()));
+		ready.pop_front();
+		--outstanding;
+	}
+
+	return taken;
+}
+
+bool liboceanlight::asset_stream::done()
+{
+	std::scoped_lock lock {ready_mtx};
+	return outstanding == 0;
+}
+
+double liboceanlight::asset_stream::elapsed_ms() const
+{
+	return std::chrono::duration<double, std::milli>(
+			   std::chrono::steady_clock::now() - start_time)
+		.count();
+}
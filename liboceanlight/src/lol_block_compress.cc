@@ -0,0 +1,479 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <liboceanlight/lol_block_compress.hpp>
+#include <liboceanlight/lol_mipmap.hpp>
+#include <liboceanlight/lol_thread_pool.hpp>
+#include <span>
+#include <vector>
+
+using liboceanlight::textures::mip_chain;
+using liboceanlight::textures::mip_level;
+using liboceanlight::textures::texel_block;
+using liboceanlight::textures::texture_kind;
+
+namespace
+{
+	/* Block rows per pool job */
+	constexpr uint32_t block_rows_per_job {16};
+
+	constexpr std::array<int, 16> bc7_weights {
+		0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+	using rgba = std::array<float, 4>;
+
+	/* A BC7 endpoint: 7 bits per channel plus a shared low bit */
+	using bc7_endpoint = struct lol_bc7_endpoint_struct
+	{
+		std::array<int, 4> value {};
+		int pbit {0};
+
+		int channel(size_t c) const
+		{
+			return value[c] * 2 + pbit;
+		}
+	};
+
+	/* Packs fields least significant bit first, as BC blocks do */
+	template <size_t N> class bit_writer
+	{
+		std::array<uint8_t, N> bytes {};
+		size_t position {0};
+
+	  public:
+		void put(uint32_t value, size_t bits)
+		{
+			for (size_t i {0}; i < bits; ++i, ++position)
+			{
+				if ((value >> i) & 1)
+				{
+					bytes[position / 8] |= static_cast<uint8_t>(
+						1u << (position % 8));
+				}
+			}
+		}
+
+		const std::array<uint8_t, N>& data() const
+		{
+			return bytes;
+		}
+	};
+
+	bc7_endpoint quantize_endpoint(const rgba& color)
+	{
+		bc7_endpoint best {};
+		float best_error {INFINITY};
+
+		for (int pbit {0}; pbit < 2; ++pbit)
+		{
+			bc7_endpoint candidate {};
+			candidate.pbit = pbit;
+			float error {0.0f};
+			for (size_t c {0}; c < 4; ++c)
+			{
+				const float clamped {std::clamp(color[c], 0.0f, 255.0f)};
+				candidate.value[c] = std::clamp(
+					static_cast<int>(std::lround((clamped - pbit) / 2.0f)),
+					0,
+					127);
+				const float diff {candidate.channel(c) - clamped};
+				error += diff * diff;
+			}
+
+			if (error < best_error)
+			{
+				best_error = error;
+				best = candidate;
+			}
+		}
+
+		return best;
+	}
+
+	/* Nearest palette entry for every texel, returns the squared error */
+	int assign_indices(const texel_block& block,
+					   const bc7_endpoint& e0,
+					   const bc7_endpoint& e1,
+					   std::array<uint8_t, 16>& indices)
+	{
+		std::array<std::array<int, 4>, 16> palette {};
+		for (size_t i {0}; i < 16; ++i)
+		{
+			for (size_t c {0}; c < 4; ++c)
+			{
+				palette[i][c] = ((64 - bc7_weights[i]) * e0.channel(c) +
+								 bc7_weights[i] * e1.channel(c) + 32) >>
+								6;
+			}
+		}
+
+		int total {0};
+		for (size_t t {0}; t < 16; ++t)
+		{
+			int best {INT32_MAX};
+			for (size_t i {0}; i < 16; ++i)
+			{
+				int error {0};
+				for (size_t c {0}; c < 4; ++c)
+				{
+					const int diff {palette[i][c] - block[t * 4 + c]};
+					error += diff * diff;
+				}
+
+				if (error < best)
+				{
+					best = error;
+					indices[t] = static_cast<uint8_t>(i);
+				}
+			}
+
+			total += best;
+		}
+
+		return total;
+	}
+
+	/* Endpoints minimizing the squared error for fixed indices, false
+	 * when every texel uses the same weight */
+	bool fit_endpoints(const texel_block& block,
+					   const std::array<uint8_t, 16>& indices,
+					   rgba& e0,
+					   rgba& e1)
+	{
+		float a {0.0f}, b {0.0f}, c {0.0f};
+		rgba x0 {}, x1 {};
+		for (size_t t {0}; t < 16; ++t)
+		{
+			const float w {bc7_weights[indices[t]] / 64.0f};
+			a += (1.0f - w) * (1.0f - w);
+			b += w * (1.0f - w);
+			c += w * w;
+			for (size_t ch {0}; ch < 4; ++ch)
+			{
+				x0[ch] += (1.0f - w) * block[t * 4 + ch];
+				x1[ch] += w * block[t * 4 + ch];
+			}
+		}
+
+		const float det {a * c - b * b};
+		if (std::fabs(det) < 1e-6f)
+		{
+			return false;
+		}
+
+		for (size_t ch {0}; ch < 4; ++ch)
+		{
+			e0[ch] = (c * x0[ch] - b * x1[ch]) / det;
+			e1[ch] = (a * x1[ch] - b * x0[ch]) / det;
+		}
+
+		return true;
+	}
+
+	/* Texels of the block at (bx, by), edges repeated */
+	texel_block gather_block(const uint8_t* pixels,
+							 const mip_level& level,
+							 uint32_t bx,
+							 uint32_t by)
+	{
+		texel_block block {};
+		for (uint32_t y {0}; y < 4; ++y)
+		{
+			const uint32_t sy {std::min(by * 4 + y, level.height - 1)};
+			for (uint32_t x {0}; x < 4; ++x)
+			{
+				const uint32_t sx {std::min(bx * 4 + x, level.width - 1)};
+				std::memcpy(&block[(y * 4 + x) * 4],
+							pixels + (size_t {sy} * level.width + sx) * 4,
+							4);
+			}
+		}
+
+		return block;
+	}
+
+	void encode_block(const texel_block& block,
+					  texture_kind kind,
+					  uint8_t* out)
+	{
+		using namespace liboceanlight::textures;
+		switch (kind)
+		{
+		case texture_kind::color:
+		{
+			const auto bc7 {encode_bc7_block(block)};
+			std::memcpy(out, bc7.data(), bc7.size());
+			break;
+		}
+		case texture_kind::normal:
+		{
+			const auto red {encode_bc4_block(block, 0)};
+			const auto green {encode_bc4_block(block, 1)};
+			std::memcpy(out, red.data(), red.size());
+			std::memcpy(out + red.size(), green.data(), green.size());
+			break;
+		}
+		case texture_kind::mask:
+		{
+			const auto red {encode_bc4_block(block, 0)};
+			std::memcpy(out, red.data(), red.size());
+			break;
+		}
+		}
+	}
+
+	void encode_block_rows(const uint8_t* pixels,
+						   const mip_level& level,
+						   uint8_t* blocks,
+						   texture_kind kind,
+						   uint32_t first_row,
+						   uint32_t last_row)
+	{
+		const uint32_t blocks_x {(level.width + 3) / 4};
+		const size_t size {liboceanlight::textures::block_bytes(kind)};
+		for (uint32_t by {first_row}; by < last_row; ++by)
+		{
+			for (uint32_t bx {0}; bx < blocks_x; ++bx)
+			{
+				encode_block(gather_block(pixels, level, bx, by),
+							 kind,
+							 blocks + (size_t {by} * blocks_x + bx) * size);
+			}
+		}
+	}
+} /* namespace */
+
+VkFormat liboceanlight::textures::block_format(texture_kind kind)
+{
+	switch (kind)
+	{
+	case texture_kind::normal:
+		return VK_FORMAT_BC5_UNORM_BLOCK;
+	case texture_kind::mask:
+		return VK_FORMAT_BC4_UNORM_BLOCK;
+	default:
+		return VK_FORMAT_BC7_SRGB_BLOCK;
+	}
+}
+
+size_t liboceanlight::textures::block_bytes(texture_kind kind)
+{
+	return kind == texture_kind::mask ? 8 : 16;
+}
+
+std::array<uint8_t, 16> liboceanlight::textures::encode_bc7_block(
+	const texel_block& block)
+{
+	rgba mean {};
+	for (size_t t {0}; t < 16; ++t)
+	{
+		for (size_t c {0}; c < 4; ++c)
+		{
+			mean[c] += block[t * 4 + c] / 16.0f;
+		}
+	}
+
+	std::array<rgba, 4> covariance {};
+	for (size_t t {0}; t < 16; ++t)
+	{
+		for (size_t i {0}; i < 4; ++i)
+		{
+			for (size_t j {0}; j < 4; ++j)
+			{
+				covariance[i][j] += (block[t * 4 + i] - mean[i]) *
+									(block[t * 4 + j] - mean[j]);
+			}
+		}
+	}
+
+	/* Principal axis by power iteration */
+	rgba axis {0.5f, 0.5f, 0.5f, 0.5f};
+	for (int step {0}; step < 8; ++step)
+	{
+		rgba next {};
+		for (size_t i {0}; i < 4; ++i)
+		{
+			for (size_t j {0}; j < 4; ++j)
+			{
+				next[i] += covariance[i][j] * axis[j];
+			}
+		}
+
+		const float length {std::sqrt(next[0] * next[0] + next[1] * next[1] +
+									  next[2] * next[2] + next[3] * next[3])};
+		if (length < 1e-6f)
+		{
+			break;
+		}
+
+		for (size_t i {0}; i < 4; ++i)
+		{
+			axis[i] = next[i] / length;
+		}
+	}
+
+	float t_min {0.0f}, t_max {0.0f};
+	for (size_t t {0}; t < 16; ++t)
+	{
+		float projection {0.0f};
+		for (size_t c {0}; c < 4; ++c)
+		{
+			projection += (block[t * 4 + c] - mean[c]) * axis[c];
+		}
+
+		t_min = std::min(t_min, projection);
+		t_max = std::max(t_max, projection);
+	}
+
+	rgba lo {}, hi {};
+	for (size_t c {0}; c < 4; ++c)
+	{
+		lo[c] = mean[c] + t_min * axis[c];
+		hi[c] = mean[c] + t_max * axis[c];
+	}
+
+	bc7_endpoint e0 {quantize_endpoint(lo)}, e1 {quantize_endpoint(hi)};
+	std::array<uint8_t, 16> indices {};
+	int error {assign_indices(block, e0, e1, indices)};
+
+	if (error > 0 && fit_endpoints(block, indices, lo, hi))
+	{
+		const bc7_endpoint f0 {quantize_endpoint(lo)};
+		const bc7_endpoint f1 {quantize_endpoint(hi)};
+		std::array<uint8_t, 16> fit_indices {};
+		const int fit_error {assign_indices(block, f0, f1, fit_indices)};
+		if (fit_error < error)
+		{
+			e0 = f0;
+			e1 = f1;
+			indices = fit_indices;
+			error = fit_error;
+		}
+	}
+
+	/* The first index is stored without its top bit. The weights are
+	 * symmetric, so swapping the endpoints mirrors every index. */
+	if (indices[0] >= 8)
+	{
+		std::swap(e0, e1);
+		for (auto& index : indices)
+		{
+			index = static_cast<uint8_t>(15 - index);
+		}
+	}
+
+	bit_writer<16> bits {};
+	bits.put(1u << 6, 7);
+	for (size_t c {0}; c < 4; ++c)
+	{
+		bits.put(static_cast<uint32_t>(e0.value[c]), 7);
+		bits.put(static_cast<uint32_t>(e1.value[c]), 7);
+	}
+
+	bits.put(static_cast<uint32_t>(e0.pbit), 1);
+	bits.put(static_cast<uint32_t>(e1.pbit), 1);
+	bits.put(indices[0], 3);
+	for (size_t t {1}; t < 16; ++t)
+	{
+		bits.put(indices[t], 4);
+	}
+
+	return bits.data();
+}
+
+std::array<uint8_t, 8> liboceanlight::textures::encode_bc4_block(
+	const texel_block& block,
+	size_t channel)
+{
+	uint8_t lo {255}, hi {0};
+	for (size_t t {0}; t < 16; ++t)
+	{
+		lo = std::min(lo, block[t * 4 + channel]);
+		hi = std::max(hi, block[t * 4 + channel]);
+	}
+
+	bit_writer<8> bits {};
+	bits.put(hi, 8);
+	bits.put(lo, 8);
+	if (hi == lo)
+	{
+		return bits.data();
+	}
+
+	/* hi > lo selects the eight value palette: hi, lo, then six steps
+	 * from hi towards lo */
+	std::array<int, 8> palette {hi, lo};
+	for (int i {2}; i < 8; ++i)
+	{
+		palette[i] = ((8 - i) * hi + (i - 1) * lo + 3) / 7;
+	}
+
+	for (size_t t {0}; t < 16; ++t)
+	{
+		const int value {block[t * 4 + channel]};
+		uint32_t best {0};
+		for (uint32_t i {1}; i < 8; ++i)
+		{
+			if (std::abs(palette[i] - value) <
+				std::abs(palette[best] - value))
+			{
+				best = i;
+			}
+		}
+
+		bits.put(best, 3);
+	}
+
+	return bits.data();
+}
+
+mip_chain liboceanlight::textures::compress_mip_chain(
+	const mip_chain& chain,
+	texture_kind kind,
+	liboceanlight::thread_pool* pool)
+{
+	mip_chain blocks {};
+	size_t total_bytes {0};
+	for (const auto& level : chain.levels)
+	{
+		blocks.levels.push_back({total_bytes, level.width, level.height});
+		total_bytes += size_t {(level.width + 3) / 4} *
+					   ((level.height + 3) / 4) * block_bytes(kind);
+	}
+
+	blocks.pixels.resize(total_bytes);
+
+	/* Levels are independent, every band of every level is one job */
+	std::vector<std::future<void>> jobs;
+	for (size_t i {0}; i < chain.levels.size(); ++i)
+	{
+		const mip_level& level {chain.levels[i]};
+		const uint8_t* pixels {chain.pixels.data() + level.offset};
+		uint8_t* out {blocks.pixels.data() + blocks.levels[i].offset};
+		const uint32_t blocks_y {(level.height + 3) / 4};
+
+		for (uint32_t row {0}; row < blocks_y; row += block_rows_per_job)
+		{
+			const uint32_t last {std::min(row + block_rows_per_job, blocks_y)};
+			if (!pool)
+			{
+				encode_block_rows(pixels, level, out, kind, row, last);
+				continue;
+			}
+
+			jobs.push_back(pool->submit([=, &level] {
+				encode_block_rows(pixels, level, out, kind, row, last);
+			}));
+		}
+	}
+
+	for (auto& job : jobs)
+	{
+		job.get();
+	}
+
+	return blocks;
+}
@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <cstdint>
+#include <liboceanlight/lol_device_memory.hpp>
+#include <liboceanlight/lol_range_allocator.hpp>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+liboceanlight::device_allocator::device_allocator(
+	VkDevice dev,
+	const VkPhysicalDeviceMemoryProperties& mem_props,
+	VkDeviceSize size) :
+	device {dev},
+	props {mem_props},
+	block_size {size}
+{
+}
+
+liboceanlight::device_allocator::~device_allocator() noexcept
+{
+	for (auto& b : blocks)
+	{
+		if (b.memory)
+		{
+			free_memory(b.memory, b.mapped);
+		}
+	}
+}
+
+uint32_t liboceanlight::device_allocator::find_type(
+	uint32_t type_bits,
+	VkMemoryPropertyFlags flags) const
+{
+	for (uint32_t i {0}; i < props.memoryTypeCount; ++i)
+	{
+		if ((type_bits & (1u << i)) &&
+			(props.memoryTypes[i].propertyFlags & flags) == flags)
+		{
+			return i;
+		}
+	}
+
+	throw std::runtime_error("Couldn't find suitable memory type");
+}
+
+uint32_t liboceanlight::device_allocator::heap_of(uint32_t type_index) const
+{
+	return props.memoryTypes[type_index].heapIndex;
+}
+
+VkDeviceMemory liboceanlight::device_allocator::allocate_memory(
+	uint32_t type_index,
+	VkDeviceSize size,
+	void*& mapped)
+{
+	VkMemoryAllocateInfo alloc_info {};
+	alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	alloc_info.allocationSize = size;
+	alloc_info.memoryTypeIndex = type_index;
+
+	VkDeviceMemory memory {nullptr};
+	VkResult rv {vkAllocateMemory(device, &alloc_info, nullptr, &memory)};
+	if (rv != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to allocate device memory");
+	}
+
+	mapped = nullptr;
+	if (props.memoryTypes[type_index].propertyFlags &
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+	{
+		rv = vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+		if (rv != VK_SUCCESS)
+		{
+			vkFreeMemory(device, memory, nullptr);
+			throw std::runtime_error("Failed to map device memory");
+		}
+	}
+
+	return memory;
+}
+
+void liboceanlight::device_allocator::free_memory(VkDeviceMemory memory,
+												  void* mapped)
+{
+	if (mapped)
+	{
+		vkUnmapMemory(device, memory);
+	}
+
+	vkFreeMemory(device, memory, nullptr);
+}
+
+bool liboceanlight::device_allocator::sub_allocate(
+	block& b,
+	const VkMemoryRequirements& reqs,
+	device_allocation& alloc)
+{
+	const uint64_t offset {
+		b.usage == memory_usage::transient
+			? b.transient.allocate(reqs.size, reqs.alignment)
+			: b.ranges.allocate(reqs.size, reqs.alignment)};
+	if (offset == range_allocator::npos)
+	{
+		return false;
+	}
+
+	++b.allocations;
+	alloc.memory = b.memory;
+	alloc.offset = offset;
+	alloc.size = reqs.size;
+	alloc.mapped = b.mapped ? static_cast<char*>(b.mapped) + offset
+							: nullptr;
+	alloc.type_index = b.type_index;
+	return true;
+}
+
+liboceanlight::device_allocation liboceanlight::device_allocator::allocate(
+	const VkMemoryRequirements& reqs,
+	VkMemoryPropertyFlags flags,
+	memory_usage usage,
+	memory_category category)
+{
+	const uint32_t type_index {find_type(reqs.memoryTypeBits, flags)};
+	device_allocation alloc {};
+	alloc.category = category;
+
+	std::scoped_lock lock {blocks_mtx};
+	auto& tally {categories.at(static_cast<size_t>(category))};
+	if (reqs.size > block_size / 2)
+	{
+		alloc.memory = allocate_memory(type_index, reqs.size, alloc.mapped);
+		alloc.size = reqs.size;
+		alloc.type_index = type_index;
+		auto& stats {dedicated.at(heap_of(type_index))};
+		stats.allocated += reqs.size;
+		stats.used += reqs.size;
+		++stats.memory_objects;
+		++stats.allocations;
+		tally.bytes += reqs.size;
+		++tally.allocations;
+		return alloc;
+	}
+
+	uint32_t free_slot {UINT32_MAX};
+	for (uint32_t i {0}; i < blocks.size(); ++i)
+	{
+		auto& b {blocks[i]};
+		if (!b.memory)
+		{
+			free_slot = std::min(free_slot, i);
+		}
+		else if (b.type_index == type_index && b.usage == usage &&
+			sub_allocate(b, reqs, alloc))
+		{
+			alloc.block = i;
+			tally.bytes += reqs.size;
+			++tally.allocations;
+			return alloc;
+		}
+	}
+
+	if (free_slot == UINT32_MAX)
+	{
+		free_slot = static_cast<uint32_t>(blocks.size());
+		blocks.emplace_back();
+	}
+
+	auto& b {blocks[free_slot]};
+	b.memory = allocate_memory(type_index, block_size, b.mapped);
+	b.type_index = type_index;
+	b.usage = usage;
+	b.ranges = range_allocator {block_size};
+	b.transient = linear_allocator {block_size};
+	b.allocations = 0;
+	sub_allocate(b, reqs, alloc);
+	alloc.block = free_slot;
+	tally.bytes += reqs.size;
+	++tally.allocations;
+	return alloc;
+}
+
+void liboceanlight::device_allocator::free(device_allocation& alloc)
+{
+	if (!alloc.memory)
+	{
+		return;
+	}
+
+	std::scoped_lock lock {blocks_mtx};
+	auto& tally {categories.at(static_cast<size_t>(alloc.category))};
+	tally.bytes -= alloc.size;
+	--tally.allocations;
+	if (alloc.block == UINT32_MAX)
+	{
+		free_memory(alloc.memory, alloc.mapped);
+		auto& stats {dedicated.at(heap_of(alloc.type_index))};
+		stats.allocated -= alloc.size;
+		stats.used -= alloc.size;
+		--stats.memory_objects;
+		--stats.allocations;
+		alloc = {};
+		return;
+	}
+
+	auto& b {blocks.at(alloc.block)};
+	if (b.usage == memory_usage::transient)
+	{
+		b.transient.free(alloc.size);
+	}
+	else
+	{
+		b.ranges.free(alloc.offset, alloc.size);
+	}
+
+	/* Staging comes and goes, so its blocks are kept for the next one */
+	if (--b.allocations == 0 && b.usage != memory_usage::transient)
+	{
+		free_memory(b.memory, b.mapped);
+		b.memory = nullptr;
+		b.mapped = nullptr;
+	}
+
+	alloc = {};
+}
+
+std::vector<liboceanlight::memory_heap_stats> liboceanlight::
+	device_allocator::heap_stats() const
+{
+	std::scoped_lock lock {blocks_mtx};
+	std::vector<memory_heap_stats> stats(props.memoryHeapCount);
+	for (uint32_t i {0}; i < props.memoryHeapCount; ++i)
+	{
+		stats[i] = dedicated[i];
+		stats[i].heap_size = props.memoryHeaps[i].size;
+	}
+
+	for (const auto& b : blocks)
+	{
+		if (!b.memory)
+		{
+			continue;
+		}
+
+		auto& heap {stats[heap_of(b.type_index)]};
+		heap.allocated += block_size;
+		heap.used += b.usage == memory_usage::transient ? b.transient.used()
+														: b.ranges.used();
+		++heap.memory_objects;
+		heap.allocations += b.allocations;
+	}
+
+	return stats;
+}
+
+std::array<liboceanlight::memory_category_stats,
+		   liboceanlight::memory_category_count>
+liboceanlight::device_allocator::category_stats() const
+{
+	std::scoped_lock lock {blocks_mtx};
+	return categories;
+}
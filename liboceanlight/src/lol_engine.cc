@@ -1,9 +1,14 @@
 #include <GLFW/glfw3.h>
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <config.h>
 #include <cstring>
+#include <exception>
+#include <future>
 #include <gsl/gsl>
 #include <iostream>
+#include <span>
 #include <vector>
 #include <vulkan/vulkan.h>
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -13,10 +18,24 @@
 #include <liboceanlight/lol_engine.hpp>
 #include <liboceanlight/lol_engine_init.hpp>
 #include <liboceanlight/lol_engine_shutdown.hpp>
+#include <liboceanlight/lol_hot_reload.hpp>
+#include <liboceanlight/lol_mesh_lod.hpp>
+#include <liboceanlight/lol_streaming.hpp>
 #include <liboceanlight/lol_utility.hpp>
 #include <liboceanlight/lol_window.hpp>
 
 using namespace liboceanlight::engine;
+
+namespace
+{
+	/* What LOD selection measures the models' size on screen with */
+	std::pair<glm::mat4, float> lod_view(const engine_data& eng_data)
+	{
+		return {eng_data.ubo.view * eng_data.ubo.model,
+				std::abs(eng_data.ubo.proj[1][1]) * 0.5f *
+					static_cast<float>(eng_data.swap_extent.height)};
+	}
+} /* namespace */
 double scroll_offset {0.0f}, cursor_posx {0.0f}, cursor_posy {0.0f};
 lol_camera camera;
 
@@ -50,6 +69,13 @@ void liboceanlight::engine::draw_frame(liboceanlight::window& window,
 									   engine_data& eng_data,
 									   double dt)
 {
+	/* Between frames, nothing is being recorded */
+	process_hot_reload(eng_data);
+	process_streaming(eng_data);
+	update_texture_residency(eng_data);
+	swap_uploaded(eng_data);
+	log_memory(eng_data);
+
 	vkWaitForFences(
 		eng_data.logical_device,
 		1,
@@ -80,16 +106,21 @@ void liboceanlight::engine::draw_frame(liboceanlight::window& window,
 				  1,
 				  &gsl::at(eng_data.in_flight_fences, eng_data.current_frame));
 
-	vkResetCommandBuffer(
-		gsl::at(eng_data.command_buffers, eng_data.current_frame),
-		0);
-	record_cmd_buffer(
-		eng_data,
-		gsl::at(eng_data.command_buffers, eng_data.current_frame),
-		image_index);
-
+	/* Before recording, LOD selection reads this frame's matrices */
 	update_uniform_buffer(eng_data, window, eng_data.current_frame, dt);
 
+	VkCommandBuffer cmd_buffer {
+		gsl::at(eng_data.command_buffers, eng_data.current_frame)};
+	if (eng_data.reuse_cmd_buffers)
+	{
+		cmd_buffer = reuse_cmd_buffer(eng_data, image_index);
+	}
+	else
+	{
+		vkResetCommandBuffer(cmd_buffer, 0);
+		record_cmd_buffer(eng_data, cmd_buffer, image_index);
+	}
+
 	VkSubmitInfo submit_info {};
 	std::array signal {gsl::at(eng_data.signal_sems, eng_data.current_frame)};
 	submit_info.signalSemaphoreCount = 1;
@@ -104,8 +135,7 @@ void liboceanlight::engine::draw_frame(liboceanlight::window& window,
 	submit_info.pWaitSemaphores = wait.data();
 	submit_info.pWaitDstStageMask = &wait_stages;
 	submit_info.commandBufferCount = 1;
-	submit_info.pCommandBuffers = &gsl::at(eng_data.command_buffers,
-										   eng_data.current_frame);
+	submit_info.pCommandBuffers = &cmd_buffer;
 
 	rv = vkQueueSubmit(
 		eng_data.graphics_queue,
@@ -175,11 +205,199 @@ void liboceanlight::engine::record_cmd_buffer(engine_data& eng_data,
 	pass_info.clearValueCount = static_cast<uint32_t>(clear_values.size());
 	pass_info.pClearValues = clear_values.data();
 
-	vkCmdBeginRenderPass(cmd_buffer, &pass_info, VK_SUBPASS_CONTENTS_INLINE);
-	vkCmdBindPipeline(cmd_buffer,
-					  VK_PIPELINE_BIND_POINT_GRAPHICS,
-					  eng_data.graphics_pipeline);
+	const auto view {lod_view(eng_data)};
+	const std::span<const models::lol_model> model_list {
+		eng_data.model_list};
+	const unsigned int threads {record_thread_count(eng_data)};
+	if (threads <= 1)
+	{
+		vkCmdBeginRenderPass(
+			cmd_buffer, &pass_info, VK_SUBPASS_CONTENTS_INLINE);
+		record_models(
+			eng_data, cmd_buffer, model_list, view.first, view.second);
+	}
+	else
+	{
+		/* Each thread records a run of the models into its own secondary
+		 * command buffer, from a pool no other thread touches */
+		vkCmdBeginRenderPass(cmd_buffer,
+							 &pass_info,
+							 VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+		VkCommandBufferInheritanceInfo inheritance {};
+		inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inheritance.renderPass = eng_data.render_pass;
+		inheritance.subpass = 0;
+		inheritance.framebuffer = pass_info.framebuffer;
+
+		auto& slots {gsl::at(eng_data.record_slots, eng_data.current_frame)};
+		auto record = [&](unsigned int thread) {
+			const size_t first {model_list.size() * thread / threads};
+			const size_t last {model_list.size() * (thread + 1) / threads};
+			const auto& slot {slots.at(thread)};
+			vkResetCommandPool(eng_data.logical_device, slot.pool, 0);
+
+			VkCommandBufferBeginInfo secondary_info {};
+			secondary_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			secondary_info.flags =
+				VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+				VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+			secondary_info.pInheritanceInfo = &inheritance;
+			if (vkBeginCommandBuffer(slot.cmd_buffer, &secondary_info) !=
+				VK_SUCCESS)
+			{
+				throw std::runtime_error(
+					"Failed to begin recording command buffer");
+			}
+
+			record_models(eng_data,
+						  slot.cmd_buffer,
+						  model_list.subspan(first, last - first),
+						  view.first,
+						  view.second);
+
+			if (vkEndCommandBuffer(slot.cmd_buffer) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to record command buffer");
+			}
+		};
+
+		/* The calling thread takes the first run. The others record
+		 * through this frame's locals, so they are waited for even when
+		 * it fails. */
+		std::vector<std::future<void>> jobs;
+		for (unsigned int thread {1}; thread < threads; ++thread)
+		{
+			jobs.push_back(eng_data.record_workers->submit(
+				[&record, thread] { record(thread); }));
+		}
+
+		std::exception_ptr failed;
+		try
+		{
+			record(0);
+		}
+		catch (...)
+		{
+			failed = std::current_exception();
+		}
+
+		for (auto& job : jobs)
+		{
+			job.wait();
+		}
+
+		if (failed)
+		{
+			std::rethrow_exception(failed);
+		}
+
+		for (auto& job : jobs)
+		{
+			job.get();
+		}
+
+		std::vector<VkCommandBuffer> secondaries;
+		for (unsigned int thread {0}; thread < threads; ++thread)
+		{
+			secondaries.push_back(slots[thread].cmd_buffer);
+		}
+		vkCmdExecuteCommands(cmd_buffer,
+							 static_cast<uint32_t>(secondaries.size()),
+							 secondaries.data());
+	}
+
+	vkCmdEndRenderPass(cmd_buffer);
+
+	rv = vkEndCommandBuffer(cmd_buffer);
+
+	if (rv != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to record command buffer");
+	}
+}
+
+unsigned int liboceanlight::engine::record_thread_count(engine_data& eng_data)
+{
+	if (eng_data.reuse_cmd_buffers)
+	{
+		return 1;
+	}
+
+	const auto& slots {
+		gsl::at(eng_data.record_slots, eng_data.current_frame)};
+	const size_t min_models {std::max<size_t>(eng_data.record_min_models, 1)};
+	return static_cast<unsigned int>(
+		std::clamp<size_t>(eng_data.model_list.size() / min_models,
+						   1,
+						   std::max<size_t>(slots.size(), 1)));
+}
+
+VkCommandBuffer liboceanlight::engine::reuse_cmd_buffer(
+	engine_data& eng_data,
+	uint32_t image_index)
+{
+	/* The LODs follow the camera, so the recorded draws go stale when
+	 * any of them changes */
+	auto lods {select_lods(eng_data)};
+	if (lods != eng_data.recorded_lods)
+	{
+		invalidate_recorded_frames(eng_data);
+		eng_data.recorded_lods = std::move(lods);
+	}
+
+	auto& frame {
+		gsl::at(eng_data.recorded_frames, eng_data.current_frame)
+			.at(image_index)};
+	if (frame.dirty)
+	{
+		/* Only this frame in flight submits it, and its fence has been
+		 * waited for */
+		vkResetCommandBuffer(frame.cmd_buffer, 0);
+		record_cmd_buffer(eng_data, frame.cmd_buffer, image_index);
+		frame.dirty = false;
+	}
+
+	return frame.cmd_buffer;
+}
+
+void liboceanlight::engine::invalidate_recorded_frames(engine_data& eng_data)
+{
+	for (auto& frames : eng_data.recorded_frames)
+	{
+		for (auto& frame : frames)
+		{
+			frame.dirty = true;
+		}
+	}
+}
+
+std::vector<uint32_t> liboceanlight::engine::select_lods(
+	engine_data& eng_data)
+{
+	const auto [model_view, pixels_per_radian] {lod_view(eng_data)};
+	std::vector<uint32_t> lods;
+	lods.reserve(eng_data.model_list.size());
+	for (const auto& model : eng_data.model_list)
+	{
+		lods.push_back(static_cast<uint32_t>(
+			models::select_lod(model.lods,
+							   model.bounds,
+							   model_view,
+							   pixels_per_radian,
+							   eng_data.lod_pixel_error)));
+	}
+
+	return lods;
+}
 
+void liboceanlight::engine::record_models(
+	engine_data& eng_data,
+	VkCommandBuffer cmd_buffer,
+	std::span<const models::lol_model> model_list,
+	const glm::mat4& model_view,
+	float pixels_per_radian)
+{
 	vkCmdBindDescriptorSets(
 		cmd_buffer,
 		VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -204,35 +422,70 @@ void liboceanlight::engine::record_cmd_buffer(engine_data& eng_data,
 	scissor.extent = eng_data.swap_extent;
 	vkCmdSetScissor(cmd_buffer, 0, 1, &scissor);
 
-	for (auto& model : eng_data.model_list)
-	{
-		std::array vertex_buffers {model.vertex_buffer};
-		VkDeviceSize offsets {0};
-		vkCmdBindVertexBuffers(cmd_buffer,
-							   0,
-							   1,
-							   vertex_buffers.data(),
-							   &offsets);
-		vkCmdBindIndexBuffer(cmd_buffer,
-							 model.index_buffer,
-							 0,
-							 VK_INDEX_TYPE_UINT32);
-
-		vkCmdDrawIndexed(cmd_buffer,
-						 static_cast<uint32_t>(model.indices.size()),
-						 1,
-						 0,
-						 0,
-						 0);
-	}
-
-	vkCmdEndRenderPass(cmd_buffer);
+	/* Every model draws from the same two pools */
+	const VkDeviceSize pool_offset {0};
+	vkCmdBindVertexBuffers(
+		cmd_buffer, 0, 1, &eng_data.vertex_pool.buffer, &pool_offset);
 
-	rv = vkEndCommandBuffer(cmd_buffer);
-
-	if (rv != VK_SUCCESS)
+	VkPipeline bound_pipeline {nullptr};
+	VkIndexType bound_index_type {VK_INDEX_TYPE_MAX_ENUM};
+	for (const auto& model : model_list)
 	{
-		throw std::runtime_error("Failed to record command buffer");
+		const auto pipeline {gsl::at(eng_data.graphics_pipelines,
+									 static_cast<size_t>(model.format))};
+		if (pipeline != bound_pipeline)
+		{
+			vkCmdBindPipeline(cmd_buffer,
+							  VK_PIPELINE_BIND_POINT_GRAPHICS,
+							  pipeline);
+			bound_pipeline = pipeline;
+		}
+
+		vkCmdPushConstants(cmd_buffer,
+						   eng_data.pipeline_layout,
+						   VK_SHADER_STAGE_VERTEX_BIT,
+						   0,
+						   sizeof(model.quantization),
+						   &model.quantization);
+		vkCmdPushConstants(cmd_buffer,
+						   eng_data.pipeline_layout,
+						   VK_SHADER_STAGE_FRAGMENT_BIT,
+						   sizeof(model.quantization),
+						   sizeof(model.material_index),
+						   &model.material_index);
+
+		if (model.index_type != bound_index_type)
+		{
+			vkCmdBindIndexBuffer(cmd_buffer,
+								 eng_data.index_pool.buffer,
+								 0,
+								 model.index_type);
+			bound_index_type = model.index_type;
+		}
+
+		const auto& lod {gsl::at(
+			model.lods,
+			models::select_lod(model.lods,
+							   model.bounds,
+							   model_view,
+							   pixels_per_radian,
+							   eng_data.lod_pixel_error))};
+		const std::span draws {model.draws.data() + lod.first_draw,
+							   lod.draw_count};
+
+		const auto first_index {static_cast<uint32_t>(
+			model.index_range.offset / index_size(model.index_type))};
+		const auto first_vertex {static_cast<int32_t>(
+			model.vertex_range.offset / vertex_stride(model.format))};
+		for (const auto& draw : draws)
+		{
+			vkCmdDrawIndexed(cmd_buffer,
+							 draw.index_count,
+							 1,
+							 first_index + draw.first_index,
+							 first_vertex + draw.vertex_offset,
+							 0);
+		}
 	}
 }
 
@@ -297,6 +550,7 @@ void liboceanlight::engine::update_uniform_buffer(
 	memcpy(gsl::at(eng_data.uniform_buffers_mapped, current_image),
 		   &ubo,
 		   sizeof(ubo));
+	eng_data.ubo = ubo;
 }
 
 void liboceanlight::engine::update_camera(liboceanlight::window& window,
@@ -333,48 +587,38 @@ void liboceanlight::engine::update_camera(liboceanlight::window& window,
 	}
 }
 
-void liboceanlight::engine::upload_buffer(engine_data& eng_data,
-										  const void* buff,
-										  VkDeviceSize buff_size,
-										  VkBufferUsageFlagBits usage,
-										  VkBuffer& dst,
-										  VkDeviceMemory& dst_mem)
+void liboceanlight::engine::upload_to_buffer(engine_data& eng_data,
+											 const void* data,
+											 VkDeviceSize data_size,
+											 VkBuffer dst,
+											 VkDeviceSize dst_offset)
 {
-	if ((!buff) | (buff_size == 0))
+	if ((!data) | (data_size == 0))
 	{
 		throw std::runtime_error("Invalid buffer to be uploaded");
 	}
 
-	VkBuffer staging_buff {nullptr};
-	VkDeviceMemory staging_buff_mem {nullptr};
-	create_buffer(eng_data,
-				  buff_size,
-				  VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-				  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-					  VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-				  staging_buff,
-				  staging_buff_mem);
-
-	void* data {};
-	vkMapMemory(eng_data.logical_device,
-				staging_buff_mem,
-				0,
-				buff_size,
-				0,
-				&data);
-	memcpy(data, buff, (size_t)buff_size);
-	vkUnmapMemory(eng_data.logical_device, staging_buff_mem);
-
-	create_buffer(eng_data,
-				  buff_size,
-				  VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage,
-				  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-				  dst,
-				  dst_mem);
-	copy_buffer(eng_data, staging_buff, dst, buff_size);
-
-	vkDestroyBuffer(eng_data.logical_device, staging_buff, nullptr);
-	vkFreeMemory(eng_data.logical_device, staging_buff_mem, nullptr);
+	/* Through the staging ring a chunk per submission */
+	const auto* bytes {static_cast<const uint8_t*>(data)};
+	VkDeviceSize done {0};
+	while (done < data_size)
+	{
+		const VkDeviceSize size {
+			std::min(data_size - done, staging_chunk_bytes(eng_data))};
+		const staging_region staging {acquire_staging(eng_data, size)};
+		memcpy(staging.data, bytes + done, (size_t)size);
+
+		VkCommandBuffer cmd_buffer {begin_transfer_cmds(eng_data)};
+		VkBufferCopy copy_region {};
+		copy_region.srcOffset = staging.offset;
+		copy_region.dstOffset = dst_offset + done;
+		copy_region.size = size;
+		vkCmdCopyBuffer(cmd_buffer, staging.buffer, dst, 1, &copy_region);
+		release_buffer_to_graphics(
+			eng_data, dst, copy_region.dstOffset, size);
+		end_single_time_cmds(eng_data, cmd_buffer);
+		done += size;
+	}
 }
 
 void liboceanlight::engine::recreate_swapchain(liboceanlight::window& w,
@@ -396,4 +640,106 @@ void liboceanlight::engine::recreate_swapchain(liboceanlight::window& w,
 	create_image_views(eng_data);
 	create_depth_resources(eng_data);
 	create_framebuffers(eng_data);
+
+	/* The framebuffers, and maybe their number, have changed */
+	cleanup_recorded_frames(eng_data);
+	create_recorded_frames(eng_data);
+}
+
+memory_snapshot liboceanlight::engine::snapshot_memory(engine_data& eng_data)
+{
+	memory_snapshot snapshot {};
+	snapshot.categories = eng_data.allocator->category_stats();
+	snapshot.heaps = eng_data.allocator->heap_stats();
+	snapshot.driver_budget = eng_data.memory_budget_supported;
+
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budget {};
+	budget.sType =
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+	if (snapshot.driver_budget)
+	{
+		VkPhysicalDeviceMemoryProperties2 props {};
+		props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+		props.pNext = &budget;
+		vkGetPhysicalDeviceMemoryProperties2(eng_data.physical_device,
+											 &props);
+	}
+
+	for (size_t i {0}; i < snapshot.heaps.size(); ++i)
+	{
+		auto& heap {snapshot.heaps[i]};
+		heap.budget = snapshot.driver_budget ? gsl::at(budget.heapBudget, i)
+											 : heap.heap_size;
+		heap.usage = snapshot.driver_budget ? gsl::at(budget.heapUsage, i)
+											: heap.allocated;
+	}
+
+	return snapshot;
+}
+
+VkDeviceSize liboceanlight::engine::vram_headroom(engine_data& eng_data)
+{
+	const auto snapshot {snapshot_memory(eng_data)};
+	const auto& props {eng_data.memory_props};
+	const liboceanlight::memory_heap_stats* vram {nullptr};
+	for (uint32_t i {0}; i < props.memoryHeapCount; ++i)
+	{
+		const auto& heap {snapshot.heaps[i]};
+		if ((gsl::at(props.memoryHeaps, i).flags &
+			 VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) &&
+			(!vram || heap.heap_size > vram->heap_size))
+		{
+			vram = &heap;
+		}
+	}
+
+	if (!vram || vram->usage + eng_data.memory_reserve >= vram->budget)
+	{
+		return 0;
+	}
+
+	return vram->budget - vram->usage - eng_data.memory_reserve;
+}
+
+void liboceanlight::engine::log_memory(engine_data& eng_data)
+{
+	if (eng_data.memory_log_interval <= 0.0)
+	{
+		return;
+	}
+
+	const auto now {std::chrono::steady_clock::now()};
+	const std::chrono::duration<double> since {now - eng_data.memory_logged};
+	if (since.count() < eng_data.memory_log_interval)
+	{
+		return;
+	}
+
+	eng_data.memory_logged = now;
+	print_memory_snapshot(snapshot_memory(eng_data));
+}
+
+void liboceanlight::engine::print_memory_snapshot(
+	const memory_snapshot& snapshot)
+{
+	constexpr VkDeviceSize mib {1ull << 20};
+	std::cout << "Device memory:";
+	for (size_t i {0}; i < snapshot.categories.size(); ++i)
+	{
+		const auto& category {snapshot.categories[i]};
+		std::cout << " " << liboceanlight::memory_category_names[i] << " "
+				  << category.bytes / mib << " MiB ("
+				  << category.allocations << ")";
+	}
+	std::cout << "\n";
+
+	for (size_t i {0}; i < snapshot.heaps.size(); ++i)
+	{
+		const auto& heap {snapshot.heaps[i]};
+		std::cout << "  heap " << i << ": " << heap.used / mib << " of "
+				  << heap.allocated / mib << " MiB allocated used, "
+				  << heap.usage / mib << " of " << heap.budget / mib
+				  << " MiB budget used"
+				  << (snapshot.driver_budget ? "\n" : " (heap size)\n");
+	}
 }
@@ -1,5 +1,7 @@
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <cstddef>
 #include <config.h>
 #include <cstring>
 #include <filesystem>
@@ -9,26 +11,470 @@
 #include <liboceanlight/lol_engine.hpp>
 #include <liboceanlight/lol_engine_init.hpp>
 #include <liboceanlight/lol_engine_shutdown.hpp>
+#include <liboceanlight/lol_hot_reload.hpp>
+#include <liboceanlight/lol_image_batch.hpp>
+#include <liboceanlight/lol_index_packing.hpp>
+#include <liboceanlight/lol_mipmap.hpp>
+#include <liboceanlight/lol_models.hpp>
+#include <liboceanlight/lol_streaming.hpp>
+#include <liboceanlight/lol_texture_cache.hpp>
+#include <liboceanlight/lol_texture_residency.hpp>
+#include <liboceanlight/lol_thread_pool.hpp>
 #include <liboceanlight/lol_utility.hpp>
+#include <liboceanlight/lol_vertex_packing.hpp>
+#include <memory>
 #include <span>
 #include <stb_image.h>
 #include <tiny_gltf.h>
-#include <tiny_obj_loader.h>
-#include <unordered_map>
+#include <tuple>
 #include <vector>
 
 namespace fs = std::filesystem;
 using namespace liboceanlight::engine;
 
+namespace
+{
+	template <size_t N>
+	VkPipelineVertexInputStateCreateInfo make_vertex_input_info(
+		const VkVertexInputBindingDescription& binding_desc,
+		const std::array<VkVertexInputAttributeDescription, N>&
+			attribute_descs)
+	{
+		VkPipelineVertexInputStateCreateInfo vertex_input_info {};
+		vertex_input_info.sType =
+			VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		vertex_input_info.vertexBindingDescriptionCount = 1;
+		vertex_input_info.pVertexBindingDescriptions = &binding_desc;
+		vertex_input_info.vertexAttributeDescriptionCount = N;
+		vertex_input_info.pVertexAttributeDescriptions =
+			attribute_descs.data();
+		return vertex_input_info;
+	}
+
+	/* What create_logical_device enables for the texture array */
+	bool supports_bindless_textures(VkPhysicalDevice dev)
+	{
+		VkPhysicalDeviceVulkan12Features vk12_features {};
+		vk12_features.sType =
+			VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_12_FEATURES;
+		VkPhysicalDeviceFeatures2 features {};
+		features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features.pNext = &vk12_features;
+		vkGetPhysicalDeviceFeatures2(dev, &features);
+
+		return vk12_features.descriptorIndexing &&
+			   vk12_features.runtimeDescriptorArray &&
+			   vk12_features.descriptorBindingPartiallyBound &&
+			   vk12_features.descriptorBindingSampledImageUpdateAfterBind &&
+			   vk12_features.descriptorBindingUpdateUnusedWhilePending;
+	}
+
+	VkDeviceSize staging_alignment(const engine_data& eng_data)
+	{
+		return std::max<VkDeviceSize>(
+			16,
+			eng_data.device_props.limits.optimalBufferCopyOffsetAlignment);
+	}
+
+	VkDeviceSize align_staging(const engine_data& eng_data,
+							   VkDeviceSize offset)
+	{
+		const VkDeviceSize alignment {staging_alignment(eng_data)};
+		return (offset + alignment - 1) / alignment * alignment;
+	}
+
+	VkCommandBuffer allocate_upload_cmds(engine_data& eng_data,
+										 VkCommandPool pool)
+	{
+		VkCommandBufferAllocateInfo alloc_info {};
+		alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		alloc_info.commandPool = pool;
+		alloc_info.commandBufferCount = 1;
+
+		VkCommandBuffer cmd_buffer {};
+		VkResult rv = vkAllocateCommandBuffers(eng_data.logical_device,
+											   &alloc_info,
+											   &cmd_buffer);
+		if (rv != VK_SUCCESS)
+		{
+			throw std::runtime_error(
+				"Failed to allocate upload command buffer");
+		}
+
+		VkCommandBufferBeginInfo begin_info {};
+		begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		rv = vkBeginCommandBuffer(cmd_buffer, &begin_info);
+		if (rv != VK_SUCCESS)
+		{
+			vkFreeCommandBuffers(
+				eng_data.logical_device, pool, 1, &cmd_buffer);
+			throw std::runtime_error(
+				"Failed to begin recording upload command buffer");
+		}
+
+		return cmd_buffer;
+	}
+
+	upload_ticket submit_upload_cmds(engine_data& eng_data)
+	{
+		VkCommandBuffer cmd_buffer {eng_data.upload_cmd};
+
+		/* Nothing waits for the queue any more, so later reads of the
+		 * copied buffers have to wait for the copies */
+		VkMemoryBarrier barrier {};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+								VK_ACCESS_INDEX_READ_BIT |
+								VK_ACCESS_UNIFORM_READ_BIT |
+								VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(cmd_buffer,
+							 VK_PIPELINE_STAGE_TRANSFER_BIT,
+							 VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+								 VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+								 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+							 0,
+							 1,
+							 &barrier,
+							 0,
+							 nullptr,
+							 0,
+							 nullptr);
+		VkResult rv = vkEndCommandBuffer(cmd_buffer);
+		if (rv != VK_SUCCESS)
+		{
+			throw std::runtime_error(
+				"Failed to record upload command buffer");
+		}
+
+		/* The staging written since the last submission is read by this */
+		const upload_ticket serial {++eng_data.upload_serial};
+		VkCommandBuffer transfer_cmd {eng_data.transfer_cmd};
+		if (transfer_cmd)
+		{
+			rv = vkEndCommandBuffer(transfer_cmd);
+			if (rv != VK_SUCCESS)
+			{
+				throw std::runtime_error(
+					"Failed to record transfer command buffer");
+			}
+
+			VkTimelineSemaphoreSubmitInfo timeline_info {};
+			timeline_info.sType =
+				VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+			timeline_info.signalSemaphoreValueCount = 1;
+			timeline_info.pSignalSemaphoreValues = &serial;
+
+			VkSubmitInfo submit_info {};
+			submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submit_info.pNext = &timeline_info;
+			submit_info.commandBufferCount = 1;
+			submit_info.pCommandBuffers = &transfer_cmd;
+			submit_info.signalSemaphoreCount = 1;
+			submit_info.pSignalSemaphores = &eng_data.transfer_timeline;
+			rv = vkQueueSubmit(
+				eng_data.transfer_queue, 1, &submit_info, nullptr);
+			if (rv != VK_SUCCESS)
+			{
+				throw std::runtime_error(
+					"Failed to submit transfer command buffer");
+			}
+		}
+
+		/* The acquires wait for the copies on the transfer queue */
+		const uint32_t waits {transfer_cmd ? 1u : 0u};
+		const VkPipelineStageFlags wait_stage {
+			VK_PIPELINE_STAGE_ALL_COMMANDS_BIT};
+		VkTimelineSemaphoreSubmitInfo timeline_info {};
+		timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timeline_info.waitSemaphoreValueCount = waits;
+		timeline_info.pWaitSemaphoreValues = &serial;
+		timeline_info.signalSemaphoreValueCount = 1;
+		timeline_info.pSignalSemaphoreValues = &serial;
+
+		VkSubmitInfo submit_info {};
+		submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submit_info.pNext = &timeline_info;
+		submit_info.waitSemaphoreCount = waits;
+		submit_info.pWaitSemaphores = &eng_data.transfer_timeline;
+		submit_info.pWaitDstStageMask = &wait_stage;
+		submit_info.commandBufferCount = 1;
+		submit_info.pCommandBuffers = &cmd_buffer;
+		submit_info.signalSemaphoreCount = 1;
+		submit_info.pSignalSemaphores = &eng_data.upload_timeline;
+		rv = vkQueueSubmit(eng_data.graphics_queue, 1, &submit_info, nullptr);
+		if (rv != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to submit upload command buffer");
+		}
+
+		eng_data.staging_ring.submit(serial);
+		eng_data.pending_uploads.push_back(
+			{serial,
+			 cmd_buffer,
+			 transfer_cmd,
+			 std::move(eng_data.upload_garbage)});
+		eng_data.upload_garbage.clear();
+		eng_data.upload_cmd = nullptr;
+		eng_data.transfer_cmd = nullptr;
+		return serial;
+	}
+
+	void retire_upload(engine_data& eng_data, pending_upload& done)
+	{
+		vkFreeCommandBuffers(eng_data.logical_device,
+							 eng_data.command_pool,
+							 1,
+							 &done.cmd_buffer);
+		if (done.transfer_cmd_buffer)
+		{
+			vkFreeCommandBuffers(eng_data.logical_device,
+								 eng_data.transfer_cmd_pool,
+								 1,
+								 &done.transfer_cmd_buffer);
+		}
+
+		for (auto& [buff, buff_mem] : done.buffers)
+		{
+			destroy_buffer(eng_data, buff, buff_mem);
+		}
+
+		eng_data.staging_ring.complete(done.serial);
+	}
+
+	uint64_t uploads_finished(engine_data& eng_data)
+	{
+		uint64_t serial {0};
+		vkGetSemaphoreCounterValue(
+			eng_data.logical_device, eng_data.upload_timeline, &serial);
+		return serial;
+	}
+
+	/* Rows of texels one row of blocks covers */
+	uint32_t texel_block_height(VkFormat fmt)
+	{
+		switch (fmt)
+		{
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+			return 4;
+		default:
+			return 1;
+		}
+	}
+
+	/* One staging buffer and one submission for the decoded images. An
+	 * image with cooked bytes is copied in as is, in its format. */
+	VkDeviceSize upload_texture_group(
+		engine_data& eng_data,
+		std::span<const uint32_t> slots,
+		std::span<liboceanlight::textures::staged_image> images,
+		std::span<const std::vector<uint8_t>> cooked,
+		std::span<const VkFormat> formats)
+	{
+		const size_t total {liboceanlight::textures::layout_image_batch(
+			images, staging_alignment(eng_data))};
+		if (total == 0)
+		{
+			return 0;
+		}
+
+		/* A group only outgrows the ring when one image does */
+		staging_region staging_at {};
+		liboceanlight::device_allocation staging_buff_mem {};
+		if (total <= staging_chunk_bytes(eng_data))
+		{
+			staging_at = acquire_staging(eng_data, total);
+		}
+		else
+		{
+			create_buffer(eng_data,
+						  total,
+						  VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+						  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+							  VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+						  staging_at.buffer,
+						  staging_buff_mem,
+						  liboceanlight::memory_category::staging,
+						  liboceanlight::memory_usage::transient);
+			staging_at.data = static_cast<uint8_t*>(staging_buff_mem.mapped);
+		}
+
+		const std::span mapped {staging_at.data, total};
+
+		/* With texture residency the chains are kept on the host and only
+		 * their small levels are staged */
+		const bool resident {eng_data.texture_residency_enabled};
+		std::vector<uint8_t> decoded(resident ? total : 0);
+		const std::span staging {resident ? std::span {decoded} : mapped};
+		for (size_t i {0}; i < images.size(); ++i)
+		{
+			if (!cooked[i].empty())
+			{
+				std::memcpy(staging.data() + images[i].offset,
+							cooked[i].data(),
+							cooked[i].size());
+				images[i].decoded = true;
+			}
+		}
+
+		liboceanlight::textures::decode_image_batch(
+			images, staging, eng_data.workers.get());
+
+		std::vector<std::shared_ptr<const liboceanlight::textures::mip_chain>>
+			sources(images.size());
+		std::vector<uint32_t> base_levels(images.size(), 0);
+		for (size_t i {0}; resident && i < images.size(); ++i)
+		{
+			const auto& image {images[i]};
+			if (!image.decoded)
+			{
+				continue;
+			}
+
+			auto source {
+				std::make_shared<liboceanlight::textures::mip_chain>()};
+			const auto slice {staging.subspan(image.offset, image.size)};
+			source->pixels.assign(slice.begin(), slice.end());
+			source->levels = image.levels;
+			base_levels[i] = liboceanlight::textures::first_level_within(
+				image.levels, eng_data.texture_initial_size);
+
+			const size_t first_byte {image.levels[base_levels[i]].offset};
+			std::memcpy(mapped.data() + image.offset + first_byte,
+						slice.data() + first_byte,
+						image.size - first_byte);
+			sources[i] = std::move(source);
+		}
+
+		std::vector<std::pair<uint32_t, texture>> loaded;
+		VkDeviceSize uploaded {0};
+		VkCommandBuffer cmd_buffer {begin_single_time_cmds(eng_data)};
+		VkCommandBuffer transfer_cmd {begin_transfer_cmds(eng_data)};
+		for (size_t i {0}; i < images.size(); ++i)
+		{
+			const auto& image {images[i]};
+			if (!image.decoded)
+			{
+				continue;
+			}
+
+			/* Without GPU blits decode_image_batch filtered the levels */
+			const bool blit {cooked[i].empty() && use_gpu_mipmaps(eng_data)};
+			const std::span levels {
+				std::span {image.levels}.subspan(base_levels[i])};
+			texture fresh {.path = image.path,
+						   .format = formats[i],
+						   .base_level = base_levels[i],
+						   .source = sources[i]};
+			fresh.mip_levels = blit ? liboceanlight::textures::
+										  mip_level_count(image.width,
+														  image.height)
+									: static_cast<uint32_t>(levels.size());
+			create_image(eng_data,
+						 levels.front().width,
+						 levels.front().height,
+						 fresh.mip_levels,
+						 fresh.format,
+						 VK_IMAGE_TILING_OPTIMAL,
+						 (blit ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0) |
+							 VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+							 VK_IMAGE_USAGE_SAMPLED_BIT,
+						 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+						 fresh.img,
+						 fresh.img_mem,
+						 liboceanlight::memory_category::textures);
+
+			/* Blitting the mips needs the graphics queue */
+			VkCommandBuffer copy_cmd {blit ? cmd_buffer : transfer_cmd};
+			record_img_barrier(copy_cmd,
+							   fresh.img,
+							   fresh.format,
+							   VK_IMAGE_LAYOUT_UNDEFINED,
+							   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+							   0,
+							   fresh.mip_levels);
+			record_copy_mips(copy_cmd,
+							 staging_at.buffer,
+							 staging_at.offset + image.offset,
+							 fresh.img,
+							 levels);
+			if (blit)
+			{
+				record_mipmaps(cmd_buffer,
+							   fresh.img,
+							   image.width,
+							   image.height,
+							   fresh.mip_levels);
+			}
+			else
+			{
+				release_img_to_graphics(eng_data, fresh.img, fresh.mip_levels);
+			}
+
+			uploaded += image.size - levels.front().offset;
+			loaded.emplace_back(slots[i], std::move(fresh));
+		}
+		end_single_time_cmds(eng_data, transfer_cmd);
+		end_single_time_cmds(eng_data, cmd_buffer);
+
+		if (staging_buff_mem.memory)
+		{
+			destroy_buffer_after_upload(
+				eng_data, staging_at.buffer, staging_buff_mem);
+		}
+
+		for (auto& [slot, fresh] : loaded)
+		{
+			create_texture_img_view(eng_data, fresh);
+			std::swap(eng_data.textures.at(slot), fresh);
+			destroy_texture(eng_data, fresh);
+			if (eng_data.descriptor_pool)
+			{
+				write_texture_descriptor(eng_data, slot);
+			}
+		}
+
+		return uploaded;
+	}
+
+	void write_geometry(engine_data& eng_data,
+						const geometry_pool& pool,
+						const liboceanlight::models::geometry_range& range,
+						std::span<const std::byte> data)
+	{
+		if (pool.mem.mapped)
+		{
+			std::memcpy(static_cast<std::byte*>(pool.mem.mapped) +
+							range.offset,
+						data.data(),
+						data.size());
+			return;
+		}
+
+		upload_to_buffer(
+			eng_data, data.data(), data.size(), pool.buffer, range.offset);
+	}
+} /* namespace */
+
 int liboceanlight::engine::init(liboceanlight::window& w,
 								engine_data& eng_data)
 {
+	create_thread_pool(eng_data);
 	create_instance(eng_data);
 	create_physical_device(eng_data);
 
 	create_surface(w, eng_data);
 	get_queue_fams(eng_data);
 	create_logical_device(eng_data);
+	create_allocator(eng_data);
+	create_staging_ring(eng_data);
+	create_upload_timelines(eng_data);
 
 	get_swapchain_details(w, eng_data);
 	create_swapchain(eng_data);
@@ -39,20 +485,43 @@ int liboceanlight::engine::init(liboceanlight::window& w,
 	create_pipeline(eng_data);
 
 	create_cmd_pool(eng_data);
+
+	/* Every upload up to the first frame goes out in a few submissions,
+	 * which the frames are queued behind */
+	begin_upload_batch(eng_data);
 	create_depth_resources(eng_data);
 	create_framebuffers(eng_data);
-	create_texture_img(eng_data);
-	create_texture_img_view(eng_data);
 	create_texture_sampler(eng_data);
+	create_placeholder_texture(eng_data);
+	create_material_buffer(eng_data);
+
+	if (eng_data.async_streaming)
+	{
+		/* Draw placeholders until start_streaming swaps the assets in */
+		create_geometry_pools(eng_data);
+		create_placeholders(eng_data);
+	}
+	else
+	{
+		load_models(eng_data);
+		create_geometry_pools(eng_data);
+		create_vertex_buffers(eng_data);
+		create_index_buffers(eng_data);
+		assign_materials(eng_data);
+		create_textures(eng_data);
+	}
+
+	end_upload_batch(eng_data);
 
-	load_models(eng_data);
-	create_vertex_buffers(eng_data);
-	create_index_buffers(eng_data);
 	create_uniform_buffers(eng_data);
 	create_descriptor_pool(eng_data);
 	create_descriptor_sets(eng_data);
 	create_cmd_buffer(eng_data);
+	create_record_pools(eng_data);
+	create_recorded_frames(eng_data);
 	create_sync_objects(eng_data);
+	create_hot_reload(eng_data);
+	start_streaming(eng_data);
 
 	return 1;
 }
@@ -142,6 +611,20 @@ void liboceanlight::engine::create_physical_device(engine_data& eng_data)
 	}
 
 	check_dev_ext_support(eng_data);
+	vkGetPhysicalDeviceMemoryProperties(eng_data.physical_device,
+										&eng_data.memory_props);
+	find_mappable_vram(eng_data);
+
+	/* Otherwise texture mip chains are filtered on the CPU */
+	VkFormatProperties fmt_props {};
+	vkGetPhysicalDeviceFormatProperties(eng_data.physical_device,
+										VK_FORMAT_R8G8B8A8_SRGB,
+										&fmt_props);
+	const VkFormatFeatureFlags blit_features {
+		VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+		VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT};
+	eng_data.texture_blit_mips = (fmt_props.optimalTilingFeatures &
+								  blit_features) == blit_features;
 }
 
 void liboceanlight::engine::create_surface(window& w, engine_data& eng_data)
@@ -199,27 +682,79 @@ void liboceanlight::engine::get_queue_fams(engine_data& eng_data)
 	{
 		throw std::runtime_error("Failed to find appropriate queue");
 	}
+
+	/* A family without graphics is the copy engine, which runs beside
+	 * rendering. Copies of any size need a granularity of one texel. */
+	eng_data.transfer_queue_index = eng_data.graphics_queue_index;
+	for (uint32_t i {0}; i < count && eng_data.dedicated_transfer_queue; ++i)
+	{
+		const auto& props {queue_fam_props[i]};
+		const auto& granularity {props.minImageTransferGranularity};
+		if ((props.queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+			!(props.queueFlags & VK_QUEUE_GRAPHICS_BIT) &&
+			granularity.width == 1 && granularity.height == 1 &&
+			granularity.depth == 1)
+		{
+			eng_data.transfer_queue_index = i;
+			if (!(props.queueFlags & VK_QUEUE_COMPUTE_BIT))
+			{
+				break;
+			}
+		}
+	}
+}
+
+bool liboceanlight::engine::use_transfer_queue(engine_data& eng_data)
+{
+	return eng_data.transfer_queue_index != eng_data.graphics_queue_index;
 }
 
 void liboceanlight::engine::create_logical_device(engine_data& eng_data)
 {
 	float queue_priority {1.0f};
-	VkDeviceQueueCreateInfo queue_info {};
-	queue_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-	queue_info.queueFamilyIndex = eng_data.graphics_queue_index;
-	queue_info.queueCount = 1;
-	queue_info.pQueuePriorities = &queue_priority;
+	std::array<VkDeviceQueueCreateInfo, 2> queue_infos {};
+	for (auto& queue_info : queue_infos)
+	{
+		queue_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+		queue_info.queueCount = 1;
+		queue_info.pQueuePriorities = &queue_priority;
+	}
 
+	queue_infos[0].queueFamilyIndex = eng_data.graphics_queue_index;
+	queue_infos[1].queueFamilyIndex = eng_data.transfer_queue_index;
+
+	/* Block compressed textures are optional, RGBA8 is the fallback */
+	eng_data.texture_bc_supported =
+		eng_data.supported_device_features.textureCompressionBC;
 	VkPhysicalDeviceFeatures requested_dev_features {
-		.samplerAnisotropy = VK_TRUE};
+		.samplerAnisotropy = VK_TRUE,
+		.textureCompressionBC = eng_data.texture_bc_supported};
+	/* The bindless texture array: select_physical_dev only picks devices
+	 * supporting all of these */
+	VkPhysicalDeviceVulkan12Features vk12_features {};
+	vk12_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_12_FEATURES;
+	vk12_features.descriptorIndexing = VK_TRUE;
+	vk12_features.runtimeDescriptorArray = VK_TRUE;
+	vk12_features.descriptorBindingPartiallyBound = VK_TRUE;
+	vk12_features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+	vk12_features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+	/* Core since 1.2, every device has it */
+	vk12_features.timelineSemaphore = VK_TRUE;
+
 	VkDeviceCreateInfo dev_info {};
 	dev_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-	dev_info.queueCreateInfoCount = 1;
-	dev_info.pQueueCreateInfos = &queue_info;
+	dev_info.pNext = &vk12_features;
+	dev_info.queueCreateInfoCount = use_transfer_queue(eng_data) ? 2 : 1;
+	dev_info.pQueueCreateInfos = queue_infos.data();
 	dev_info.pEnabledFeatures = &requested_dev_features;
-	dev_info.enabledExtensionCount = static_cast<uint32_t>(
-		eng_data.dev_extensions.size());
-	dev_info.ppEnabledExtensionNames = eng_data.dev_extensions.data();
+	std::vector<const char*> extensions(eng_data.dev_extensions.begin(),
+										eng_data.dev_extensions.end());
+	if (eng_data.memory_budget_supported)
+	{
+		extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+	}
+	dev_info.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+	dev_info.ppEnabledExtensionNames = extensions.data();
 
 	VkResult rv = vkCreateDevice(eng_data.physical_device,
 								 &dev_info,
@@ -235,6 +770,437 @@ void liboceanlight::engine::create_logical_device(engine_data& eng_data)
 					 eng_data.graphics_queue_index,
 					 0,
 					 &eng_data.graphics_queue);
+	vkGetDeviceQueue(eng_data.logical_device,
+					 eng_data.transfer_queue_index,
+					 0,
+					 &eng_data.transfer_queue);
+}
+
+void liboceanlight::engine::create_allocator(engine_data& eng_data)
+{
+	eng_data.allocator = std::make_unique<liboceanlight::device_allocator>(
+		eng_data.logical_device,
+		eng_data.memory_props,
+		eng_data.memory_block_size);
+}
+
+void liboceanlight::engine::create_staging_ring(engine_data& eng_data)
+{
+	create_buffer(eng_data,
+				  eng_data.staging_ring_size,
+				  VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+					  VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+				  eng_data.staging_buffer,
+				  eng_data.staging_buffer_mem,
+				  memory_category::staging);
+	eng_data.staging_ring =
+		liboceanlight::ring_allocator {eng_data.staging_ring_size};
+}
+
+void liboceanlight::engine::find_mappable_vram(engine_data& eng_data)
+{
+	const VkMemoryPropertyFlags flags {
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+		VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
+	const auto& props {eng_data.memory_props};
+	eng_data.mappable_vram = 0;
+	for (uint32_t i {0}; i < props.memoryTypeCount; ++i)
+	{
+		const auto& type {gsl::at(props.memoryTypes, i)};
+		if ((type.propertyFlags & flags) == flags)
+		{
+			eng_data.mappable_vram =
+				gsl::at(props.memoryHeaps, type.heapIndex).size;
+			break;
+		}
+	}
+}
+
+bool liboceanlight::engine::write_vram_directly(engine_data& eng_data)
+{
+	if (!eng_data.direct_device_writes || !eng_data.mappable_vram)
+	{
+		return false;
+	}
+
+	const auto& props {eng_data.memory_props};
+	for (uint32_t i {0}; i < props.memoryHeapCount; ++i)
+	{
+		const auto& heap {gsl::at(props.memoryHeaps, i)};
+		if ((heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) &&
+			heap.size > eng_data.mappable_vram)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+VkMemoryPropertyFlags liboceanlight::engine::host_write_mem_props(
+	engine_data& eng_data)
+{
+	VkMemoryPropertyFlags flags {VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+								 VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
+	if (eng_data.mappable_vram)
+	{
+		flags |= VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	}
+
+	return flags;
+}
+
+VkDeviceSize liboceanlight::engine::staging_chunk_bytes(engine_data& eng_data)
+{
+	return eng_data.staging_ring.capacity() / 2;
+}
+
+staging_region liboceanlight::engine::acquire_staging(engine_data& eng_data,
+													  VkDeviceSize size)
+{
+	auto& ring {eng_data.staging_ring};
+	uint64_t offset {ring.allocate(size, staging_alignment(eng_data))};
+	if (offset == liboceanlight::ring_allocator::npos && eng_data.upload_cmd)
+	{
+		/* What the batch staged so far is only freed once submitted */
+		flush_upload_batch(eng_data);
+	}
+
+	while (offset == liboceanlight::ring_allocator::npos)
+	{
+		if (!ring.oldest_pending())
+		{
+			throw std::runtime_error("Upload too large for the staging ring");
+		}
+
+		wait_upload(eng_data, ring.oldest_pending());
+		offset = ring.allocate(size, staging_alignment(eng_data));
+	}
+
+	return {eng_data.staging_buffer,
+			offset,
+			static_cast<uint8_t*>(eng_data.staging_buffer_mem.mapped) +
+				offset};
+}
+
+void liboceanlight::engine::stage_img_upload(
+	engine_data& eng_data,
+	VkImage img,
+	VkFormat fmt,
+	std::span<const textures::mip_level> levels,
+	std::span<const uint8_t> bytes,
+	uint32_t level_count,
+	bool to_shader_read)
+{
+	const VkDeviceSize chunk {staging_chunk_bytes(eng_data)};
+	const auto pieces {textures::split_image_copy(
+		levels, bytes.size(), texel_block_height(fmt), chunk)};
+
+	/* As many pieces per submission as fit in a chunk */
+	size_t first {0};
+	while (first < pieces.size())
+	{
+		size_t last {first};
+		VkDeviceSize size {0};
+		while (last < pieces.size() &&
+			   (last == first ||
+				align_staging(eng_data, size) + pieces[last].size <= chunk))
+		{
+			size = align_staging(eng_data, size) + pieces[last].size;
+			++last;
+		}
+
+		/* Blitting the mips needs the graphics queue */
+		const staging_region staging {acquire_staging(eng_data, size)};
+		VkCommandBuffer cmd_buffer {to_shader_read
+										? begin_transfer_cmds(eng_data)
+										: begin_single_time_cmds(eng_data)};
+		if (first == 0)
+		{
+			record_img_barrier(cmd_buffer,
+							   img,
+							   fmt,
+							   VK_IMAGE_LAYOUT_UNDEFINED,
+							   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+							   0,
+							   level_count);
+		}
+
+		std::vector<VkBufferImageCopy> regions;
+		VkDeviceSize at {0};
+		for (size_t i {first}; i < last; ++i)
+		{
+			const auto& piece {pieces[i]};
+			at = align_staging(eng_data, at);
+			std::memcpy(staging.data + at,
+						bytes.data() + piece.offset,
+						piece.size);
+
+			VkBufferImageCopy region {};
+			region.bufferOffset = staging.offset + at;
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = piece.level;
+			region.imageSubresource.baseArrayLayer = 0;
+			region.imageSubresource.layerCount = 1;
+			region.imageOffset = {0, static_cast<int32_t>(piece.y), 0};
+			region.imageExtent = {piece.width, piece.height, 1};
+			regions.push_back(region);
+			at += piece.size;
+		}
+
+		vkCmdCopyBufferToImage(cmd_buffer,
+							   staging.buffer,
+							   img,
+							   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+							   static_cast<uint32_t>(regions.size()),
+							   regions.data());
+
+		first = last;
+		if (first == pieces.size() && to_shader_read)
+		{
+			release_img_to_graphics(eng_data, img, level_count);
+		}
+
+		end_single_time_cmds(eng_data, cmd_buffer);
+	}
+}
+
+void liboceanlight::engine::begin_upload_batch(engine_data& eng_data)
+{
+	if (eng_data.upload_depth++ == 0)
+	{
+		eng_data.upload_cmd =
+			allocate_upload_cmds(eng_data, eng_data.command_pool);
+	}
+}
+
+upload_ticket liboceanlight::engine::end_upload_batch(engine_data& eng_data)
+{
+	if (--eng_data.upload_depth > 0)
+	{
+		/* Whenever it is submitted, this is the serial it gets */
+		return eng_data.upload_serial + 1;
+	}
+
+	return submit_upload_cmds(eng_data);
+}
+
+void liboceanlight::engine::flush_upload_batch(engine_data& eng_data)
+{
+	if (eng_data.upload_cmd)
+	{
+		submit_upload_cmds(eng_data);
+		eng_data.upload_cmd =
+			allocate_upload_cmds(eng_data, eng_data.command_pool);
+	}
+}
+
+void liboceanlight::engine::wait_upload(engine_data& eng_data,
+										upload_ticket ticket)
+{
+	if (ticket > eng_data.upload_serial)
+	{
+		flush_upload_batch(eng_data);
+	}
+
+	const auto& pending {eng_data.pending_uploads};
+	if (pending.empty() || pending.front().serial > ticket)
+	{
+		return;
+	}
+
+	ticket = std::min(ticket, eng_data.upload_serial);
+	VkSemaphoreWaitInfo wait_info {};
+	wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	wait_info.semaphoreCount = 1;
+	wait_info.pSemaphores = &eng_data.upload_timeline;
+	wait_info.pValues = &ticket;
+	vkWaitSemaphores(eng_data.logical_device, &wait_info, UINT64_MAX);
+	retire_uploads(eng_data);
+}
+
+bool liboceanlight::engine::upload_finished(engine_data& eng_data,
+											upload_ticket ticket)
+{
+	retire_uploads(eng_data);
+	const auto& pending {eng_data.pending_uploads};
+	return ticket <= eng_data.upload_serial &&
+		   (pending.empty() || pending.front().serial > ticket);
+}
+
+void liboceanlight::engine::retire_uploads(engine_data& eng_data)
+{
+	auto& pending {eng_data.pending_uploads};
+	const uint64_t finished {uploads_finished(eng_data)};
+	while (!pending.empty() && pending.front().serial <= finished)
+	{
+		retire_upload(eng_data, pending.front());
+		pending.pop_front();
+	}
+}
+
+void liboceanlight::engine::destroy_buffer_after_upload(
+	engine_data& eng_data,
+	VkBuffer& buff,
+	liboceanlight::device_allocation& buff_mem)
+{
+	if (!eng_data.upload_cmd)
+	{
+		destroy_buffer(eng_data, buff, buff_mem);
+		return;
+	}
+
+	eng_data.upload_garbage.emplace_back(buff, buff_mem);
+	buff = nullptr;
+	buff_mem = {};
+}
+
+void liboceanlight::engine::create_upload_timelines(engine_data& eng_data)
+{
+	VkSemaphoreTypeCreateInfo type_info {};
+	type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	type_info.initialValue = 0;
+
+	VkSemaphoreCreateInfo sem_info {};
+	sem_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	sem_info.pNext = &type_info;
+
+	for (auto* sem : {&eng_data.transfer_timeline, &eng_data.upload_timeline})
+	{
+		VkResult rv {vkCreateSemaphore(
+			eng_data.logical_device, &sem_info, nullptr, sem)};
+		if (rv != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create timeline semaphore");
+		}
+	}
+}
+
+VkCommandBuffer liboceanlight::engine::begin_transfer_cmds(
+	engine_data& eng_data)
+{
+	begin_upload_batch(eng_data);
+	if (!use_transfer_queue(eng_data))
+	{
+		return eng_data.upload_cmd;
+	}
+
+	if (!eng_data.transfer_cmd)
+	{
+		eng_data.transfer_cmd =
+			allocate_upload_cmds(eng_data, eng_data.transfer_cmd_pool);
+	}
+
+	return eng_data.transfer_cmd;
+}
+
+void liboceanlight::engine::release_buffer_to_graphics(engine_data& eng_data,
+													   VkBuffer buff,
+													   VkDeviceSize offset,
+													   VkDeviceSize size)
+{
+	/* On one queue the barrier ending the batch covers it */
+	if (!use_transfer_queue(eng_data))
+	{
+		return;
+	}
+
+	VkBufferMemoryBarrier barrier {};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = eng_data.transfer_queue_index;
+	barrier.dstQueueFamilyIndex = eng_data.graphics_queue_index;
+	barrier.buffer = buff;
+	barrier.offset = offset;
+	barrier.size = size;
+
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	vkCmdPipelineBarrier(eng_data.transfer_cmd,
+						 VK_PIPELINE_STAGE_TRANSFER_BIT,
+						 VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+						 0,
+						 0,
+						 nullptr,
+						 1,
+						 &barrier,
+						 0,
+						 nullptr);
+
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+							VK_ACCESS_INDEX_READ_BIT |
+							VK_ACCESS_UNIFORM_READ_BIT |
+							VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(eng_data.upload_cmd,
+						 VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+						 VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+							 VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+							 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+						 0,
+						 0,
+						 nullptr,
+						 1,
+						 &barrier,
+						 0,
+						 nullptr);
+}
+
+void liboceanlight::engine::release_img_to_graphics(engine_data& eng_data,
+													VkImage img,
+													uint32_t level_count)
+{
+	if (!use_transfer_queue(eng_data))
+	{
+		record_img_barrier(eng_data.upload_cmd,
+						   img,
+						   VK_FORMAT_UNDEFINED,
+						   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+						   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+						   0,
+						   level_count);
+		return;
+	}
+
+	/* Both halves make the same layout transition */
+	VkImageMemoryBarrier barrier {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.srcQueueFamilyIndex = eng_data.transfer_queue_index;
+	barrier.dstQueueFamilyIndex = eng_data.graphics_queue_index;
+	barrier.image = img;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = level_count;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	vkCmdPipelineBarrier(eng_data.transfer_cmd,
+						 VK_PIPELINE_STAGE_TRANSFER_BIT,
+						 VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+						 0,
+						 0,
+						 nullptr,
+						 0,
+						 nullptr,
+						 1,
+						 &barrier);
+
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(eng_data.upload_cmd,
+						 VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+						 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+						 0,
+						 0,
+						 nullptr,
+						 0,
+						 nullptr,
+						 1,
+						 &barrier);
 }
 
 void liboceanlight::engine::get_swapchain_details(
@@ -403,7 +1369,8 @@ void liboceanlight::engine::create_image_views(engine_data& eng_data)
 			eng_data,
 			eng_data.images[i],
 			eng_data.surface_format.format,
-			VK_IMAGE_ASPECT_COLOR_BIT);
+			VK_IMAGE_ASPECT_COLOR_BIT,
+			1);
 	}
 }
 
@@ -411,7 +1378,8 @@ VkImageView liboceanlight::engine::create_image_view(
 	engine_data& eng_data,
 	VkImage img,
 	VkFormat fmt,
-	VkImageAspectFlags aspect_flags)
+	VkImageAspectFlags aspect_flags,
+	uint32_t mip_levels)
 {
 	VkImageViewCreateInfo c_info {};
 	c_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -424,7 +1392,7 @@ VkImageView liboceanlight::engine::create_image_view(
 	c_info.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
 	c_info.subresourceRange.aspectMask = aspect_flags;
 	c_info.subresourceRange.baseMipLevel = 0;
-	c_info.subresourceRange.levelCount = 1;
+	c_info.subresourceRange.levelCount = mip_levels;
 	c_info.subresourceRange.baseArrayLayer = 0;
 	c_info.subresourceRange.layerCount = 1;
 
@@ -522,17 +1490,45 @@ void liboceanlight::engine::create_descriptor_set_layout(engine_data& eng_data)
 	ubo_layout_binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 	ubo_layout_binding.pImmutableSamplers = nullptr;
 
+	/* Every texture, indexed by the material of the draw */
 	VkDescriptorSetLayoutBinding sampler_layout_binding {};
 	sampler_layout_binding.binding = 1;
-	sampler_layout_binding.descriptorCount = 1;
+	sampler_layout_binding.descriptorCount = eng_data.max_textures;
 	sampler_layout_binding.descriptorType =
 		VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	sampler_layout_binding.pImmutableSamplers = nullptr;
 	sampler_layout_binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
-	std::array bindings {ubo_layout_binding, sampler_layout_binding};
+	VkDescriptorSetLayoutBinding material_layout_binding {};
+	material_layout_binding.binding = 2;
+	material_layout_binding.descriptorCount = 1;
+	material_layout_binding.descriptorType =
+		VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	material_layout_binding.pImmutableSamplers = nullptr;
+	material_layout_binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+	/* Slots past the loaded textures are never written, and new ones are
+	 * written while earlier frames still sample the others */
+	std::array<VkDescriptorBindingFlags, 3> binding_flags {
+		0,
+		VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+			VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+			VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT,
+		0};
+	VkDescriptorSetLayoutBindingFlagsCreateInfo flags_info {};
+	flags_info.sType =
+		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+	flags_info.bindingCount = static_cast<uint32_t>(binding_flags.size());
+	flags_info.pBindingFlags = binding_flags.data();
+
+	std::array bindings {ubo_layout_binding,
+						 sampler_layout_binding,
+						 material_layout_binding};
 	VkDescriptorSetLayoutCreateInfo layout_info {};
 	layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layout_info.pNext = &flags_info;
+	layout_info.flags =
+		VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
 	layout_info.bindingCount = static_cast<uint32_t>(bindings.size());
 	layout_info.pBindings = bindings.data();
 
@@ -549,36 +1545,45 @@ void liboceanlight::engine::create_descriptor_set_layout(engine_data& eng_data)
 
 void liboceanlight::engine::create_pipeline(engine_data& eng_data)
 {
-	auto vs_code = read_file(SHADER_PATH "vertex_shader.spv");
 	auto fs_code = read_file(SHADER_PATH "fragment_shader.spv");
-
-	VkShaderModule vs = create_shader(eng_data, vs_code);
 	VkShaderModule fs = create_shader(eng_data, fs_code);
 
-	VkPipelineShaderStageCreateInfo vs_info {};
-	vs_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-	vs_info.stage = VK_SHADER_STAGE_VERTEX_BIT;
-	vs_info.module = vs;
-	vs_info.pName = "main";
-
 	VkPipelineShaderStageCreateInfo fs_info {};
 	fs_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 	fs_info.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
 	fs_info.module = fs;
 	fs_info.pName = "main";
 
-	std::array shader_stages {vs_info, fs_info};
-	auto binding_desc = vertex::get_binding_desc();
-	auto attribute_descs = vertex::get_attribute_descs();
-
-	VkPipelineVertexInputStateCreateInfo vertex_input_info {};
-	vertex_input_info.sType =
-		VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertex_input_info.vertexBindingDescriptionCount = 1;
-	vertex_input_info.pVertexBindingDescriptions = &binding_desc;
-	vertex_input_info.vertexAttributeDescriptionCount = static_cast<uint32_t>(
-		attribute_descs.size());
-	vertex_input_info.pVertexAttributeDescriptions = attribute_descs.data();
+	/* One pipeline per vertex_format, in enum order */
+	std::array<VkShaderModule, vertex_format_count> vs_modules {
+		create_shader(eng_data,
+					  read_file(std::string {SHADER_PATH} + vertex::shader)),
+		create_shader(eng_data,
+					  read_file(std::string {SHADER_PATH} +
+								packed_vertex::shader))};
+
+	std::array<std::array<VkPipelineShaderStageCreateInfo, 2>,
+			   vertex_format_count>
+		shader_stages {};
+	for (size_t i {0}; i < vertex_format_count; ++i)
+	{
+		VkPipelineShaderStageCreateInfo vs_info {};
+		vs_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		vs_info.stage = VK_SHADER_STAGE_VERTEX_BIT;
+		vs_info.module = gsl::at(vs_modules, i);
+		vs_info.pName = "main";
+		gsl::at(shader_stages, i) = {vs_info, fs_info};
+	}
+
+	const auto full_binding_desc = vertex::get_binding_desc();
+	const auto full_attribute_descs = vertex::get_attribute_descs();
+	const auto packed_binding_desc = packed_vertex::get_binding_desc();
+	const auto packed_attribute_descs = packed_vertex::get_attribute_descs();
+
+	std::array vertex_input_infos {
+		make_vertex_input_info(full_binding_desc, full_attribute_descs),
+		make_vertex_input_info(packed_binding_desc, packed_attribute_descs)};
+	static_assert(vertex_input_infos.size() == vertex_format_count);
 
 	VkPipelineInputAssemblyStateCreateInfo input_assembly_info {};
 	input_assembly_info.sType =
@@ -675,8 +1680,19 @@ void liboceanlight::engine::create_pipeline(engine_data& eng_data)
 	pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 	pipeline_layout_info.setLayoutCount = 1;
 	pipeline_layout_info.pSetLayouts = &eng_data.descriptor_set_layout;
-	pipeline_layout_info.pushConstantRangeCount = 0;
-	pipeline_layout_info.pPushConstantRanges = nullptr;
+	/* The quantization for the vertex shader, then the material index
+	 * for the fragment shader */
+	std::array<VkPushConstantRange, 2> push_constant_ranges {};
+	push_constant_ranges[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	push_constant_ranges[0].offset = 0;
+	push_constant_ranges[0].size = sizeof(vertex_quantization);
+	push_constant_ranges[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	push_constant_ranges[1].offset = sizeof(vertex_quantization);
+	push_constant_ranges[1].size = sizeof(uint32_t);
+
+	pipeline_layout_info.pushConstantRangeCount = static_cast<uint32_t>(
+		push_constant_ranges.size());
+	pipeline_layout_info.pPushConstantRanges = push_constant_ranges.data();
 
 	auto rv = vkCreatePipelineLayout(eng_data.logical_device,
 									 &pipeline_layout_info,
@@ -691,8 +1707,6 @@ void liboceanlight::engine::create_pipeline(engine_data& eng_data)
 	VkGraphicsPipelineCreateInfo pipeline_info {};
 	pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
 	pipeline_info.stageCount = 2;
-	pipeline_info.pStages = shader_stages.data();
-	pipeline_info.pVertexInputState = &vertex_input_info;
 	pipeline_info.pInputAssemblyState = &input_assembly_info;
 	pipeline_info.pViewportState = &viewport_info;
 	pipeline_info.pRasterizationState = &rasterizer_info;
@@ -706,19 +1720,33 @@ void liboceanlight::engine::create_pipeline(engine_data& eng_data)
 	pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
 	pipeline_info.basePipelineIndex = -1;
 
+	std::array<VkGraphicsPipelineCreateInfo, vertex_format_count>
+		pipeline_infos {};
+	for (size_t i {0}; i < vertex_format_count; ++i)
+	{
+		gsl::at(pipeline_infos, i) = pipeline_info;
+		gsl::at(pipeline_infos, i).pStages = gsl::at(shader_stages, i).data();
+		gsl::at(pipeline_infos, i).pVertexInputState = &gsl::at(
+			vertex_input_infos, i);
+	}
+
 	rv = vkCreateGraphicsPipelines(eng_data.logical_device,
 								   VK_NULL_HANDLE,
-								   1,
-								   &pipeline_info,
+								   static_cast<uint32_t>(
+									   pipeline_infos.size()),
+								   pipeline_infos.data(),
 								   nullptr,
-								   &eng_data.graphics_pipeline);
+								   eng_data.graphics_pipelines.data());
 
 	if (rv != VK_SUCCESS)
 	{
 		throw std::runtime_error("Failed to create graphics pipeline");
 	}
 
-	vkDestroyShaderModule(eng_data.logical_device, vs, nullptr);
+	for (auto vs : vs_modules)
+	{
+		vkDestroyShaderModule(eng_data.logical_device, vs, nullptr);
+	}
 	vkDestroyShaderModule(eng_data.logical_device, fs, nullptr);
 }
 
@@ -770,6 +1798,19 @@ void liboceanlight::engine::create_cmd_pool(engine_data& eng_data)
 	{
 		throw std::runtime_error("Failed to create command pool");
 	}
+
+	if (use_transfer_queue(eng_data))
+	{
+		c_info.queueFamilyIndex = eng_data.transfer_queue_index;
+		rv = vkCreateCommandPool(eng_data.logical_device,
+								 &c_info,
+								 nullptr,
+								 &eng_data.transfer_cmd_pool);
+		if (rv != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create command pool");
+		}
+	}
 }
 
 void liboceanlight::engine::create_depth_resources(engine_data& eng_data)
@@ -777,103 +1818,193 @@ void liboceanlight::engine::create_depth_resources(engine_data& eng_data)
 	create_image(eng_data,
 				 eng_data.swap_extent.width,
 				 eng_data.swap_extent.height,
+				 1,
 				 eng_data.depth_fmt,
 				 VK_IMAGE_TILING_OPTIMAL,
 				 VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
 				 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 				 eng_data.depth_img,
-				 eng_data.depth_img_mem);
+				 eng_data.depth_img_mem,
+				 memory_category::attachments);
 
 	eng_data.depth_img_view = create_image_view(eng_data,
 												eng_data.depth_img,
 												eng_data.depth_fmt,
-												VK_IMAGE_ASPECT_DEPTH_BIT);
+												VK_IMAGE_ASPECT_DEPTH_BIT,
+												1);
 
 	transition_img_layout(eng_data,
 						  eng_data.depth_img,
 						  eng_data.depth_fmt,
 						  VK_IMAGE_LAYOUT_UNDEFINED,
-						  VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+						  VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+						  1);
 }
 
-void liboceanlight::engine::create_texture_img(engine_data& eng_data)
+void liboceanlight::engine::create_texture_img(engine_data& eng_data,
+											   texture& tex)
 {
-	int width {}, height {}, channels {}, bytes_per_pixel {STBI_rgb_alpha};
-	const char* path {TEXTURE_PATH "viking_room.png"};
+	if (use_compressed_textures(eng_data))
+	{
+		const auto cooked {textures::cook_texture(
+			tex.path, textures::texture_kind::color, eng_data.workers.get())};
+		create_texture_img_from_mips(
+			eng_data, tex, cooked.chain, cooked.format);
+		return;
+	}
+
+	int width {}, height {}, channels {};
+	const char* path {tex.path.c_str()};
 
 	stbi_uc* pixels {nullptr};
-	pixels = stbi_load(path, &width, &height, &channels, bytes_per_pixel);
+	pixels = stbi_load(path, &width, &height, &channels, STBI_rgb_alpha);
 
 	if (!pixels)
 	{
 		throw std::runtime_error("Failed to load texture image");
 	}
 
-	VkDeviceSize img_size {
-		static_cast<VkDeviceSize>(width * height * bytes_per_pixel)};
-	VkBuffer staging_buff {nullptr};
-	VkDeviceMemory staging_buff_mem {nullptr};
-
-	create_buffer(eng_data,
-				  img_size,
-				  VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-				  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-					  VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-				  staging_buff,
-				  staging_buff_mem);
-
-	void* data {nullptr};
-	vkMapMemory(eng_data.logical_device,
-				staging_buff_mem,
-				0,
-				img_size,
-				0,
-				&data);
-	memcpy(data, pixels, static_cast<size_t>(img_size));
-	vkUnmapMemory(eng_data.logical_device, staging_buff_mem);
+	create_texture_img_from_pixels(eng_data,
+								   tex,
+								   pixels,
+								   static_cast<uint32_t>(width),
+								   static_cast<uint32_t>(height));
 	stbi_image_free(pixels);
+}
+
+bool liboceanlight::engine::use_compressed_textures(engine_data& eng_data)
+{
+	return eng_data.texture_compression_enabled &&
+		   eng_data.texture_bc_supported;
+}
+
+void liboceanlight::engine::create_texture_img_from_pixels(
+	engine_data& eng_data,
+	texture& tex,
+	const void* pixels,
+	uint32_t width,
+	uint32_t height)
+{
+	if (!use_gpu_mipmaps(eng_data))
+	{
+		const auto* bytes {static_cast<const uint8_t*>(pixels)};
+		const auto chain {textures::build_mip_chain(
+			{bytes, size_t {width} * height * 4},
+			width,
+			height,
+			true,
+			eng_data.workers.get())};
+		create_texture_img_from_mips(
+			eng_data, tex, chain, VK_FORMAT_R8G8B8A8_SRGB);
+		return;
+	}
 
+	const uint32_t mip_levels {textures::mip_level_count(width, height)};
+
+	/* Each level is blitted from the one above it */
 	create_image(eng_data,
 				 width,
 				 height,
+				 mip_levels,
 				 VK_FORMAT_R8G8B8A8_SRGB,
 				 VK_IMAGE_TILING_OPTIMAL,
-				 VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+				 VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+					 VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+					 VK_IMAGE_USAGE_SAMPLED_BIT,
 				 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-				 eng_data.texture_img,
-				 eng_data.texture_img_mem);
+				 tex.img,
+				 tex.img_mem,
+				 memory_category::textures);
+	tex.mip_levels = mip_levels;
+	tex.format = VK_FORMAT_R8G8B8A8_SRGB;
+
+	const std::array<textures::mip_level, 1> level {{{0, width, height}}};
+	stage_img_upload(eng_data,
+					 tex.img,
+					 VK_FORMAT_R8G8B8A8_SRGB,
+					 level,
+					 {static_cast<const uint8_t*>(pixels),
+					  size_t {width} * height * 4},
+					 mip_levels,
+					 false);
+
+	generate_mipmaps(eng_data, tex.img, width, height, mip_levels);
+}
 
-	transition_img_layout(eng_data,
-						  eng_data.texture_img,
-						  VK_FORMAT_R8G8B8A8_SRGB,
-						  VK_IMAGE_LAYOUT_UNDEFINED,
-						  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+void liboceanlight::engine::create_texture_img_from_mips(
+	engine_data& eng_data,
+	texture& tex,
+	const textures::mip_chain& chain,
+	VkFormat fmt)
+{
+	if (!eng_data.texture_residency_enabled)
+	{
+		upload_texture_levels(eng_data, tex, chain, fmt, 0);
+		return;
+	}
 
-	copy_buffer_to_img(eng_data,
-					   staging_buff,
-					   eng_data.texture_img,
-					   static_cast<uint32_t>(width),
-					   static_cast<uint32_t>(height));
+	auto source {std::make_shared<const textures::mip_chain>(chain)};
+	upload_texture_levels(
+		eng_data,
+		tex,
+		*source,
+		fmt,
+		textures::first_level_within(source->levels,
+									 eng_data.texture_initial_size));
+	tex.source = std::move(source);
+}
 
-	transition_img_layout(eng_data,
-						  eng_data.texture_img,
-						  VK_FORMAT_R8G8B8A8_SRGB,
-						  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-						  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+void liboceanlight::engine::upload_texture_levels(
+	engine_data& eng_data,
+	texture& tex,
+	const textures::mip_chain& chain,
+	VkFormat fmt,
+	uint32_t base_level)
+{
+	const std::span levels {std::span {chain.levels}.subspan(base_level)};
+	const auto mip_levels {static_cast<uint32_t>(levels.size())};
+	create_image(eng_data,
+				 levels.front().width,
+				 levels.front().height,
+				 mip_levels,
+				 fmt,
+				 VK_IMAGE_TILING_OPTIMAL,
+				 VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+				 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				 tex.img,
+				 tex.img_mem,
+				 memory_category::textures);
+	tex.mip_levels = mip_levels;
+	tex.format = fmt;
+	tex.base_level = base_level;
+
+	/* Offsets stay relative to the whole chain */
+	stage_img_upload(eng_data,
+					 tex.img,
+					 fmt,
+					 levels,
+					 chain.pixels,
+					 mip_levels,
+					 true);
+}
 
-	vkDestroyBuffer(eng_data.logical_device, staging_buff, nullptr);
-	vkFreeMemory(eng_data.logical_device, staging_buff_mem, nullptr);
+bool liboceanlight::engine::use_gpu_mipmaps(engine_data& eng_data)
+{
+	return eng_data.texture_blit_mips && !eng_data.texture_residency_enabled;
 }
 
-void liboceanlight::engine::create_image(engine_data& eng_data,
-										 uint32_t width,
-										 uint32_t height,
-										 VkFormat fmt,
-										 VkImageTiling tiling,
-										 VkImageUsageFlags usage,
-										 VkMemoryPropertyFlags props,
-										 VkImage& image,
-										 VkDeviceMemory& image_mem)
+void liboceanlight::engine::create_image(
+	engine_data& eng_data,
+	uint32_t width,
+	uint32_t height,
+	uint32_t mip_levels,
+	VkFormat fmt,
+	VkImageTiling tiling,
+	VkImageUsageFlags usage,
+	VkMemoryPropertyFlags props,
+	VkImage& image,
+	liboceanlight::device_allocation& image_mem,
+	memory_category category)
 {
 	VkImageCreateInfo image_info {};
 	image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -881,7 +2012,7 @@ void liboceanlight::engine::create_image(engine_data& eng_data,
 	image_info.extent.width = static_cast<uint32_t>(width);
 	image_info.extent.height = static_cast<uint32_t>(height);
 	image_info.extent.depth = 1;
-	image_info.mipLevels = 1;
+	image_info.mipLevels = mip_levels;
 	image_info.arrayLayers = 1;
 	image_info.format = fmt;
 	image_info.tiling = tiling;
@@ -901,65 +2032,36 @@ void liboceanlight::engine::create_image(engine_data& eng_data,
 
 	VkMemoryRequirements mem_reqs {};
 	vkGetImageMemoryRequirements(eng_data.logical_device, image, &mem_reqs);
-
-	VkMemoryAllocateInfo alloc_info {};
-	alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	alloc_info.allocationSize = mem_reqs.size;
-	alloc_info.memoryTypeIndex = find_mem_type(eng_data,
-											   mem_reqs.memoryTypeBits,
-											   props);
-
-	rv = vkAllocateMemory(eng_data.logical_device,
-						  &alloc_info,
-						  nullptr,
-						  &image_mem);
-
-	if (rv != VK_SUCCESS)
-	{
-		throw std::runtime_error("Failed to allocate image memory");
-	}
-
-	vkBindImageMemory(eng_data.logical_device, image, image_mem, 0);
+	image_mem = eng_data.allocator->allocate(
+		mem_reqs,
+		props,
+		tiling == VK_IMAGE_TILING_OPTIMAL ? memory_usage::image
+										  : memory_usage::buffer,
+		category);
+	vkBindImageMemory(eng_data.logical_device,
+					  image,
+					  image_mem.memory,
+					  image_mem.offset);
 }
 
 VkCommandBuffer liboceanlight::engine::begin_single_time_cmds(
 	engine_data& eng_data)
 {
-	VkCommandBufferAllocateInfo alloc_info {};
-	alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	alloc_info.commandPool = eng_data.command_pool;
-	alloc_info.commandBufferCount = 1;
-
-	VkCommandBuffer cmd_buffer {};
-	vkAllocateCommandBuffers(eng_data.logical_device,
-							 &alloc_info,
-							 &cmd_buffer);
-
-	VkCommandBufferBeginInfo begin_info {};
-	begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-	begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-	vkBeginCommandBuffer(cmd_buffer, &begin_info);
-	return cmd_buffer;
+	begin_upload_batch(eng_data);
+	return eng_data.upload_cmd;
 }
 
 void liboceanlight::engine::end_single_time_cmds(engine_data& eng_data,
 												 VkCommandBuffer& cmd_buffer)
 {
-	vkEndCommandBuffer(cmd_buffer);
-
-	VkSubmitInfo submit_info {};
-	submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-	submit_info.commandBufferCount = 1;
-	submit_info.pCommandBuffers = &cmd_buffer;
+	/* Within a batch the commands go out with the rest of it */
+	const upload_ticket ticket {end_upload_batch(eng_data)};
+	if (eng_data.upload_depth == 0)
+	{
+		wait_upload(eng_data, ticket);
+	}
 
-	vkQueueSubmit(eng_data.graphics_queue, 1, &submit_info, VK_NULL_HANDLE);
-	vkQueueWaitIdle(eng_data.graphics_queue);
-	vkFreeCommandBuffers(eng_data.logical_device,
-						 eng_data.command_pool,
-						 1,
-						 &cmd_buffer);
+	cmd_buffer = nullptr;
 }
 
 bool has_stencil_component(VkFormat format)
@@ -972,9 +2074,23 @@ void liboceanlight::engine::transition_img_layout(engine_data& eng_data,
 												  VkImage img,
 												  VkFormat fmt,
 												  VkImageLayout old_layout,
-												  VkImageLayout new_layout)
+												  VkImageLayout new_layout,
+												  uint32_t mip_levels)
 {
 	VkCommandBuffer cmd_buffer {begin_single_time_cmds(eng_data)};
+	record_img_barrier(
+		cmd_buffer, img, fmt, old_layout, new_layout, 0, mip_levels);
+	end_single_time_cmds(eng_data, cmd_buffer);
+}
+
+void liboceanlight::engine::record_img_barrier(VkCommandBuffer cmd_buffer,
+											   VkImage img,
+											   VkFormat fmt,
+											   VkImageLayout old_layout,
+											   VkImageLayout new_layout,
+											   uint32_t base_level,
+											   uint32_t level_count)
+{
 	VkImageMemoryBarrier barrier {};
 	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
 	barrier.oldLayout = old_layout;
@@ -983,8 +2099,8 @@ void liboceanlight::engine::transition_img_layout(engine_data& eng_data,
 	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 	barrier.image = img;
 	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	barrier.subresourceRange.baseMipLevel = 0;
-	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.baseMipLevel = base_level;
+	barrier.subresourceRange.levelCount = level_count;
 	barrier.subresourceRange.baseArrayLayer = 0;
 	barrier.subresourceRange.layerCount = 1;
 	barrier.srcAccessMask = 0;
@@ -1007,6 +2123,22 @@ void liboceanlight::engine::transition_img_layout(engine_data& eng_data,
 		src_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
 		dst_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
 	}
+	else if (old_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL &&
+			 new_layout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
+	{
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		src_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		dst_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	}
+	else if (old_layout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL &&
+			 new_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+	{
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		src_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		dst_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	}
 	else if (old_layout == VK_IMAGE_LAYOUT_UNDEFINED &&
 			 new_layout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
 	{
@@ -1045,42 +2177,127 @@ void liboceanlight::engine::transition_img_layout(engine_data& eng_data,
 						 nullptr,
 						 1,
 						 &barrier);
+}
 
+void liboceanlight::engine::generate_mipmaps(engine_data& eng_data,
+											 VkImage img,
+											 uint32_t width,
+											 uint32_t height,
+											 uint32_t mip_levels)
+{
+	VkCommandBuffer cmd_buffer {begin_single_time_cmds(eng_data)};
+	record_mipmaps(cmd_buffer, img, width, height, mip_levels);
 	end_single_time_cmds(eng_data, cmd_buffer);
 }
 
-void liboceanlight::engine::copy_buffer_to_img(engine_data& eng_data,
-											   VkBuffer buff,
-											   VkImage img,
-											   uint32_t width,
-											   uint32_t height)
+void liboceanlight::engine::record_mipmaps(VkCommandBuffer cmd_buffer,
+										   VkImage img,
+										   uint32_t width,
+										   uint32_t height,
+										   uint32_t mip_levels)
 {
-	VkCommandBuffer cmd_buffer {begin_single_time_cmds(eng_data)};
-	VkBufferImageCopy region {};
-	region.bufferOffset = 0;
-	region.bufferRowLength = 0;
-	region.bufferImageHeight = 0;
-	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	region.imageSubresource.mipLevel = 0;
-	region.imageSubresource.baseArrayLayer = 0;
-	region.imageSubresource.layerCount = 1;
-	region.imageOffset = {0, 0, 0};
-	region.imageExtent = {width, height, 1};
+	/* Expects every level in TRANSFER_DST with level 0 filled, leaves
+	 * them all SHADER_READ_ONLY */
+	auto level_width {static_cast<int32_t>(width)};
+	auto level_height {static_cast<int32_t>(height)};
+
+	for (uint32_t i {1}; i < mip_levels; ++i)
+	{
+		record_img_barrier(cmd_buffer,
+						   img,
+						   VK_FORMAT_R8G8B8A8_SRGB,
+						   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+						   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+						   i - 1,
+						   1);
+
+		const int32_t next_width {std::max(level_width / 2, 1)};
+		const int32_t next_height {std::max(level_height / 2, 1)};
+
+		VkImageBlit blit {};
+		blit.srcOffsets[0] = {0, 0, 0};
+		blit.srcOffsets[1] = {level_width, level_height, 1};
+		blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.srcSubresource.mipLevel = i - 1;
+		blit.srcSubresource.baseArrayLayer = 0;
+		blit.srcSubresource.layerCount = 1;
+		blit.dstOffsets[0] = {0, 0, 0};
+		blit.dstOffsets[1] = {next_width, next_height, 1};
+		blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.dstSubresource.mipLevel = i;
+		blit.dstSubresource.baseArrayLayer = 0;
+		blit.dstSubresource.layerCount = 1;
+
+		vkCmdBlitImage(cmd_buffer,
+					   img,
+					   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+					   img,
+					   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+					   1,
+					   &blit,
+					   VK_FILTER_LINEAR);
+
+		record_img_barrier(cmd_buffer,
+						   img,
+						   VK_FORMAT_R8G8B8A8_SRGB,
+						   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+						   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+						   i - 1,
+						   1);
+
+		level_width = next_width;
+		level_height = next_height;
+	}
+
+	record_img_barrier(cmd_buffer,
+					   img,
+					   VK_FORMAT_R8G8B8A8_SRGB,
+					   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+					   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+					   mip_levels - 1,
+					   1);
+}
+
+void liboceanlight::engine::record_copy_mips(
+	VkCommandBuffer cmd_buffer,
+	VkBuffer buff,
+	VkDeviceSize buff_offset,
+	VkImage img,
+	std::span<const textures::mip_level> levels)
+{
+	std::vector<VkBufferImageCopy> regions;
+	for (size_t i {0}; i < levels.size(); ++i)
+	{
+		const auto& level {levels[i]};
+		VkBufferImageCopy region {};
+		region.bufferOffset = buff_offset + level.offset;
+		region.bufferRowLength = 0;
+		region.bufferImageHeight = 0;
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = static_cast<uint32_t>(i);
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = 1;
+		region.imageOffset = {0, 0, 0};
+		region.imageExtent = {level.width, level.height, 1};
+		regions.push_back(region);
+	}
+
 	vkCmdCopyBufferToImage(cmd_buffer,
 						   buff,
 						   img,
 						   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-						   1,
-						   &region);
-	end_single_time_cmds(eng_data, cmd_buffer);
+						   static_cast<uint32_t>(regions.size()),
+						   regions.data());
 }
 
-void liboceanlight::engine::create_texture_img_view(engine_data& eng_data)
+void liboceanlight::engine::create_texture_img_view(engine_data& eng_data,
+													texture& tex)
 {
-	eng_data.texture_img_view = create_image_view(eng_data,
-												  eng_data.texture_img,
-												  VK_FORMAT_R8G8B8A8_SRGB,
-												  VK_IMAGE_ASPECT_COLOR_BIT);
+	tex.img_view = create_image_view(eng_data,
+									 tex.img,
+									 tex.format,
+									 VK_IMAGE_ASPECT_COLOR_BIT,
+									 tex.mip_levels);
 }
 
 void liboceanlight::engine::create_texture_sampler(engine_data& eng_data)
@@ -1101,7 +2318,7 @@ void liboceanlight::engine::create_texture_sampler(engine_data& eng_data)
 	c_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
 	c_info.mipLodBias = 0.0f;
 	c_info.minLod = 0.0f;
-	c_info.maxLod = 0.0f;
+	c_info.maxLod = VK_LOD_CLAMP_NONE;
 
 	VkResult rv = vkCreateSampler(eng_data.logical_device,
 								  &c_info,
@@ -1114,90 +2331,495 @@ void liboceanlight::engine::create_texture_sampler(engine_data& eng_data)
 	}
 }
 
-void liboceanlight::engine::load_models(engine_data& eng_data)
+void liboceanlight::engine::create_placeholder_texture(engine_data& eng_data)
 {
-	for (const auto& file : fs::directory_iterator(MODEL_PATH))
+	const std::array<uint8_t, 4> grey {128, 128, 128, 255};
+	create_texture_img_from_pixels(
+		eng_data, eng_data.placeholder_texture, grey.data(), 1, 1);
+	create_texture_img_view(eng_data, eng_data.placeholder_texture);
+}
+
+void liboceanlight::engine::create_textures(engine_data& eng_data)
+{
+	std::vector<uint32_t> slots;
+	for (size_t slot {0}; slot < eng_data.textures.size(); ++slot)
 	{
-		eng_data.model_list.emplace_back(file.path().filename().string());
-		std::cout << "Loaded model " << file.path().filename() << "\n";
+		if (!eng_data.textures[slot].img_view)
+		{
+			slots.push_back(static_cast<uint32_t>(slot));
+		}
 	}
 
-	for (auto& model : eng_data.model_list)
+	const auto start {std::chrono::steady_clock::now()};
+	const VkDeviceSize uploaded {load_texture_batch(eng_data, slots)};
+	const std::chrono::duration<double, std::milli> elapsed {
+		std::chrono::steady_clock::now() - start};
+
+	std::cout << "Loaded " << slots.size() << " textures for "
+			  << eng_data.materials.size() << " materials, "
+			  << uploaded / 1024 << " KiB in " << elapsed.count()
+			  << " ms\n";
+}
+
+VkDeviceSize liboceanlight::engine::load_texture_batch(
+	engine_data& eng_data,
+	std::span<const uint32_t> slots)
+{
+	std::vector<textures::staged_image> images(slots.size());
+	std::vector<std::vector<uint8_t>> cooked(slots.size());
+	std::vector<VkFormat> formats(slots.size(), VK_FORMAT_R8G8B8A8_SRGB);
+	for (size_t i {0}; i < slots.size(); ++i)
 	{
-		std::string model_file {MODEL_PATH + model.name};
-		tinyobj::attrib_t attrib;
-		std::vector<tinyobj::shape_t> shapes;
-		std::vector<tinyobj::material_t> materials;
-		std::string warn, err;
+		images[i].path = eng_data.textures.at(slots[i]).path;
+	}
 
-		auto rv = tinyobj::LoadObj(&attrib,
-								   &shapes,
-								   &materials,
-								   &warn,
-								   &err,
-								   model_file.c_str());
+	if (use_compressed_textures(eng_data))
+	{
+		/* Cooking fans each texture out over the pool by itself */
+		for (size_t i {0}; i < images.size(); ++i)
+		{
+			try
+			{
+				auto texture {
+					textures::cook_texture(images[i].path,
+										   textures::texture_kind::color,
+										   eng_data.workers.get())};
+				images[i].width = texture.chain.levels.front().width;
+				images[i].height = texture.chain.levels.front().height;
+				images[i].levels = std::move(texture.chain.levels);
+				images[i].size = texture.chain.pixels.size();
+				cooked[i] = std::move(texture.chain.pixels);
+				formats[i] = texture.format;
+			}
+			catch (const std::exception& e)
+			{
+				std::cerr << "Loading " << images[i].path << " failed, "
+						  << "keeping the placeholder texture: " << e.what()
+						  << "\n";
+			}
+		}
+	}
+	else
+	{
+		textures::read_image_headers(
+			images, !use_gpu_mipmaps(eng_data), eng_data.workers.get());
+	}
 
-		if (!rv)
+	/* Groups of about texture_batch_bytes, so hundreds of textures do
+	 * not need one staging buffer holding all of them */
+	VkDeviceSize uploaded {0};
+	size_t first {0};
+	while (first < images.size())
+	{
+		size_t last {first}, group_bytes {0};
+		while (last < images.size() &&
+			   (last == first || group_bytes + images[last].size <=
+									 eng_data.texture_batch_bytes))
 		{
-			throw std::runtime_error("Failed to load model " + model_file +
-									 "\n" + warn + err);
+			group_bytes += images[last].size;
+			++last;
 		}
 
-		std::unordered_map<vertex, uint32_t> unique_vertices {};
+		const size_t count {last - first};
+		uploaded += upload_texture_group(
+			eng_data,
+			slots.subspan(first, count),
+			std::span {images}.subspan(first, count),
+			std::span<const std::vector<uint8_t>> {cooked}.subspan(first,
+																	count),
+			std::span<const VkFormat> {formats}.subspan(first, count));
+		first = last;
+	}
 
-		for (const auto& shape : shapes)
-		{
-			for (const auto& index : shape.mesh.indices)
-			{
-				vertex vertex {};
+	return uploaded;
+}
 
-				vertex.pos = {attrib.vertices[3 * index.vertex_index + 0],
-							  attrib.vertices[3 * index.vertex_index + 1],
-							  attrib.vertices[3 * index.vertex_index + 2]};
+void liboceanlight::engine::destroy_texture(engine_data& eng_data,
+											texture& tex)
+{
+	vkDestroyImageView(eng_data.logical_device, tex.img_view, nullptr);
+	vkDestroyImage(eng_data.logical_device, tex.img, nullptr);
+	eng_data.allocator->free(tex.img_mem);
+	tex.img_view = nullptr;
+	tex.img = nullptr;
+}
 
-				vertex.texcoord = {
-					attrib.texcoords[2 * index.texcoord_index + 0],
-					1.0f - attrib.texcoords[2 * index.texcoord_index + 1]};
+void liboceanlight::engine::create_material_buffer(engine_data& eng_data)
+{
+	/* Written in place: new materials go past the ones frames in flight
+	 * read, and changed ones are only written between fences */
+	const VkDeviceSize buff_size {sizeof(material) * eng_data.max_materials};
+	create_buffer(eng_data,
+				  buff_size,
+				  VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				  host_write_mem_props(eng_data),
+				  eng_data.material_buffer,
+				  eng_data.material_buffer_mem,
+				  memory_category::uniforms);
+	eng_data.material_buffer_mapped = eng_data.material_buffer_mem.mapped;
+}
 
-				vertex.color = {1.0f, 1.0f, 1.0f};
+std::string liboceanlight::engine::find_model_texture(
+	engine_data& eng_data,
+	const std::string& model_name)
+{
+	const std::string path {std::string {TEXTURE_PATH} +
+							fs::path(model_name).stem().string() + ".png"};
+	return fs::exists(path) ? path : eng_data.texture_path;
+}
 
-				if (unique_vertices.count(vertex) == 0)
-				{
-					unique_vertices[vertex] = static_cast<uint32_t>(
-						model.vertices.size());
-					model.vertices.push_back(vertex);
-				}
+uint32_t liboceanlight::engine::find_texture(engine_data& eng_data,
+											 const std::string& path)
+{
+	auto& list {eng_data.textures};
+	auto found {std::find_if(list.begin(), list.end(), [&](const auto& t) {
+		return t.path == path;
+	})};
 
-				model.indices.push_back(unique_vertices[vertex]);
-			}
-		}
+	if (found != list.end())
+	{
+		return static_cast<uint32_t>(found - list.begin());
+	}
+
+	if (list.size() >= eng_data.max_textures)
+	{
+		throw std::runtime_error("Too many textures for the texture array");
+	}
+
+	list.push_back({.path = path});
+	const auto slot {static_cast<uint32_t>(list.size() - 1)};
+	if (eng_data.descriptor_pool)
+	{
+		write_texture_descriptor(eng_data, slot);
+	}
+
+	return slot;
+}
+
+uint32_t liboceanlight::engine::find_material(engine_data& eng_data,
+											  const std::string& path)
+{
+	const uint32_t slot {find_texture(eng_data, path)};
+	auto& list {eng_data.materials};
+	auto found {std::find_if(list.begin(), list.end(), [&](const auto& m) {
+		return m.texture_index == slot;
+	})};
+
+	if (found != list.end())
+	{
+		return static_cast<uint32_t>(found - list.begin());
+	}
+
+	if (list.size() >= eng_data.max_materials)
+	{
+		throw std::runtime_error("Too many materials for the material buffer");
+	}
+
+	list.push_back({.texture_index = slot});
+	auto* mapped {static_cast<material*>(eng_data.material_buffer_mapped)};
+	std::memcpy(mapped + list.size() - 1, &list.back(), sizeof(material));
+	return static_cast<uint32_t>(list.size() - 1);
+}
+
+void liboceanlight::engine::assign_materials(engine_data& eng_data)
+{
+	for (auto& model : eng_data.model_list)
+	{
+		model.material_index = find_material(
+			eng_data, find_model_texture(eng_data, model.name));
+	}
+}
+
+void liboceanlight::engine::load_models(engine_data& eng_data)
+{
+	std::vector<std::string> paths;
+	for (const auto& file : models::find_model_files(MODEL_PATH))
+	{
+		paths.push_back(MODEL_PATH + file);
+	}
+
+	auto stats = models::load_model_files(paths,
+										  eng_data.model_list,
+										  get_model_load_options(eng_data));
+	models::print_load_stats(stats);
+
+	for (auto& model : eng_data.model_list)
+	{
+		prepare_model(eng_data, model);
+	}
+}
+
+liboceanlight::models::load_options liboceanlight::engine::
+	get_model_load_options(engine_data& eng_data)
+{
+	models::load_options options {};
+	options.pool = eng_data.parallel_model_loading ? eng_data.workers.get()
+												   : nullptr;
+	options.split_bytes = eng_data.model_split_bytes;
+	options.use_cache = eng_data.mesh_cache_enabled;
+	options.optimize = eng_data.mesh_optimization_enabled;
+	options.lods = eng_data.lod_enabled;
+	return options;
+}
+
+void liboceanlight::engine::prepare_model(engine_data& eng_data,
+										  models::lol_model& model)
+{
+	model.format = models::choose_vertex_format(
+		model.vertices, eng_data.preferred_vertex_format);
+	models::choose_index_type(model,
+							  eng_data.index16_enabled,
+							  eng_data.index16_max_draws);
+}
+
+void liboceanlight::engine::create_thread_pool(engine_data& eng_data)
+{
+	eng_data.workers = std::make_unique<thread_pool>(eng_data.worker_count);
+}
+
+void liboceanlight::engine::create_geometry_pools(engine_data& eng_data)
+{
+	/* Mapped, so models are copied in with no staging or transfer */
+	VkMemoryPropertyFlags props {VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT};
+	if (write_vram_directly(eng_data))
+	{
+		props |= VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+				 VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	}
+
+	/* A stride over each for the alignment padding */
+	VkDeviceSize vertex_bytes {0}, index_bytes {0};
+	for (const auto& model : eng_data.model_list)
+	{
+		const VkDeviceSize stride {vertex_stride(model.format)};
+		const VkDeviceSize size {index_size(model.index_type)};
+		vertex_bytes += stride * (model.vertices.size() + 1);
+		index_bytes += size * (model.indices.size() + 1);
+	}
+
+	const std::array pools {
+		std::tuple {&eng_data.vertex_pool,
+					std::max(eng_data.geometry_vertex_bytes, vertex_bytes),
+					VK_BUFFER_USAGE_VERTEX_BUFFER_BIT},
+		std::tuple {&eng_data.index_pool,
+					std::max(eng_data.geometry_index_bytes, index_bytes),
+					VK_BUFFER_USAGE_INDEX_BUFFER_BIT}};
+	for (auto [pool, size, usage] : pools)
+	{
+		/* Copied from as well, when grown */
+		pool->usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+					  VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage;
+		pool->props = props;
+		create_buffer(eng_data,
+					  size,
+					  pool->usage,
+					  pool->props,
+					  pool->buffer,
+					  pool->mem,
+					  memory_category::geometry);
+		pool->ranges = liboceanlight::range_allocator {size};
+	}
+}
+
+liboceanlight::models::geometry_range liboceanlight::engine::allocate_geometry(
+	engine_data& eng_data,
+	geometry_pool& pool,
+	VkDeviceSize size,
+	VkDeviceSize alignment)
+{
+	uint64_t offset {pool.ranges.allocate(size, alignment)};
+	if (offset == liboceanlight::range_allocator::npos)
+	{
+		/* Doubling keeps the copies rare as the scene keeps growing */
+		const VkDeviceSize capacity {pool.ranges.capacity()};
+		grow_geometry_pool(
+			eng_data,
+			pool,
+			std::max(capacity * 2, capacity + size + alignment));
+		offset = pool.ranges.allocate(size, alignment);
+	}
+
+	return {offset, size};
+}
+
+void liboceanlight::engine::grow_geometry_pool(engine_data& eng_data,
+											   geometry_pool& pool,
+											   VkDeviceSize capacity)
+{
+	const VkDeviceSize old_capacity {pool.ranges.capacity()};
+	VkBuffer buffer {nullptr};
+	liboceanlight::device_allocation mem {};
+	create_buffer(eng_data,
+				  capacity,
+				  pool.usage,
+				  pool.props,
+				  buffer,
+				  mem,
+				  memory_category::geometry);
+
+	/* The old buffer is freed once the batch is done with it */
+	begin_upload_batch(eng_data);
+	if (pool.mem.mapped)
+	{
+		std::memcpy(mem.mapped, pool.mem.mapped, old_capacity);
+	}
+	else
+	{
+		/* Everything staged into the old buffer has to land before the
+		 * copy reads it */
+		flush_upload_batch(eng_data);
+		wait_upload(eng_data, eng_data.upload_serial);
+
+		VkCommandBuffer cmd_buffer {begin_single_time_cmds(eng_data)};
+		VkMemoryBarrier barrier {};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		vkCmdPipelineBarrier(cmd_buffer,
+							 VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+							 VK_PIPELINE_STAGE_TRANSFER_BIT,
+							 0,
+							 1,
+							 &barrier,
+							 0,
+							 nullptr,
+							 0,
+							 nullptr);
+
+		VkBufferCopy region {};
+		region.size = old_capacity;
+		vkCmdCopyBuffer(cmd_buffer, pool.buffer, buffer, 1, &region);
+		end_single_time_cmds(eng_data, cmd_buffer);
+
+		/* Transfers into the new ranges are recorded on the other queue,
+		 * so they must not be submitted alongside the copy */
+		flush_upload_batch(eng_data);
+		wait_upload(eng_data, eng_data.upload_serial);
+	}
+
+	destroy_buffer_after_upload(eng_data, pool.buffer, pool.mem);
+	end_upload_batch(eng_data);
+
+	pool.buffer = buffer;
+	pool.mem = mem;
+	pool.ranges.grow(capacity);
+	invalidate_recorded_frames(eng_data);
+}
+
+void liboceanlight::engine::free_geometry(geometry_pool& pool,
+										  models::geometry_range& range)
+{
+	if (range.size)
+	{
+		pool.ranges.free(range.offset, range.size);
 	}
+
+	range = {};
+}
+
+void liboceanlight::engine::upload_vertices(engine_data& eng_data,
+											models::lol_model& model,
+											std::span<const std::byte> data)
+{
+	model.vertex_range = allocate_geometry(eng_data,
+										   eng_data.vertex_pool,
+										   data.size(),
+										   vertex_stride(model.format));
+	write_geometry(eng_data, eng_data.vertex_pool, model.vertex_range, data);
+}
+
+void liboceanlight::engine::upload_indices(engine_data& eng_data,
+										   models::lol_model& model,
+										   std::span<const std::byte> data)
+{
+	model.index_range = allocate_geometry(eng_data,
+										  eng_data.index_pool,
+										  data.size(),
+										  index_size(model.index_type));
+	write_geometry(eng_data, eng_data.index_pool, model.index_range, data);
 }
 
 void liboceanlight::engine::create_vertex_buffers(engine_data& eng_data)
 {
+	VkDeviceSize uploaded {0}, unpacked {0};
+	size_t packed_count {0};
+
 	for (auto& model : eng_data.model_list)
 	{
-		upload_buffer(eng_data,
-					  model.vertices.data(),
-					  sizeof(model.vertices[0]) * model.vertices.size(),
-					  VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-					  model.vertex_buffer,
-					  model.vertex_buffer_mem);
+		unpacked += sizeof(vertex) * model.vertices.size();
+		uploaded += upload_vertex_buffer(eng_data, model);
+		packed_count += model.format == vertex_format::packed ? 1 : 0;
 	}
+
+	std::cout << "Uploaded " << uploaded / 1024 << " KiB of vertex data ("
+			  << packed_count << " of " << eng_data.model_list.size()
+			  << " models packed, " << unpacked / 1024
+			  << " KiB unpacked)\n";
 }
 
 void liboceanlight::engine::create_index_buffers(engine_data& eng_data)
 {
+	VkDeviceSize uploaded {0}, unpacked {0};
+	size_t index16_count {0};
+
 	for (auto& model : eng_data.model_list)
 	{
-		upload_buffer(eng_data,
-					  model.indices.data(),
-					  sizeof(model.indices[0]) * model.indices.size(),
-					  VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-					  model.index_buffer,
-					  model.index_buffer_mem);
+		unpacked += sizeof(uint32_t) * model.indices.size();
+		uploaded += upload_index_buffer(eng_data, model);
+		index16_count += model.index_type == VK_INDEX_TYPE_UINT16 ? 1 : 0;
+	}
+
+	std::cout << "Uploaded " << uploaded / 1024 << " KiB of index data ("
+			  << index16_count << " of " << eng_data.model_list.size()
+			  << " models 16 bit, " << unpacked / 1024
+			  << " KiB as 32 bit)\n";
+}
+
+std::vector<std::byte> liboceanlight::engine::pack_vertex_data(
+	models::lol_model& model)
+{
+	if (model.format == vertex_format::packed)
+	{
+		const auto packed {
+			models::pack_vertices(model.vertices, model.quantization)};
+		const auto bytes {std::as_bytes(std::span {packed})};
+		return {bytes.begin(), bytes.end()};
+	}
+
+	const auto bytes {std::as_bytes(std::span {model.vertices})};
+	return {bytes.begin(), bytes.end()};
+}
+
+std::vector<std::byte> liboceanlight::engine::pack_index_data(
+	const models::lol_model& model)
+{
+	if (model.index_type == VK_INDEX_TYPE_UINT16)
+	{
+		const auto packed {models::pack_indices16(model.indices, model.draws)};
+		const auto bytes {std::as_bytes(std::span {packed})};
+		return {bytes.begin(), bytes.end()};
 	}
+
+	const auto bytes {std::as_bytes(std::span {model.indices})};
+	return {bytes.begin(), bytes.end()};
+}
+
+VkDeviceSize liboceanlight::engine::upload_vertex_buffer(
+	engine_data& eng_data,
+	models::lol_model& model)
+{
+	const auto data {pack_vertex_data(model)};
+	upload_vertices(eng_data, model, data);
+	return data.size();
+}
+
+VkDeviceSize liboceanlight::engine::upload_index_buffer(
+	engine_data& eng_data,
+	models::lol_model& model)
+{
+	const auto data {pack_index_data(model)};
+	upload_indices(eng_data, model, data);
+	return data.size();
 }
 
 void liboceanlight::engine::create_uniform_buffers(engine_data& eng_data)
@@ -1209,32 +2831,29 @@ void liboceanlight::engine::create_uniform_buffers(engine_data& eng_data)
 		create_buffer(eng_data,
 					  buff_size,
 					  VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-					  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-						  VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+					  host_write_mem_props(eng_data),
 					  gsl::at(eng_data.uniform_buffers, i),
-					  gsl::at(eng_data.uniform_buffers_mem, i));
-
-		vkMapMemory(eng_data.logical_device,
-					gsl::at(eng_data.uniform_buffers_mem, i),
-					0,
-					buff_size,
-					0,
-					&gsl::at(eng_data.uniform_buffers_mapped, i));
+					  gsl::at(eng_data.uniform_buffers_mem, i),
+					  memory_category::uniforms);
+		gsl::at(eng_data.uniform_buffers_mapped, i) =
+			gsl::at(eng_data.uniform_buffers_mem, i).mapped;
 	}
 }
 
 void liboceanlight::engine::create_descriptor_pool(engine_data& eng_data)
 {
-	std::array<VkDescriptorPoolSize, 2> pool_sizes {};
+	const auto frames {static_cast<uint32_t>(eng_data.max_frames_in_flight)};
+	std::array<VkDescriptorPoolSize, 3> pool_sizes {};
 	pool_sizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	pool_sizes[0].descriptorCount = static_cast<uint32_t>(
-		eng_data.max_frames_in_flight);
+	pool_sizes[0].descriptorCount = frames;
 	pool_sizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	pool_sizes[1].descriptorCount = static_cast<uint32_t>(
-		eng_data.max_frames_in_flight);
+	pool_sizes[1].descriptorCount = frames * eng_data.max_textures;
+	pool_sizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	pool_sizes[2].descriptorCount = frames;
 
 	VkDescriptorPoolCreateInfo pool_info {};
 	pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
 	pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
 	pool_info.pPoolSizes = pool_sizes.data();
 	pool_info.maxSets = static_cast<uint32_t>(eng_data.max_frames_in_flight);
@@ -1271,6 +2890,11 @@ void liboceanlight::engine::create_descriptor_sets(engine_data& eng_data)
 		throw std::runtime_error("Failed to allocate descriptor sets");
 	}
 
+	write_descriptor_sets(eng_data);
+}
+
+void liboceanlight::engine::write_descriptor_sets(engine_data& eng_data)
+{
 	for (int i {0}; i < eng_data.max_frames_in_flight; ++i)
 	{
 		VkDescriptorBufferInfo buff_info {};
@@ -1278,10 +2902,10 @@ void liboceanlight::engine::create_descriptor_sets(engine_data& eng_data)
 		buff_info.offset = 0;
 		buff_info.range = sizeof(uniform_buffer_object);
 
-		VkDescriptorImageInfo image_info {};
-		image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		image_info.imageView = eng_data.texture_img_view;
-		image_info.sampler = eng_data.texture_sampler;
+		VkDescriptorBufferInfo material_info {};
+		material_info.buffer = eng_data.material_buffer;
+		material_info.offset = 0;
+		material_info.range = VK_WHOLE_SIZE;
 
 		std::array<VkWriteDescriptorSet, 2> descriptor_writes {};
 		descriptor_writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
@@ -1295,12 +2919,12 @@ void liboceanlight::engine::create_descriptor_sets(engine_data& eng_data)
 
 		descriptor_writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 		descriptor_writes[1].dstSet = gsl::at(eng_data.descriptor_sets, i);
-		descriptor_writes[1].dstBinding = 1;
+		descriptor_writes[1].dstBinding = 2;
 		descriptor_writes[1].dstArrayElement = 0;
 		descriptor_writes[1].descriptorType =
-			VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 		descriptor_writes[1].descriptorCount = 1;
-		descriptor_writes[1].pImageInfo = &image_info;
+		descriptor_writes[1].pBufferInfo = &material_info;
 
 		vkUpdateDescriptorSets(eng_data.logical_device,
 							   static_cast<uint32_t>(descriptor_writes.size()),
@@ -1308,14 +2932,53 @@ void liboceanlight::engine::create_descriptor_sets(engine_data& eng_data)
 							   0,
 							   nullptr);
 	}
+
+	for (size_t slot {0}; slot < eng_data.textures.size(); ++slot)
+	{
+		write_texture_descriptor(eng_data, static_cast<uint32_t>(slot));
+	}
+}
+
+void liboceanlight::engine::write_texture_descriptor(engine_data& eng_data,
+													 uint32_t slot)
+{
+	const auto& tex {eng_data.textures.at(slot)};
+	const auto& placeholder {eng_data.placeholder_texture};
+	VkDescriptorImageInfo image_info {};
+	image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	image_info.imageView = tex.img_view ? tex.img_view : placeholder.img_view;
+	image_info.sampler = eng_data.texture_sampler;
+
+	std::array<VkWriteDescriptorSet, engine_data::max_frames_in_flight>
+		descriptor_writes {};
+	for (int i {0}; i < eng_data.max_frames_in_flight; ++i)
+	{
+		auto& write {gsl::at(descriptor_writes, i)};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = gsl::at(eng_data.descriptor_sets, i);
+		write.dstBinding = 1;
+		write.dstArrayElement = slot;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		write.descriptorCount = 1;
+		write.pImageInfo = &image_info;
+	}
+
+	vkUpdateDescriptorSets(eng_data.logical_device,
+						   static_cast<uint32_t>(descriptor_writes.size()),
+						   descriptor_writes.data(),
+						   0,
+						   nullptr);
 }
 
-void liboceanlight::engine::create_buffer(engine_data& eng_data,
-										  VkDeviceSize size,
-										  VkBufferUsageFlags usage,
-										  VkMemoryPropertyFlags props,
-										  VkBuffer& buff,
-										  VkDeviceMemory& buff_mem)
+void liboceanlight::engine::create_buffer(
+	engine_data& eng_data,
+	VkDeviceSize size,
+	VkBufferUsageFlags usage,
+	VkMemoryPropertyFlags props,
+	VkBuffer& buff,
+	liboceanlight::device_allocation& buff_mem,
+	memory_category category,
+	memory_usage mem_usage)
 {
 	VkBufferCreateInfo buff_info {};
 	buff_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -1335,27 +2998,26 @@ void liboceanlight::engine::create_buffer(engine_data& eng_data,
 
 	VkMemoryRequirements mem_reqs;
 	vkGetBufferMemoryRequirements(eng_data.logical_device, buff, &mem_reqs);
+	buff_mem = eng_data.allocator->allocate(
+		mem_reqs, props, mem_usage, category);
+	vkBindBufferMemory(eng_data.logical_device,
+					   buff,
+					   buff_mem.memory,
+					   buff_mem.offset);
+}
 
-	uint32_t type_index = find_mem_type(eng_data,
-										mem_reqs.memoryTypeBits,
-										props);
-
-	VkMemoryAllocateInfo alloc_info {};
-	alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	alloc_info.allocationSize = mem_reqs.size;
-	alloc_info.memoryTypeIndex = type_index;
-
-	rv = vkAllocateMemory(eng_data.logical_device,
-						  &alloc_info,
-						  nullptr,
-						  &buff_mem);
-
-	if (rv != VK_SUCCESS)
+void liboceanlight::engine::destroy_buffer(
+	engine_data& eng_data,
+	VkBuffer& buff,
+	liboceanlight::device_allocation& buff_mem)
+{
+	if (buff)
 	{
-		throw std::runtime_error("Failed to allocate vertex buffer memory");
+		vkDestroyBuffer(eng_data.logical_device, buff, nullptr);
+		buff = nullptr;
 	}
 
-	vkBindBufferMemory(eng_data.logical_device, buff, buff_mem, 0);
+	eng_data.allocator->free(buff_mem);
 }
 
 void liboceanlight::engine::copy_buffer(engine_data& eng_data,
@@ -1374,9 +3036,7 @@ uint32_t liboceanlight::engine::find_mem_type(engine_data& eng_data,
 											  uint32_t type_filter,
 											  VkMemoryPropertyFlags flags)
 {
-	VkPhysicalDeviceMemoryProperties mem_props;
-	vkGetPhysicalDeviceMemoryProperties(eng_data.physical_device, &mem_props);
-
+	const auto& mem_props {eng_data.memory_props};
 	for (uint32_t i {0}; i < mem_props.memoryTypeCount; ++i)
 	{
 		if ((type_filter & (1 << i)) &&
@@ -1406,6 +3066,82 @@ void liboceanlight::engine::create_cmd_buffer(engine_data& eng_data)
 	}
 }
 
+void liboceanlight::engine::create_record_pools(engine_data& eng_data)
+{
+	/* Reset a pool at a time rather than a command buffer at a time */
+	VkCommandPoolCreateInfo c_info {};
+	c_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	c_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	c_info.queueFamilyIndex = eng_data.graphics_queue_index;
+
+	const unsigned int threads {std::max(eng_data.record_threads, 1u)};
+	for (auto& slots : eng_data.record_slots)
+	{
+		slots.resize(threads);
+		for (auto& slot : slots)
+		{
+			VkResult rv {vkCreateCommandPool(
+				eng_data.logical_device, &c_info, nullptr, &slot.pool)};
+			if (rv != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to create command pool");
+			}
+
+			VkCommandBufferAllocateInfo alloc_info {};
+			alloc_info.sType =
+				VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			alloc_info.commandPool = slot.pool;
+			alloc_info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+			alloc_info.commandBufferCount = 1;
+			rv = vkAllocateCommandBuffers(
+				eng_data.logical_device, &alloc_info, &slot.cmd_buffer);
+			if (rv != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to allocate command buffer");
+			}
+		}
+	}
+
+	/* The thread calling record_cmd_buffer records too */
+	if (threads > 1)
+	{
+		eng_data.record_workers =
+			std::make_unique<thread_pool>(threads - 1);
+	}
+}
+
+void liboceanlight::engine::create_recorded_frames(engine_data& eng_data)
+{
+	if (!eng_data.reuse_cmd_buffers)
+	{
+		return;
+	}
+
+	VkCommandBufferAllocateInfo alloc_info {};
+	alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	alloc_info.commandPool = eng_data.command_pool;
+	alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	alloc_info.commandBufferCount = static_cast<uint32_t>(
+		eng_data.frame_buffers.size());
+
+	std::vector<VkCommandBuffer> cmd_buffers(alloc_info.commandBufferCount);
+	for (auto& frames : eng_data.recorded_frames)
+	{
+		VkResult rv {vkAllocateCommandBuffers(
+			eng_data.logical_device, &alloc_info, cmd_buffers.data())};
+		if (rv != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to allocate command buffer");
+		}
+
+		frames.clear();
+		for (auto cmd_buffer : cmd_buffers)
+		{
+			frames.push_back({cmd_buffer, true});
+		}
+	}
+}
+
 void liboceanlight::engine::create_sync_objects(engine_data& eng_data)
 {
 	VkSemaphoreCreateInfo sem_info {};
@@ -1504,6 +3240,12 @@ VkPhysicalDevice liboceanlight::engine::select_physical_dev(
 			continue;
 		}
 
+		if (!supports_bindless_textures(devs[i]))
+		{
+			scores[i] = 0;
+			continue;
+		}
+
 		if (props.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
 		{
 			scores[i] += bonus_discrete;
@@ -1549,6 +3291,12 @@ void liboceanlight::engine::check_dev_ext_support(engine_data& eng_data)
 	{
 		throw std::runtime_error("Not all device extensions supported");
 	}
+
+	/* Optional: without it the heap sizes stand in for the budget */
+	eng_data.memory_budget_supported =
+		std::find(supported.begin(),
+				  supported.end(),
+				  VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) != supported.end();
 }
 
 const std::vector<std::string> liboceanlight::engine::get_dev_exts(
@@ -3,6 +3,7 @@
 #include <liboceanlight/lol_debug_messenger.hpp>
 #include <liboceanlight/lol_engine_init.hpp>
 #include <liboceanlight/lol_engine_shutdown.hpp>
+#include <liboceanlight/lol_streaming.hpp>
 #include <vulkan/vulkan.h>
 
 using namespace liboceanlight::engine;
@@ -14,19 +15,27 @@ void liboceanlight::engine::shutdown(engine_data& eng_data)
 
 void liboceanlight::engine::deinitialize(engine_data& eng_data)
 {
+	cleanup_streaming(eng_data);
+	cleanup_hot_reload(eng_data);
 	cleanup_fences(eng_data);
 	cleanup_semaphores(eng_data);
+	cleanup_staging(eng_data);
 	cleanup_commands(eng_data);
 	cleanup_pipeline(eng_data);
 	cleanup_swapchain(eng_data);
 	cleanup_images(eng_data);
 	cleanup_descriptor_pool(eng_data);
 	models::cleanup_models(eng_data, eng_data.model_list);
+	cleanup_geometry_pools(eng_data);
 	cleanup_uniform_buffers(eng_data);
+	cleanup_material_buffer(eng_data);
+	cleanup_staging_buffer(eng_data);
+	cleanup_allocator(eng_data);
 	cleanup_surface(eng_data);
 	cleanup_logical_device(eng_data);
 	cleanup_debug_messenger(eng_data);
 	cleanup_instance(eng_data);
+	cleanup_thread_pool(eng_data);
 }
 
 void liboceanlight::engine::cleanup_fences(engine_data& eng_data)
@@ -41,6 +50,29 @@ void liboceanlight::engine::cleanup_fences(engine_data& eng_data)
 	}
 }
 
+void liboceanlight::engine::cleanup_thread_pool(engine_data& eng_data)
+{
+	eng_data.workers.reset();
+}
+
+void liboceanlight::engine::cleanup_hot_reload(engine_data& eng_data)
+{
+	eng_data.watcher.reset();
+}
+
+void liboceanlight::engine::cleanup_streaming(engine_data& eng_data)
+{
+	/* Joins the loader; uploads it staged were never made */
+	eng_data.stream.reset();
+
+	/* The uploads already made are swapped in, so cleanup frees them */
+	if (!eng_data.upload_swaps.empty())
+	{
+		wait_upload(eng_data, eng_data.upload_serial);
+		swap_uploaded(eng_data);
+	}
+}
+
 void liboceanlight::engine::cleanup_semaphores(engine_data& eng_data)
 {
 	const size_t signal_sems_n {eng_data.signal_sems.size()};
@@ -64,21 +96,55 @@ void liboceanlight::engine::cleanup_semaphores(engine_data& eng_data)
 
 void liboceanlight::engine::cleanup_commands(engine_data& eng_data)
 {
-	if (eng_data.command_pool)
+	cleanup_recorded_frames(eng_data);
+	cleanup_record_pools(eng_data);
+
+	for (auto pool : {eng_data.command_pool, eng_data.transfer_cmd_pool})
 	{
-		vkDestroyCommandPool(eng_data.logical_device,
-							 eng_data.command_pool,
-							 nullptr);
+		if (pool)
+		{
+			vkDestroyCommandPool(eng_data.logical_device, pool, nullptr);
+		}
+	}
+}
+
+void liboceanlight::engine::cleanup_record_pools(engine_data& eng_data)
+{
+	eng_data.record_workers.reset();
+	for (auto& slots : eng_data.record_slots)
+	{
+		for (const auto& slot : slots)
+		{
+			vkDestroyCommandPool(eng_data.logical_device, slot.pool, nullptr);
+		}
+		slots.clear();
+	}
+}
+
+void liboceanlight::engine::cleanup_recorded_frames(engine_data& eng_data)
+{
+	for (auto& frames : eng_data.recorded_frames)
+	{
+		for (const auto& frame : frames)
+		{
+			vkFreeCommandBuffers(eng_data.logical_device,
+								 eng_data.command_pool,
+								 1,
+								 &frame.cmd_buffer);
+		}
+		frames.clear();
 	}
 }
 
 void liboceanlight::engine::cleanup_pipeline(engine_data& eng_data)
 {
-	if (eng_data.graphics_pipeline)
+	for (auto& pipeline : eng_data.graphics_pipelines)
 	{
-		vkDestroyPipeline(eng_data.logical_device,
-						  eng_data.graphics_pipeline,
-						  nullptr);
+		if (pipeline)
+		{
+			vkDestroyPipeline(eng_data.logical_device, pipeline, nullptr);
+			pipeline = nullptr;
+		}
 	}
 
 	if (eng_data.pipeline_layout)
@@ -102,7 +168,7 @@ void liboceanlight::engine::cleanup_swapchain(engine_data& eng_data)
 					   eng_data.depth_img_view,
 					   nullptr);
 	vkDestroyImage(eng_data.logical_device, eng_data.depth_img, nullptr);
-	vkFreeMemory(eng_data.logical_device, eng_data.depth_img_mem, nullptr);
+	eng_data.allocator->free(eng_data.depth_img_mem);
 
 	const std::vector<int>::size_type fb_n = eng_data.frame_buffers.size();
 	for (std::vector<int>::size_type i {0}; i < fb_n; ++i)
@@ -133,11 +199,12 @@ void liboceanlight::engine::cleanup_images(engine_data& eng_data)
 	vkDestroySampler(eng_data.logical_device,
 					 eng_data.texture_sampler,
 					 nullptr);
-	vkDestroyImageView(eng_data.logical_device,
-					   eng_data.texture_img_view,
-					   nullptr);
-	vkDestroyImage(eng_data.logical_device, eng_data.texture_img, nullptr);
-	vkFreeMemory(eng_data.logical_device, eng_data.texture_img_mem, nullptr);
+	for (auto& tex : eng_data.textures)
+	{
+		destroy_texture(eng_data, tex);
+	}
+
+	destroy_texture(eng_data, eng_data.placeholder_texture);
 }
 
 void liboceanlight::engine::cleanup_descriptor_pool(engine_data& eng_data)
@@ -159,52 +226,40 @@ void liboceanlight::engine::cleanup_descriptor_pool(engine_data& eng_data)
 
 void liboceanlight::engine::cleanup_uniform_buffers(engine_data& eng_data)
 {
-	if (!eng_data.uniform_buffers.empty())
+	for (size_t i {0}; i < eng_data.max_frames_in_flight; ++i)
 	{
-		for (size_t i {0}; i < eng_data.max_frames_in_flight; ++i)
-		{
-			vkDestroyBuffer(
-				eng_data.logical_device,
-				gsl::at(eng_data.uniform_buffers, static_cast<long long>(i)),
-				nullptr);
-
-			vkFreeMemory(eng_data.logical_device,
-						 gsl::at(eng_data.uniform_buffers_mem,
-								 static_cast<long long>(i)),
-						 nullptr);
-		}
+		destroy_buffer(eng_data,
+					   gsl::at(eng_data.uniform_buffers, i),
+					   gsl::at(eng_data.uniform_buffers_mem, i));
 	}
 }
 
+void liboceanlight::engine::cleanup_material_buffer(engine_data& eng_data)
+{
+	destroy_buffer(eng_data,
+				   eng_data.material_buffer,
+				   eng_data.material_buffer_mem);
+}
+
 void liboceanlight::engine::cleanup_vertex_buffer(
 	engine_data& eng_data,
-	VkBuffer& vertex_buffer,
-	VkDeviceMemory& vertex_buffer_mem)
+	models::geometry_range& vertex_range)
 {
-	if (vertex_buffer)
-	{
-		vkDestroyBuffer(eng_data.logical_device, vertex_buffer, nullptr);
-	}
-
-	if (vertex_buffer_mem)
-	{
-		vkFreeMemory(eng_data.logical_device, vertex_buffer_mem, nullptr);
-	}
+	free_geometry(eng_data.vertex_pool, vertex_range);
 }
 
 void liboceanlight::engine::cleanup_index_buffer(
 	engine_data& eng_data,
-	VkBuffer& index_buffer,
-	VkDeviceMemory& index_buffer_mem)
+	models::geometry_range& index_range)
 {
-	if (index_buffer)
-	{
-		vkDestroyBuffer(eng_data.logical_device, index_buffer, nullptr);
-	}
+	free_geometry(eng_data.index_pool, index_range);
+}
 
-	if (index_buffer_mem)
+void liboceanlight::engine::cleanup_geometry_pools(engine_data& eng_data)
+{
+	for (auto* pool : {&eng_data.vertex_pool, &eng_data.index_pool})
 	{
-		vkFreeMemory(eng_data.logical_device, index_buffer_mem, nullptr);
+		destroy_buffer(eng_data, pool->buffer, pool->mem);
 	}
 }
 
@@ -214,16 +269,35 @@ void liboceanlight::models::cleanup_models(
 {
 	for (int i {0}; i < models.size(); ++i)
 	{
-		cleanup_vertex_buffer(eng_data,
-							  models[i].vertex_buffer,
-							  models[i].vertex_buffer_mem);
+		cleanup_vertex_buffer(eng_data, models[i].vertex_range);
+		cleanup_index_buffer(eng_data, models[i].index_range);
+	}
+}
 
-		cleanup_index_buffer(eng_data,
-							 models[i].index_buffer,
-							 models[i].index_buffer_mem);
+void liboceanlight::engine::cleanup_staging(engine_data& eng_data)
+{
+	wait_upload(eng_data, eng_data.upload_serial);
+	for (auto sem : {eng_data.transfer_timeline, eng_data.upload_timeline})
+	{
+		if (sem)
+		{
+			vkDestroySemaphore(eng_data.logical_device, sem, nullptr);
+		}
 	}
 }
 
+void liboceanlight::engine::cleanup_staging_buffer(engine_data& eng_data)
+{
+	destroy_buffer(eng_data,
+				   eng_data.staging_buffer,
+				   eng_data.staging_buffer_mem);
+}
+
+void liboceanlight::engine::cleanup_allocator(engine_data& eng_data)
+{
+	eng_data.allocator.reset();
+}
+
 void liboceanlight::engine::cleanup_surface(engine_data& eng_data)
 {
 	if (eng_data.window_surface)
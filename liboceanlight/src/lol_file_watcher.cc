@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <liboceanlight/lol_file_watcher.hpp>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif /* __linux__ */
+
+namespace fs = std::filesystem;
+
+#ifdef __linux__
+liboceanlight::file_watcher::file_watcher() :
+	inotify_fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+{
+	if (inotify_fd < 0)
+	{
+		throw std::runtime_error(std::string {"inotify_init1 failed: "} +
+								 std::strerror(errno));
+	}
+}
+
+liboceanlight::file_watcher::~file_watcher() noexcept
+{
+	close(inotify_fd);
+}
+
+void liboceanlight::file_watcher::watch(const std::string& dir)
+{
+	/* Editors and compilers either rewrite in place or rename a
+	 * finished temporary over the target */
+	const int wd {inotify_add_watch(
+		inotify_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO)};
+	if (wd < 0)
+	{
+		throw std::runtime_error("Failed to watch " + dir + ": " +
+								 std::strerror(errno));
+	}
+
+	watches[wd] = dir;
+}
+
+std::vector<std::string> liboceanlight::file_watcher::poll()
+{
+	std::vector<std::string> changed;
+	alignas(inotify_event) char buffer[4096];
+
+	for (;;)
+	{
+		const ssize_t length {read(inotify_fd, buffer, sizeof(buffer))};
+		if (length <= 0)
+		{
+			break;
+		}
+
+		for (ssize_t offset {0}; offset < length;)
+		{
+			inotify_event event {};
+			std::memcpy(&event, buffer + offset, sizeof(event));
+			const char* name {buffer + offset + sizeof(inotify_event)};
+			offset += static_cast<ssize_t>(sizeof(inotify_event) + event.len);
+
+			auto dir {watches.find(event.wd)};
+			if (event.len == 0 || dir == watches.end())
+			{
+				continue;
+			}
+
+			changed.push_back((fs::path {dir->second} / name).string());
+		}
+	}
+
+	std::sort(changed.begin(), changed.end());
+	changed.erase(std::unique(changed.begin(), changed.end()),
+				  changed.end());
+	return changed;
+}
+#else
+liboceanlight::file_watcher::file_watcher() = default;
+
+liboceanlight::file_watcher::~file_watcher() noexcept = default;
+
+void liboceanlight::file_watcher::watch(const std::string& dir)
+{
+	if (!fs::is_directory(dir))
+	{
+		throw std::runtime_error("Failed to watch " + dir);
+	}
+
+	dirs.push_back(dir);
+	scan(nullptr);
+}
+
+/* Records current mtimes, appending new or modified files to changed */
+void liboceanlight::file_watcher::scan(std::vector<std::string>* changed)
+{
+	std::error_code ec {};
+	for (const auto& dir : dirs)
+	{
+		for (const auto& file : fs::directory_iterator(dir, ec))
+		{
+			if (!file.is_regular_file(ec))
+			{
+				continue;
+			}
+
+			const auto path {file.path().string()};
+			const auto mtime {file.last_write_time(ec)};
+			auto [it, inserted] {mtimes.try_emplace(path, mtime)};
+			if ((inserted || it->second != mtime) && changed)
+			{
+				changed->push_back(path);
+			}
+
+			it->second = mtime;
+		}
+	}
+}
+
+std::vector<std::string> liboceanlight::file_watcher::poll()
+{
+	std::vector<std::string> changed;
+	const auto now {std::chrono::steady_clock::now()};
+	if (now - last_scan < scan_interval)
+	{
+		return changed;
+	}
+
+	last_scan = now;
+	scan(&changed);
+	std::sort(changed.begin(), changed.end());
+	return changed;
+}
+#endif /* __linux__ */
@@ -0,0 +1,378 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <iostream>
+#include <liboceanlight/lol_engine.hpp>
+#include <liboceanlight/lol_gltf.hpp>
+#include <liboceanlight/lol_utility.hpp>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <tiny_gltf.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+using liboceanlight::engine::vertex;
+
+namespace
+{
+	/* Strided view of an accessor inside its buffer, bounds checked */
+	struct accessor_view
+	{
+		const unsigned char* data {nullptr};
+		size_t stride {0};
+		size_t count {0};
+		int component_type {-1};
+		int components {0};
+		bool normalized {false};
+	};
+
+	accessor_view view_accessor(const tinygltf::Model& gltf,
+								int index,
+								const std::string& path)
+	{
+		if (index < 0 || static_cast<size_t>(index) >= gltf.accessors.size())
+		{
+			throw std::runtime_error("Bad accessor index in " + path);
+		}
+
+		const auto& accessor {gltf.accessors[index]};
+		if (accessor.sparse.isSparse || accessor.bufferView < 0)
+		{
+			throw std::runtime_error("Sparse accessors are not supported in " +
+									 path);
+		}
+
+		const auto& buffer_view {gltf.bufferViews.at(accessor.bufferView)};
+		const auto& buffer {gltf.buffers.at(buffer_view.buffer)};
+		const int stride {accessor.ByteStride(buffer_view)};
+		const int component_size {
+			tinygltf::GetComponentSizeInBytes(accessor.componentType)};
+		const int components {tinygltf::GetNumComponentsInType(accessor.type)};
+
+		if (stride <= 0 || component_size <= 0 || components <= 0)
+		{
+			throw std::runtime_error("Bad accessor layout in " + path);
+		}
+
+		const size_t offset {buffer_view.byteOffset + accessor.byteOffset};
+		const size_t element {static_cast<size_t>(component_size) *
+							  static_cast<size_t>(components)};
+		if (accessor.count > 0 &&
+			offset + (accessor.count - 1) * stride + element >
+				std::min(buffer.data.size(),
+						 buffer_view.byteOffset + buffer_view.byteLength))
+		{
+			throw std::runtime_error("Accessor out of bounds in " + path);
+		}
+
+		return {buffer.data.data() + offset,
+				static_cast<size_t>(stride),
+				accessor.count,
+				accessor.componentType,
+				components,
+				accessor.normalized};
+	}
+
+	template <typename T> T read_as(const unsigned char* data)
+	{
+		T value {};
+		std::memcpy(&value, data, sizeof(T));
+		return value;
+	}
+
+	float read_component(const accessor_view& view, size_t i, int c)
+	{
+		const unsigned char* element {view.data + i * view.stride};
+		switch (view.component_type)
+		{
+			case TINYGLTF_COMPONENT_TYPE_FLOAT:
+				return read_as<float>(element + c * sizeof(float));
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+			{
+				const float value {static_cast<float>(
+					read_as<uint16_t>(element + c * sizeof(uint16_t)))};
+				return view.normalized ? value / 65535.0f : value;
+			}
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+			{
+				const float value {static_cast<float>(element[c])};
+				return view.normalized ? value / 255.0f : value;
+			}
+			default:
+				throw std::runtime_error("Unsupported vertex component type");
+		}
+	}
+
+	uint32_t read_index(const accessor_view& view, size_t i)
+	{
+		const unsigned char* element {view.data + i * view.stride};
+		switch (view.component_type)
+		{
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+				return read_as<uint32_t>(element);
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+				return read_as<uint16_t>(element);
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+				return *element;
+			default:
+				throw std::runtime_error("Unsupported index component type");
+		}
+	}
+
+	glm::mat4 node_transform(const tinygltf::Node& node)
+	{
+		if (node.matrix.size() == 16)
+		{
+			return glm::mat4 {glm::make_mat4(node.matrix.data())};
+		}
+
+		glm::mat4 transform {1.0f};
+		if (node.translation.size() == 3)
+		{
+			transform = glm::translate(
+				transform,
+				glm::vec3 {static_cast<float>(node.translation[0]),
+						   static_cast<float>(node.translation[1]),
+						   static_cast<float>(node.translation[2])});
+		}
+
+		if (node.rotation.size() == 4)
+		{
+			/* glTF stores xyzw, glm::quat takes wxyz */
+			transform = transform *
+						glm::mat4_cast(
+							glm::quat {static_cast<float>(node.rotation[3]),
+									   static_cast<float>(node.rotation[0]),
+									   static_cast<float>(node.rotation[1]),
+									   static_cast<float>(node.rotation[2])});
+		}
+
+		if (node.scale.size() == 3)
+		{
+			transform = glm::scale(
+				transform,
+				glm::vec3 {static_cast<float>(node.scale[0]),
+						   static_cast<float>(node.scale[1]),
+						   static_cast<float>(node.scale[2])});
+		}
+
+		return transform;
+	}
+
+	/* Appends one primitive, vertices are copied straight out of the
+	 * buffer views since glTF is already indexed */
+	void append_primitive(const tinygltf::Model& gltf,
+						  const tinygltf::Primitive& primitive,
+						  const glm::mat4& transform,
+						  const std::string& path,
+						  std::vector<vertex>& vertices,
+						  std::vector<uint32_t>& indices)
+	{
+		if (primitive.mode != -1 && primitive.mode != TINYGLTF_MODE_TRIANGLES)
+		{
+			std::cerr << "Skipping non-triangle primitive in " << path << "\n";
+			return;
+		}
+
+		const auto position {primitive.attributes.find("POSITION")};
+		if (position == primitive.attributes.end())
+		{
+			throw std::runtime_error("Primitive without POSITION in " + path);
+		}
+
+		const auto positions {view_accessor(gltf, position->second, path)};
+		if (positions.component_type != TINYGLTF_COMPONENT_TYPE_FLOAT ||
+			positions.components != 3)
+		{
+			throw std::runtime_error("POSITION must be float vec3 in " + path);
+		}
+
+		accessor_view texcoords {};
+		const auto texcoord {primitive.attributes.find("TEXCOORD_0")};
+		if (texcoord != primitive.attributes.end())
+		{
+			texcoords = view_accessor(gltf, texcoord->second, path);
+			if (texcoords.components != 2 ||
+				texcoords.count != positions.count)
+			{
+				throw std::runtime_error("Bad TEXCOORD_0 in " + path);
+			}
+		}
+
+		const auto base {static_cast<uint32_t>(vertices.size())};
+		vertices.reserve(vertices.size() + positions.count);
+		for (size_t i {0}; i < positions.count; ++i)
+		{
+			vertex v {};
+			const glm::vec4 local {read_component(positions, i, 0),
+								   read_component(positions, i, 1),
+								   read_component(positions, i, 2),
+								   1.0f};
+			const glm::vec4 pos {transform * local};
+			v.pos = {pos.x, pos.y, pos.z};
+			v.color = {1.0f, 1.0f, 1.0f};
+
+			/* glTF texcoords already have a top-left origin like Vulkan */
+			if (texcoords.data)
+			{
+				v.texcoord = {read_component(texcoords, i, 0),
+							  read_component(texcoords, i, 1)};
+			}
+
+			vertices.push_back(v);
+		}
+
+		const size_t first {indices.size()};
+		if (primitive.indices >= 0)
+		{
+			const auto view {view_accessor(gltf, primitive.indices, path)};
+			indices.reserve(indices.size() + view.count);
+			for (size_t i {0}; i < view.count; ++i)
+			{
+				const uint32_t index {read_index(view, i)};
+				if (index >= positions.count)
+				{
+					throw std::runtime_error("Index out of range in " + path);
+				}
+
+				indices.push_back(base + index);
+			}
+		}
+		else
+		{
+			for (uint32_t i {0}; i < positions.count; ++i)
+			{
+				indices.push_back(base + i);
+			}
+		}
+
+		/* Mirroring transforms flip the winding, undo it so culling with
+		 * VK_FRONT_FACE_COUNTER_CLOCKWISE still works */
+		const glm::vec3 x {transform[0].x, transform[0].y, transform[0].z};
+		const glm::vec3 y {transform[1].x, transform[1].y, transform[1].z};
+		const glm::vec3 z {transform[2].x, transform[2].y, transform[2].z};
+		if (glm::dot(glm::cross(x, y), z) < 0.0f)
+		{
+			for (size_t i {first}; i + 2 < indices.size(); i += 3)
+			{
+				std::swap(indices[i + 1], indices[i + 2]);
+			}
+		}
+	}
+
+	void append_node(const tinygltf::Model& gltf,
+					 int index,
+					 const glm::mat4& parent,
+					 const std::string& path,
+					 size_t depth,
+					 std::vector<vertex>& vertices,
+					 std::vector<uint32_t>& indices)
+	{
+		/* Node graphs must be trees, a cycle would recurse forever */
+		if (depth > gltf.nodes.size())
+		{
+			throw std::runtime_error("Node hierarchy has a cycle in " + path);
+		}
+
+		const auto& node {gltf.nodes.at(index)};
+		const glm::mat4 transform {parent * node_transform(node)};
+
+		if (node.mesh >= 0)
+		{
+			for (const auto& primitive : gltf.meshes.at(node.mesh).primitives)
+			{
+				append_primitive(
+					gltf, primitive, transform, path, vertices, indices);
+			}
+		}
+
+		for (int child : node.children)
+		{
+			append_node(
+				gltf, child, transform, path, depth + 1, vertices, indices);
+		}
+	}
+
+	/* Textures come from TEXTURE_PATH for now, skip decoding images */
+	bool skip_image(tinygltf::Image*,
+					const int,
+					std::string*,
+					std::string*,
+					int,
+					int,
+					const unsigned char*,
+					int,
+					void*)
+	{
+		return true;
+	}
+} /* namespace */
+
+void liboceanlight::models::load_gltf(const std::string& path,
+									  std::vector<vertex>& vertices,
+									  std::vector<uint32_t>& indices)
+{
+	/* Parse straight out of the mapping rather than a read copy */
+	mapped_file file {path};
+	load_gltf(path, file.bytes(), vertices, indices);
+}
+
+void liboceanlight::models::load_gltf(const std::string& path,
+									  std::span<const std::byte> bytes,
+									  std::vector<vertex>& vertices,
+									  std::vector<uint32_t>& indices)
+{
+	const auto* data {reinterpret_cast<const unsigned char*>(bytes.data())};
+	const auto size {static_cast<unsigned int>(bytes.size())};
+	const std::string base_dir {fs::path(path).parent_path().string()};
+
+	tinygltf::TinyGLTF loader;
+	tinygltf::Model gltf;
+	std::string warn, err;
+	loader.SetImageLoader(skip_image, nullptr);
+
+	const bool binary {size >= 4 && std::memcmp(data, "glTF", 4) == 0};
+	const bool rv {binary ? loader.LoadBinaryFromMemory(
+								&gltf, &err, &warn, data, size, base_dir)
+						  : loader.LoadASCIIFromString(
+								&gltf,
+								&err,
+								&warn,
+								reinterpret_cast<const char*>(data),
+								size,
+								base_dir)};
+
+	if (!rv)
+	{
+		throw std::runtime_error("Failed to load model " + path + "\n" +
+								 warn + err);
+	}
+
+	const glm::mat4 identity {1.0f};
+	if (gltf.scenes.empty())
+	{
+		/* No scene to instance nodes, take every mesh as is */
+		for (const auto& mesh : gltf.meshes)
+		{
+			for (const auto& primitive : mesh.primitives)
+			{
+				append_primitive(
+					gltf, primitive, identity, path, vertices, indices);
+			}
+		}
+
+		return;
+	}
+
+	const auto scene {gltf.defaultScene >= 0 ? gltf.defaultScene : 0};
+	for (int node : gltf.scenes.at(scene).nodes)
+	{
+		append_node(gltf, node, identity, path, 0, vertices, indices);
+	}
+}
@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <config.h>
+#include <exception>
+#include <iostream>
+#include <liboceanlight/lol_engine.hpp>
+#include <liboceanlight/lol_engine_init.hpp>
+#include <liboceanlight/lol_engine_shutdown.hpp>
+#include <liboceanlight/lol_file_watcher.hpp>
+#include <liboceanlight/lol_hot_reload.hpp>
+#include <liboceanlight/lol_models.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace liboceanlight::engine;
+
+void liboceanlight::engine::create_hot_reload(engine_data& eng_data)
+{
+	if (!eng_data.hot_reload_enabled)
+	{
+		return;
+	}
+
+	try
+	{
+		auto watcher {std::make_unique<liboceanlight::file_watcher>()};
+		watcher->watch(MODEL_PATH);
+		watcher->watch(TEXTURE_PATH);
+		watcher->watch(SHADER_PATH);
+		eng_data.watcher = std::move(watcher);
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "Hot reload disabled: " << e.what() << "\n";
+	}
+}
+
+void liboceanlight::engine::process_hot_reload(engine_data& eng_data)
+{
+	if (!eng_data.watcher)
+	{
+		return;
+	}
+
+	const auto changed {eng_data.watcher->poll()};
+	if (changed.empty())
+	{
+		return;
+	}
+
+	std::vector<std::string> model_paths;
+	std::vector<uint32_t> texture_slots;
+	bool shaders_changed {false};
+	const auto& textures {eng_data.textures};
+	for (const auto& path : changed)
+	{
+		auto texture {
+			std::find_if(textures.begin(), textures.end(), [&](const auto& t) {
+				return t.path == path;
+			})};
+
+		if (path.starts_with(MODEL_PATH) && models::is_model_file(path))
+		{
+			model_paths.push_back(path);
+		}
+		else if (texture != textures.end())
+		{
+			texture_slots.push_back(
+				static_cast<uint32_t>(texture - textures.begin()));
+		}
+		else if (path.starts_with(SHADER_PATH) && path.ends_with(".spv"))
+		{
+			shaders_changed = true;
+		}
+	}
+
+	retire_list retire;
+	if (!model_paths.empty())
+	{
+		reload_models(eng_data, model_paths, retire);
+	}
+
+	for (const auto slot : texture_slots)
+	{
+		reload_texture(eng_data, slot, retire);
+	}
+
+	if (shaders_changed)
+	{
+		reload_pipelines(eng_data, retire);
+	}
+
+	run_retired(eng_data, retire);
+}
+
+void liboceanlight::engine::run_retired(engine_data& eng_data,
+										retire_list& retire)
+{
+	if (retire.empty())
+	{
+		return;
+	}
+
+	/* Recorded command buffers and bound descriptor sets still point at
+	 * the old resources until every frame in flight has retired */
+	vkWaitForFences(eng_data.logical_device,
+					static_cast<uint32_t>(eng_data.in_flight_fences.size()),
+					eng_data.in_flight_fences.data(),
+					VK_TRUE,
+					UINT64_MAX);
+
+	for (auto& task : retire)
+	{
+		task();
+	}
+
+	retire.clear();
+}
+
+bool liboceanlight::engine::swap_model(engine_data& eng_data,
+									   models::lol_model& model)
+{
+	auto& list {eng_data.model_list};
+	auto existing {
+		std::find_if(list.begin(), list.end(), [&](const auto& m) {
+			return m.name == model.name;
+		})};
+
+	if (existing == list.end())
+	{
+		list.push_back(std::move(model));
+		invalidate_recorded_frames(eng_data);
+		return false;
+	}
+
+	model.material_index = existing->material_index;
+	std::swap(*existing, model);
+	invalidate_recorded_frames(eng_data);
+	cleanup_vertex_buffer(eng_data, model.vertex_range);
+	cleanup_index_buffer(eng_data, model.index_range);
+	return true;
+}
+
+void liboceanlight::engine::reload_models(
+	engine_data& eng_data,
+	const std::vector<std::string>& paths,
+	retire_list& retire)
+{
+	for (const auto& path : paths)
+	{
+		/* One file at a time, so a broken file only skips itself */
+		std::vector<models::lol_model> loaded;
+		try
+		{
+			models::load_model_files({path},
+									 loaded,
+									 get_model_load_options(eng_data));
+			prepare_model(eng_data, loaded.front());
+			upload_vertex_buffer(eng_data, loaded.front());
+			upload_index_buffer(eng_data, loaded.front());
+			load_model_material(eng_data, loaded.front());
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << "Hot reload of " << path << " failed: " << e.what()
+					  << "\n";
+			if (!loaded.empty())
+			{
+				models::cleanup_models(eng_data, loaded);
+			}
+			continue;
+		}
+
+		auto swap_in {[&eng_data,
+						model = std::move(loaded.front())]() mutable {
+			const std::string name {model.name};
+			std::cout << (swap_model(eng_data, model) ? "Hot reloaded"
+													  : "Hot reload added")
+					  << " model \"" << name << "\"\n";
+		}};
+		retire.push_back(std::move(swap_in));
+	}
+}
+
+void liboceanlight::engine::load_model_material(engine_data& eng_data,
+												models::lol_model& model)
+{
+	/* A new slot is unused by the frames in flight, so its texture can
+	 * be loaded and written into the array right away */
+	model.material_index = find_material(
+		eng_data, find_model_texture(eng_data, model.name));
+	const uint32_t slot {
+		eng_data.materials.at(model.material_index).texture_index};
+	auto& tex {eng_data.textures.at(slot)};
+	if (tex.img_view)
+	{
+		return;
+	}
+
+	try
+	{
+		create_texture_img(eng_data, tex);
+		create_texture_img_view(eng_data, tex);
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "Loading " << tex.path << " failed, keeping the "
+				  << "placeholder texture: " << e.what() << "\n";
+		destroy_texture(eng_data, tex);
+		return;
+	}
+
+	write_texture_descriptor(eng_data, slot);
+}
+
+void liboceanlight::engine::reload_texture(engine_data& eng_data,
+										   uint32_t slot,
+										   retire_list& retire)
+{
+	texture fresh {.path = eng_data.textures.at(slot).path};
+
+	try
+	{
+		create_texture_img(eng_data, fresh);
+		create_texture_img_view(eng_data, fresh);
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "Hot reload of " << fresh.path << " failed: " << e.what()
+				  << "\n";
+		destroy_texture(eng_data, fresh);
+		return;
+	}
+
+	retire.push_back([&eng_data, slot, fresh]() mutable {
+		std::swap(eng_data.textures.at(slot), fresh);
+		write_texture_descriptor(eng_data, slot);
+		destroy_texture(eng_data, fresh);
+		std::cout << "Hot reloaded texture " << fresh.path << "\n";
+	});
+}
+
+void liboceanlight::engine::reload_pipelines(engine_data& eng_data,
+											 retire_list& retire)
+{
+	const auto old_pipelines {eng_data.graphics_pipelines};
+	const VkPipelineLayout old_layout {eng_data.pipeline_layout};
+
+	try
+	{
+		create_pipeline(eng_data);
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "Hot reload of shaders failed: " << e.what() << "\n";
+		if (eng_data.pipeline_layout != old_layout)
+		{
+			vkDestroyPipelineLayout(eng_data.logical_device,
+									eng_data.pipeline_layout,
+									nullptr);
+		}
+
+		eng_data.graphics_pipelines = old_pipelines;
+		eng_data.pipeline_layout = old_layout;
+		return;
+	}
+
+	invalidate_recorded_frames(eng_data);
+	retire.push_back([&eng_data, old_pipelines, old_layout] {
+		for (auto pipeline : old_pipelines)
+		{
+			vkDestroyPipeline(eng_data.logical_device, pipeline, nullptr);
+		}
+
+		vkDestroyPipelineLayout(eng_data.logical_device, old_layout, nullptr);
+		std::cout << "Hot reloaded shaders\n";
+	});
+}
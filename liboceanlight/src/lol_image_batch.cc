@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <gsl/gsl>
+#include <iostream>
+#include <liboceanlight/lol_image_batch.hpp>
+#include <liboceanlight/lol_mipmap.hpp>
+#include <liboceanlight/lol_thread_pool.hpp>
+#include <memory>
+#include <span>
+#include <stb_image.h>
+#include <vector>
+
+using liboceanlight::textures::staged_image;
+
+namespace
+{
+	/* Runs job on every image, on pool when one is given */
+	template <typename F>
+	void for_each_image(std::span<staged_image> images,
+						liboceanlight::thread_pool* pool,
+						F job)
+	{
+		if (!pool)
+		{
+			std::for_each(images.begin(), images.end(), job);
+			return;
+		}
+
+		/* The jobs hold references to job and the images, so all of them
+		 * finish before a failure unwinds */
+		std::vector<std::future<void>> jobs;
+		const auto wait_jobs {gsl::finally([&jobs] {
+			for (auto& pending : jobs)
+			{
+				if (pending.valid())
+				{
+					pending.wait();
+				}
+			}
+		})};
+
+		for (auto& image : images)
+		{
+			jobs.push_back(pool->submit([&job, &image] { job(image); }));
+		}
+
+		for (auto& pending : jobs)
+		{
+			pending.get();
+		}
+	}
+
+	void read_image_header(staged_image& image, bool mips)
+	{
+		int width {}, height {}, channels {};
+		if (!stbi_info(image.path.c_str(), &width, &height, &channels) ||
+			width <= 0 || height <= 0)
+		{
+			image.width = 0;
+			return;
+		}
+
+		image.width = static_cast<uint32_t>(width);
+		image.height = static_cast<uint32_t>(height);
+		const uint32_t level_count {
+			mips ? liboceanlight::textures::mip_level_count(image.width,
+															image.height)
+				 : 1u};
+		image.levels = liboceanlight::textures::rgba_mip_levels(
+			image.width, image.height, level_count);
+
+		const auto& last {image.levels.back()};
+		image.size = last.offset + size_t {last.width} * last.height * 4;
+	}
+
+	void decode_image(staged_image& image, std::span<uint8_t> slice)
+	{
+		int width {}, height {}, channels {};
+		std::unique_ptr<stbi_uc, decltype(&stbi_image_free)> pixels {
+			stbi_load(image.path.c_str(),
+					  &width,
+					  &height,
+					  &channels,
+					  STBI_rgb_alpha),
+			&stbi_image_free};
+
+		/* The file may have changed since its header was read */
+		if (!pixels || static_cast<uint32_t>(width) != image.width ||
+			static_cast<uint32_t>(height) != image.height)
+		{
+			return;
+		}
+
+		std::memcpy(slice.data(),
+					pixels.get(),
+					size_t {image.width} * image.height * 4);
+		liboceanlight::textures::filter_mip_levels(
+			slice, image.levels, true, nullptr);
+		image.decoded = true;
+	}
+} /* namespace */
+
+void liboceanlight::textures::read_image_headers(
+	std::span<staged_image> images,
+	bool mips,
+	liboceanlight::thread_pool* pool)
+{
+	for_each_image(images, pool, [mips](staged_image& image) {
+		read_image_header(image, mips);
+	});
+
+	for (const auto& image : images)
+	{
+		if (image.width == 0)
+		{
+			std::cerr << "Failed to read the header of " << image.path
+					  << "\n";
+		}
+	}
+}
+
+size_t liboceanlight::textures::layout_image_batch(
+	std::span<staged_image> images,
+	size_t alignment)
+{
+	size_t total {0};
+	for (auto& image : images)
+	{
+		total = (total + alignment - 1) / alignment * alignment;
+		image.offset = total;
+		total += image.size;
+	}
+
+	return total;
+}
+
+void liboceanlight::textures::decode_image_batch(
+	std::span<staged_image> images,
+	std::span<uint8_t> staging,
+	liboceanlight::thread_pool* pool)
+{
+	/* Each image writes only its own slice, so the jobs never overlap */
+	for_each_image(images, pool, [staging](staged_image& image) {
+		if (image.width != 0 && !image.decoded)
+		{
+			decode_image(image, staging.subspan(image.offset, image.size));
+		}
+	});
+
+	for (const auto& image : images)
+	{
+		if (image.width != 0 && !image.decoded)
+		{
+			std::cerr << "Failed to decode " << image.path << "\n";
+		}
+	}
+}
+
+std::vector<liboceanlight::textures::image_copy_piece> liboceanlight::
+	textures::split_image_copy(std::span<const mip_level> levels,
+							   size_t size,
+							   uint32_t block_height,
+							   size_t max_bytes)
+{
+	std::vector<image_copy_piece> pieces;
+	for (size_t i {0}; i < levels.size(); ++i)
+	{
+		const auto& level {levels[i]};
+		const size_t end {i + 1 < levels.size() ? levels[i + 1].offset
+												: size};
+		const uint32_t rows {(level.height + block_height - 1) /
+							 block_height};
+		const size_t row_bytes {(end - level.offset) / rows};
+		const auto rows_per_piece {static_cast<uint32_t>(
+			std::max<size_t>(1, max_bytes / row_bytes))};
+
+		for (uint32_t row {0}; row < rows; row += rows_per_piece)
+		{
+			const uint32_t count {std::min(rows_per_piece, rows - row)};
+			const uint32_t y {row * block_height};
+			pieces.push_back({
+				.offset = level.offset + row * row_bytes,
+				.size = count * row_bytes,
+				.level = static_cast<uint32_t>(i),
+				.y = y,
+				.width = level.width,
+				.height = std::min(count * block_height, level.height - y),
+			});
+		}
+	}
+
+	return pieces;
+}
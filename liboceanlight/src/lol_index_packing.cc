@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <cstdint>
+#include <liboceanlight/lol_engine.hpp>
+#include <liboceanlight/lol_index_packing.hpp>
+#include <span>
+#include <vector>
+
+using liboceanlight::models::draw_range;
+
+std::vector<draw_range> liboceanlight::models::split_index16(
+	std::span<const uint32_t> indices)
+{
+	std::vector<draw_range> draws;
+	if (indices.empty())
+	{
+		return draws;
+	}
+
+	/* Splitting must not cut a triangle in half */
+	const size_t step {indices.size() % 3 == 0 ? 3u : indices.size()};
+	uint32_t lo {UINT32_MAX}, hi {0};
+	draw_range current {};
+
+	for (size_t i {0}; i < indices.size(); i += step)
+	{
+		const auto primitive {indices.subspan(i, step)};
+		const auto [p_lo, p_hi] {std::minmax_element(primitive.begin(),
+													 primitive.end())};
+		const uint32_t new_lo {std::min(lo, *p_lo)};
+		const uint32_t new_hi {std::max(hi, *p_hi)};
+
+		if (new_hi - new_lo >= index16_vertex_limit)
+		{
+			if (current.index_count == 0)
+			{
+				/* A single primitive spans too much, no 16 bit split */
+				return {};
+			}
+
+			current.vertex_offset = static_cast<int32_t>(lo);
+			draws.push_back(current);
+			current = {static_cast<uint32_t>(i), 0, 0};
+			lo = *p_lo;
+			hi = *p_hi;
+		}
+		else
+		{
+			lo = new_lo;
+			hi = new_hi;
+		}
+
+		current.index_count += static_cast<uint32_t>(step);
+	}
+
+	current.vertex_offset = static_cast<int32_t>(lo);
+	draws.push_back(current);
+	return draws;
+}
+
+std::vector<uint16_t> liboceanlight::models::pack_indices16(
+	std::span<const uint32_t> indices,
+	std::span<const draw_range> draws)
+{
+	std::vector<uint16_t> packed(indices.size());
+	for (const auto& draw : draws)
+	{
+		const auto base {static_cast<uint32_t>(draw.vertex_offset)};
+		for (uint32_t i {draw.first_index};
+			 i < draw.first_index + draw.index_count;
+			 ++i)
+		{
+			packed[i] = static_cast<uint16_t>(indices[i] - base);
+		}
+	}
+
+	return packed;
+}
+
+void liboceanlight::models::choose_index_type(lol_model& model,
+											  bool allow_index16,
+											  size_t max_draws)
+{
+	if (model.lods.empty())
+	{
+		model.lods = {{0, static_cast<uint32_t>(model.indices.size()), 0.0f}};
+	}
+
+	if (allow_index16)
+	{
+		/* Every level splits on its own, coarse levels index a sparse
+		 * subset of the vertices and may need more draws */
+		std::vector<draw_range> draws;
+		const std::span<const uint32_t> indices {model.indices};
+		for (auto& lod : model.lods)
+		{
+			auto lod_draws {split_index16(
+				indices.subspan(lod.first_index, lod.index_count))};
+			if (lod_draws.empty() && lod.index_count != 0)
+			{
+				draws.clear();
+				break;
+			}
+
+			lod.first_draw = static_cast<uint32_t>(draws.size());
+			lod.draw_count = static_cast<uint32_t>(lod_draws.size());
+			for (auto& draw : lod_draws)
+			{
+				draw.first_index += lod.first_index;
+				draws.push_back(draw);
+			}
+		}
+
+		if (!draws.empty() && draws.size() <= max_draws * model.lods.size())
+		{
+			model.index_type = VK_INDEX_TYPE_UINT16;
+			model.draws = std::move(draws);
+			return;
+		}
+	}
+
+	model.index_type = VK_INDEX_TYPE_UINT32;
+	model.draws.clear();
+	for (auto& lod : model.lods)
+	{
+		lod.first_draw = static_cast<uint32_t>(model.draws.size());
+		lod.draw_count = 1;
+		model.draws.push_back({lod.first_index, lod.index_count, 0});
+	}
+}
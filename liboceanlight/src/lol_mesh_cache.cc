@@ -0,0 +1,300 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <liboceanlight/lol_engine.hpp>
+#include <liboceanlight/lol_mesh_cache.hpp>
+#include <liboceanlight/lol_utility.hpp>
+#include <span>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+using liboceanlight::engine::vertex;
+using liboceanlight::models::mesh_lod;
+
+namespace
+{
+	uint64_t align_up(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	uint64_t hash_string(const std::string& str)
+	{
+		return liboceanlight::hash_bytes(std::as_bytes(std::span {str}));
+	}
+
+	uint64_t hash_file(const std::string& path)
+	{
+		liboceanlight::mapped_file file {path};
+		return liboceanlight::hash_bytes(file.bytes());
+	}
+
+	/* count items of type T at offset, checked without overflowing */
+	template <typename T>
+	bool range_fits(uint64_t offset, uint64_t count, uint64_t size)
+	{
+		return offset <= size && count <= (size - offset) / sizeof(T);
+	}
+
+	int64_t file_mtime(const std::string& path)
+	{
+		return static_cast<int64_t>(
+			fs::last_write_time(path).time_since_epoch().count());
+	}
+
+	std::string canonical_path(const std::string& path)
+	{
+		std::error_code ec {};
+		auto canonical {fs::weakly_canonical(path, ec)};
+		return ec ? path : canonical.string();
+	}
+
+	bool header_matches_source(const liboceanlight::models::mesh_cache_header&
+								   header,
+							   const std::string& source,
+							   uint64_t cook_flags,
+							   bool& mtime_changed)
+	{
+		using namespace liboceanlight::models;
+		if (header.magic != mesh_cache_magic ||
+			header.version != mesh_cache_version ||
+			header.vertex_stride != sizeof(vertex) ||
+			header.cook_flags != cook_flags ||
+			header.path_hash != hash_string(canonical_path(source)) ||
+			header.source_size != fs::file_size(source))
+		{
+			return false;
+		}
+
+		mtime_changed = header.source_mtime != file_mtime(source);
+
+		/* Same size but touched: only a content hash can tell */
+		return !mtime_changed || header.source_hash == hash_file(source);
+	}
+
+	bool ranges_valid(const liboceanlight::models::mesh_cache_header& header,
+					  size_t file_size)
+	{
+		using namespace liboceanlight::models;
+		return header.vertex_offset % mesh_cache_alignment == 0 &&
+			   header.index_offset % mesh_cache_alignment == 0 &&
+			   header.lod_offset % mesh_cache_alignment == 0 &&
+			   header.vertex_offset >= sizeof(mesh_cache_header) &&
+			   range_fits<vertex>(
+				   header.vertex_offset, header.vertex_count, file_size) &&
+			   range_fits<uint32_t>(
+				   header.index_offset, header.index_count, file_size) &&
+			   range_fits<mesh_lod>(
+				   header.lod_offset, header.lod_count, file_size);
+	}
+
+	/* The cache body has no hash, so an index past the vertices would
+	 * reach the GPU as an out of range fetch */
+	bool indices_valid(const std::vector<uint32_t>& indices,
+					   uint64_t vertex_count)
+	{
+		return std::ranges::all_of(indices, [vertex_count](uint32_t index) {
+			return index < vertex_count;
+		});
+	}
+
+	/* Unique per write, so the streaming thread and a hot reload writing
+	 * the same model do not share a temporary file */
+	std::string temp_path(const std::string& path)
+	{
+		static std::atomic<uint64_t> writes {0};
+		std::ostringstream name {};
+		name << path << '.' << std::this_thread::get_id() << '.'
+			 << writes.fetch_add(1, std::memory_order_relaxed) << ".tmp";
+		return name.str();
+	}
+
+	bool lods_valid(const std::vector<mesh_lod>& lods, uint64_t index_count)
+	{
+		return std::ranges::all_of(lods, [index_count](const auto& lod) {
+			return lod.first_index <= index_count &&
+				   lod.index_count <= index_count - lod.first_index;
+		});
+	}
+} /* namespace */
+
+std::string liboceanlight::models::mesh_cache_path(const std::string& source)
+{
+	return source + ".lolmesh";
+}
+
+liboceanlight::mapped_file liboceanlight::models::map_mesh_source(
+	const std::string& source,
+	mesh_cache_key& key)
+{
+	/* Taken first: a save after it leaves a newer mtime, which sends the
+	 * next load to the hash of what was mapped here */
+	key.source_mtime = file_mtime(source);
+	mapped_file file {source};
+	key.path_hash = hash_string(canonical_path(source));
+	key.source_size = file.bytes().size();
+	key.source_hash = hash_bytes(file.bytes());
+	return file;
+}
+
+bool liboceanlight::models::read_mesh_cache(const std::string& source,
+											uint64_t cook_flags,
+											std::vector<vertex>& vertices,
+											std::vector<uint32_t>& indices,
+											std::vector<mesh_lod>& lods)
+{
+	const std::string cache_path {mesh_cache_path(source)};
+	mesh_cache_header header {};
+	bool mtime_changed {false};
+
+	try
+	{
+		if (!fs::exists(cache_path))
+		{
+			return false;
+		}
+
+		mapped_file cache {cache_path};
+		auto bytes {cache.bytes()};
+
+		if (bytes.size() < sizeof(header))
+		{
+			return false;
+		}
+
+		std::memcpy(&header, bytes.data(), sizeof(header));
+		if (!header_matches_source(
+				header, source, cook_flags, mtime_changed) ||
+			!ranges_valid(header, bytes.size()))
+		{
+			return false;
+		}
+
+		const auto* vertex_data {static_cast<const void*>(
+			bytes.data() + header.vertex_offset)};
+		const auto* index_data {static_cast<const void*>(
+			bytes.data() + header.index_offset)};
+		const auto* lod_data {static_cast<const void*>(
+			bytes.data() + header.lod_offset)};
+
+		vertices.resize(header.vertex_count);
+		std::memcpy(vertices.data(),
+					vertex_data,
+					header.vertex_count * sizeof(vertex));
+
+		indices.resize(header.index_count);
+		std::memcpy(indices.data(),
+					index_data,
+					header.index_count * sizeof(uint32_t));
+
+		lods.resize(header.lod_count);
+		std::memcpy(lods.data(),
+					lod_data,
+					header.lod_count * sizeof(mesh_lod));
+		if (!indices_valid(indices, header.vertex_count) ||
+			!lods_valid(lods, header.index_count))
+		{
+			return false;
+		}
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "Ignoring mesh cache " << cache_path << ": " << e.what()
+				  << "\n";
+		return false;
+	}
+
+	if (mtime_changed)
+	{
+		/* Content is identical, remember the new mtime to skip hashing */
+		header.source_mtime = file_mtime(source);
+		std::fstream file {cache_path,
+						   std::ios::in | std::ios::out | std::ios::binary};
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	}
+
+	return true;
+}
+
+void liboceanlight::models::write_mesh_cache(
+	const std::string& source,
+	const mesh_cache_key& key,
+	uint64_t cook_flags,
+	const std::vector<vertex>& vertices,
+	const std::vector<uint32_t>& indices,
+	const std::vector<mesh_lod>& lods)
+{
+	const std::string cache_path {mesh_cache_path(source)};
+	const std::string tmp_path {temp_path(cache_path)};
+
+	try
+	{
+		mesh_cache_header header {};
+		header.path_hash = key.path_hash;
+		header.source_size = key.source_size;
+		header.source_mtime = key.source_mtime;
+		header.source_hash = key.source_hash;
+		header.cook_flags = cook_flags;
+		header.vertex_count = vertices.size();
+		header.vertex_offset = align_up(sizeof(header), mesh_cache_alignment);
+		header.index_count = indices.size();
+		header.index_offset = align_up(header.vertex_offset +
+										   vertices.size() * sizeof(vertex),
+									   mesh_cache_alignment);
+		header.lod_count = lods.size();
+		header.lod_offset = align_up(header.index_offset +
+										 indices.size() * sizeof(uint32_t),
+									 mesh_cache_alignment);
+
+		std::ofstream file {tmp_path, std::ios::binary | std::ios::trunc};
+		if (!file)
+		{
+			throw std::runtime_error("cannot open " + tmp_path);
+		}
+
+		const std::vector<char> padding(mesh_cache_alignment, 0);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(padding.data(),
+				   static_cast<std::streamsize>(header.vertex_offset -
+												sizeof(header)));
+		file.write(reinterpret_cast<const char*>(vertices.data()),
+				   static_cast<std::streamsize>(vertices.size() *
+												sizeof(vertex)));
+		file.write(padding.data(),
+				   static_cast<std::streamsize>(
+					   header.index_offset - header.vertex_offset -
+					   vertices.size() * sizeof(vertex)));
+		file.write(reinterpret_cast<const char*>(indices.data()),
+				   static_cast<std::streamsize>(indices.size() *
+												sizeof(uint32_t)));
+		file.write(padding.data(),
+				   static_cast<std::streamsize>(
+					   header.lod_offset - header.index_offset -
+					   indices.size() * sizeof(uint32_t)));
+		file.write(reinterpret_cast<const char*>(lods.data()),
+				   static_cast<std::streamsize>(lods.size() *
+												sizeof(mesh_lod)));
+		file.close();
+
+		if (!file)
+		{
+			throw std::runtime_error("write to " + tmp_path + " failed");
+		}
+
+		fs::rename(tmp_path, cache_path);
+	}
+	catch (const std::exception& e)
+	{
+		std::error_code ec {};
+		fs::remove(tmp_path, ec);
+		std::cerr << "Failed to write mesh cache " << cache_path << ": "
+				  << e.what() << "\n";
+	}
+}
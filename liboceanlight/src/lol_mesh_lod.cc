@@ -0,0 +1,582 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <limits>
+#include <liboceanlight/lol_engine.hpp>
+#include <liboceanlight/lol_mesh_lod.hpp>
+#include <liboceanlight/lol_mesh_optimizer.hpp>
+#include <numeric>
+#include <span>
+#include <vector>
+
+using liboceanlight::engine::vertex;
+using liboceanlight::models::mesh_lod;
+
+namespace
+{
+	/* Borders are held in place by planes through them, weighted well
+	 * above the faces so sliding along the border is the cheap move */
+	constexpr double border_weight {10.0};
+
+	enum class vertex_kind : uint8_t
+	{
+		manifold,
+		border,
+		locked
+	};
+
+	/* Symmetric 4x4 plane quadric plus the total weight it was built
+	 * from, so evaluate() gives a weighted mean squared distance */
+	struct quadric
+	{
+		double a2, b2, c2, ab, ac, bc, ad, bd, cd, d2, w;
+
+		static quadric plane(const glm::vec3& n, float d, double weight)
+		{
+			const double a {n.x}, b {n.y}, c {n.z}, e {d};
+			return {weight * a * a,
+					weight * b * b,
+					weight * c * c,
+					weight * a * b,
+					weight * a * c,
+					weight * b * c,
+					weight * a * e,
+					weight * b * e,
+					weight * c * e,
+					weight * e * e,
+					weight};
+		}
+
+		quadric& operator+=(const quadric& o)
+		{
+			a2 += o.a2;
+			b2 += o.b2;
+			c2 += o.c2;
+			ab += o.ab;
+			ac += o.ac;
+			bc += o.bc;
+			ad += o.ad;
+			bd += o.bd;
+			cd += o.cd;
+			d2 += o.d2;
+			w += o.w;
+			return *this;
+		}
+
+		double evaluate(const glm::vec3& p) const
+		{
+			const double x {p.x}, y {p.y}, z {p.z};
+			const double rx {a2 * x + ab * y + ac * z + ad};
+			const double ry {ab * x + b2 * y + bc * z + bd};
+			const double rz {ac * x + bc * y + c2 * z + cd};
+			const double r {rx * x + ry * y + rz * z + ad * x + bd * y +
+							cd * z + d2};
+			return w > 0.0 ? std::max(r, 0.0) / w : 0.0;
+		}
+	};
+
+	quadric operator+(quadric lhs, const quadric& rhs)
+	{
+		return lhs += rhs;
+	}
+
+	uint64_t edge_key(uint32_t a, uint32_t b)
+	{
+		return static_cast<uint64_t>(a) << 32 | b;
+	}
+
+	/* Vertices with bit-identical positions share a canonical index, the
+	 * first of them in vertex order */
+	std::vector<uint32_t> position_remap(std::span<const vertex> vertices)
+	{
+		std::vector<uint32_t> order(vertices.size());
+		std::iota(order.begin(), order.end(), 0u);
+
+		auto key {[&](uint32_t v) {
+			const auto& p {vertices[v].pos};
+			return std::array<float, 3> {p.x, p.y, p.z};
+		}};
+		std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+			return key(a) < key(b) || (key(a) == key(b) && a < b);
+		});
+
+		std::vector<uint32_t> remap(vertices.size());
+		for (size_t i {0}; i < order.size(); ++i)
+		{
+			const bool same {i > 0 && key(order[i]) == key(order[i - 1])};
+			remap[order[i]] = same ? remap[order[i - 1]] : order[i];
+		}
+
+		return remap;
+	}
+
+	/* Sorted directed edges in position space, an edge without its
+	 * reverse is on an open border. Sorting beats hashing here since the
+	 * set is rebuilt once per pass and only ever queried. */
+	struct edge_set
+	{
+		std::vector<uint64_t> keys;
+
+		bool contains(uint64_t key) const
+		{
+			return std::binary_search(keys.begin(), keys.end(), key);
+		}
+	};
+
+	edge_set directed_edges(std::span<const uint32_t> indices,
+							const std::vector<uint32_t>& remap)
+	{
+		edge_set edges {};
+		edges.keys.reserve(indices.size());
+		for (size_t i {0}; i < indices.size(); i += 3)
+		{
+			for (size_t e {0}; e < 3; ++e)
+			{
+				const uint32_t a {remap[indices[i + e]]};
+				const uint32_t b {remap[indices[i + (e + 1) % 3]]};
+				edges.keys.push_back(edge_key(a, b));
+			}
+		}
+
+		std::sort(edges.keys.begin(), edges.keys.end());
+		edges.keys.erase(std::unique(edges.keys.begin(), edges.keys.end()),
+						 edges.keys.end());
+		return edges;
+	}
+
+	bool is_border_edge(const edge_set& edges, uint32_t a, uint32_t b)
+	{
+		return !edges.contains(edge_key(b, a)) ||
+			   !edges.contains(edge_key(a, b));
+	}
+
+	std::vector<vertex_kind> classify_vertices(
+		std::span<const uint32_t> indices,
+		const std::vector<uint32_t>& remap)
+	{
+		std::vector<uint32_t> wedges(remap.size(), 0);
+		for (size_t v {0}; v < remap.size(); ++v)
+		{
+			++wedges[remap[v]];
+		}
+
+		const auto edges {directed_edges(indices, remap)};
+		std::vector<uint32_t> border_edges(remap.size(), 0);
+		for (auto edge : edges.keys)
+		{
+			const auto a {static_cast<uint32_t>(edge >> 32)};
+			const auto b {static_cast<uint32_t>(edge)};
+			if (!edges.contains(edge_key(b, a)))
+			{
+				++border_edges[a];
+				++border_edges[b];
+			}
+		}
+
+		std::vector<vertex_kind> kinds(remap.size(), vertex_kind::manifold);
+		for (size_t v {0}; v < remap.size(); ++v)
+		{
+			const uint32_t p {remap[v]};
+			if (wedges[p] > 1 ||
+				(border_edges[p] != 0 && border_edges[p] != 2))
+			{
+				/* Texture seams and non-manifold fans stay put */
+				kinds[v] = vertex_kind::locked;
+			}
+			else if (border_edges[p] == 2)
+			{
+				kinds[v] = vertex_kind::border;
+			}
+		}
+
+		return kinds;
+	}
+
+	/* Face quadrics per position, plus border planes */
+	std::vector<quadric> build_quadrics(std::span<const uint32_t> indices,
+										std::span<const vertex> vertices,
+										const std::vector<uint32_t>& remap)
+	{
+		std::vector<quadric> quadrics(vertices.size(), quadric {});
+		const auto edges {directed_edges(indices, remap)};
+
+		for (size_t i {0}; i < indices.size(); i += 3)
+		{
+			const std::array<uint32_t, 3> tri {remap[indices[i]],
+											   remap[indices[i + 1]],
+											   remap[indices[i + 2]]};
+			const glm::vec3 p0 {vertices[tri[0]].pos};
+			const glm::vec3 p1 {vertices[tri[1]].pos};
+			const glm::vec3 p2 {vertices[tri[2]].pos};
+
+			const glm::vec3 n {glm::cross(p1 - p0, p2 - p0)};
+			const float area2 {glm::length(n)};
+			if (area2 <= 0.0f)
+			{
+				continue;
+			}
+
+			const glm::vec3 unit {n / area2};
+			const auto face {
+				quadric::plane(unit, -glm::dot(unit, p0), 0.5 * area2)};
+			for (auto p : tri)
+			{
+				quadrics[p] += face;
+			}
+
+			for (size_t e {0}; e < 3; ++e)
+			{
+				const uint32_t a {tri[e]}, b {tri[(e + 1) % 3]};
+				if (edges.contains(edge_key(b, a)))
+				{
+					continue;
+				}
+
+				const glm::vec3 pa {vertices[a].pos}, pb {vertices[b].pos};
+				const glm::vec3 along {pb - pa};
+				const glm::vec3 side {glm::cross(along, unit)};
+				const float side_length {glm::length(side)};
+				if (side_length <= 0.0f)
+				{
+					continue;
+				}
+
+				const glm::vec3 side_unit {side / side_length};
+				const auto border {
+					quadric::plane(side_unit,
+								   -glm::dot(side_unit, pa),
+								   border_weight * glm::dot(along, along))};
+				quadrics[a] += border;
+				quadrics[b] += border;
+			}
+		}
+
+		return quadrics;
+	}
+
+	struct collapse
+	{
+		uint32_t from;
+		uint32_t to;
+		double error;
+	};
+
+	bool can_collapse(const std::vector<vertex_kind>& kinds,
+					  const edge_set& edges,
+					  const std::vector<uint32_t>& remap,
+					  uint32_t from,
+					  uint32_t to)
+	{
+		switch (kinds[from])
+		{
+		case vertex_kind::manifold:
+			return true;
+		case vertex_kind::border:
+			return kinds[to] != vertex_kind::manifold &&
+				   is_border_edge(edges, remap[from], remap[to]);
+		default:
+			return false;
+		}
+	}
+
+	/* Moving from onto to must not turn any surviving triangle over */
+	bool flips_triangles(std::span<const uint32_t> indices,
+						 std::span<const vertex> vertices,
+						 std::span<const uint32_t> triangles,
+						 uint32_t from,
+						 uint32_t to)
+	{
+		const glm::vec3 target {vertices[to].pos};
+		for (auto t : triangles)
+		{
+			const auto tri {indices.subspan(t * 3, 3)};
+			if (std::find(tri.begin(), tri.end(), to) != tri.end())
+			{
+				continue;
+			}
+
+			const size_t k {static_cast<size_t>(
+				std::find(tri.begin(), tri.end(), from) - tri.begin())};
+			const glm::vec3 p1 {vertices[tri[(k + 1) % 3]].pos};
+			const glm::vec3 p2 {vertices[tri[(k + 2) % 3]].pos};
+			const glm::vec3 p0 {vertices[from].pos};
+
+			const glm::vec3 before {glm::cross(p1 - p0, p2 - p0)};
+			const glm::vec3 after {glm::cross(p1 - target, p2 - target)};
+			if (glm::dot(before, after) <=
+				1e-2f * glm::length(before) * glm::length(after))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+} /* namespace */
+
+std::vector<uint32_t> liboceanlight::models::simplify_mesh(
+	std::span<const uint32_t> indices,
+	std::span<const vertex> vertices,
+	size_t target_index_count,
+	float max_error,
+	float& result_error)
+{
+	result_error = 0.0f;
+	std::vector<uint32_t> result {indices.begin(), indices.end()};
+	if (indices.size() % 3 != 0)
+	{
+		return result;
+	}
+
+	const auto remap {position_remap(vertices)};
+	const auto kinds {classify_vertices(indices, remap)};
+	auto quadrics {build_quadrics(indices, vertices, remap)};
+
+	const double error_limit {static_cast<double>(max_error) * max_error};
+	double worst {0.0};
+
+	while (result.size() > target_index_count)
+	{
+		const auto edges {directed_edges(result, remap)};
+
+		/* Triangles around each vertex as offsets into a flat list */
+		std::vector<uint32_t> offsets(vertices.size() + 1, 0);
+		for (auto index : result)
+		{
+			++offsets[index + 1];
+		}
+		std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+		std::vector<uint32_t> fill {offsets.begin(), offsets.end() - 1};
+		std::vector<uint32_t> adjacent(result.size());
+		for (size_t i {0}; i < result.size(); ++i)
+		{
+			adjacent[fill[result[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		/* Cheapest direction of every edge */
+		std::vector<collapse> candidates;
+		candidates.reserve(result.size());
+		for (size_t i {0}; i < result.size(); i += 3)
+		{
+			for (size_t e {0}; e < 3; ++e)
+			{
+				const uint32_t a {result[i + e]};
+				const uint32_t b {result[i + (e + 1) % 3]};
+				const auto q {quadrics[remap[a]] + quadrics[remap[b]]};
+
+				collapse best {a, b, std::numeric_limits<double>::max()};
+				if (can_collapse(kinds, edges, remap, a, b))
+				{
+					best.error = q.evaluate(vertices[b].pos);
+				}
+
+				if (can_collapse(kinds, edges, remap, b, a))
+				{
+					const double error {q.evaluate(vertices[a].pos)};
+					if (error < best.error)
+					{
+						best = {b, a, error};
+					}
+				}
+
+				if (best.error <= error_limit)
+				{
+					candidates.push_back(best);
+				}
+			}
+		}
+
+		std::sort(candidates.begin(),
+				  candidates.end(),
+				  [](const collapse& a, const collapse& b) {
+					  return a.error < b.error;
+				  });
+
+		/* Each collapse removes about two triangles. Vertices next to a
+		 * collapse wait for the next pass, so the flip test above always
+		 * sees current positions. */
+		const size_t budget {
+			std::max<size_t>(1, (result.size() - target_index_count) / 6)};
+		std::vector<uint32_t> collapsed(vertices.size());
+		std::iota(collapsed.begin(), collapsed.end(), 0u);
+		std::vector<bool> touched(vertices.size(), false);
+		size_t applied {0};
+
+		for (const auto& c : candidates)
+		{
+			if (applied >= budget)
+			{
+				break;
+			}
+
+			if (touched[c.from] || touched[c.to])
+			{
+				continue;
+			}
+
+			const std::span<const uint32_t> around {
+				adjacent.data() + offsets[c.from],
+				offsets[c.from + 1] - offsets[c.from]};
+			if (flips_triangles(result, vertices, around, c.from, c.to))
+			{
+				continue;
+			}
+
+			for (auto t : around)
+			{
+				touched[result[t * 3 + 0]] = true;
+				touched[result[t * 3 + 1]] = true;
+				touched[result[t * 3 + 2]] = true;
+			}
+
+			collapsed[c.from] = c.to;
+			quadrics[remap[c.to]] += quadrics[remap[c.from]];
+			worst = std::max(worst, c.error);
+			++applied;
+		}
+
+		if (applied == 0)
+		{
+			break;
+		}
+
+		size_t out {0};
+		for (size_t i {0}; i < result.size(); i += 3)
+		{
+			const uint32_t a {collapsed[result[i]]};
+			const uint32_t b {collapsed[result[i + 1]]};
+			const uint32_t c {collapsed[result[i + 2]]};
+			if (a != b && b != c && a != c)
+			{
+				result[out++] = a;
+				result[out++] = b;
+				result[out++] = c;
+			}
+		}
+		result.resize(out);
+	}
+
+	result_error = static_cast<float>(std::sqrt(worst));
+	return result;
+}
+
+std::vector<mesh_lod> liboceanlight::models::build_lods(
+	std::span<const vertex> vertices,
+	std::vector<uint32_t>& indices,
+	size_t max_lods)
+{
+	std::vector<mesh_lod> lods {
+		{0, static_cast<uint32_t>(indices.size()), 0.0f}};
+	std::vector<uint32_t> previous {indices};
+	float error {0.0f};
+
+	while (lods.size() < max_lods && previous.size() % 3 == 0 &&
+		   previous.size() / 3 > lod_min_triangles)
+	{
+		const size_t target {
+			static_cast<size_t>(previous.size() / 3 * lod_reduction) * 3};
+		float level_error {0.0f};
+		auto next {simplify_mesh(previous,
+								 vertices,
+								 target,
+								 std::numeric_limits<float>::max(),
+								 level_error)};
+
+		if (next.empty() ||
+			next.size() > previous.size() * lod_min_reduction)
+		{
+			break;
+		}
+
+		/* Each level starts from the one before, so errors add up */
+		error += level_error;
+		next = optimize_vertex_cache(next, vertices.size());
+		lods.push_back({static_cast<uint32_t>(indices.size()),
+						static_cast<uint32_t>(next.size()),
+						error});
+		indices.insert(indices.end(), next.begin(), next.end());
+		previous = std::move(next);
+	}
+
+	return lods;
+}
+
+glm::vec4 liboceanlight::models::mesh_bounds(std::span<const vertex> vertices)
+{
+	if (vertices.empty())
+	{
+		return glm::vec4 {0.0f};
+	}
+
+	glm::vec3 lo {vertices[0].pos}, hi {vertices[0].pos};
+	for (const auto& v : vertices)
+	{
+		lo = glm::min(lo, v.pos);
+		hi = glm::max(hi, v.pos);
+	}
+
+	const glm::vec3 center {(lo + hi) * 0.5f};
+	float radius {0.0f};
+	for (const auto& v : vertices)
+	{
+		radius = std::max(radius, glm::distance(center, v.pos));
+	}
+
+	return {center, radius};
+}
+
+size_t liboceanlight::models::select_lod(std::span<const mesh_lod> lods,
+										 const glm::vec4& bounds,
+										 const glm::mat4& model_view,
+										 float pixels_per_radian,
+										 float pixel_error)
+{
+	const glm::vec3 center {model_view * glm::vec4 {glm::vec3 {bounds}, 1.0f}};
+	const float scale {
+		std::max({glm::length(glm::vec3 {model_view[0]}),
+				  glm::length(glm::vec3 {model_view[1]}),
+				  glm::length(glm::vec3 {model_view[2]})})};
+
+	/* Nearest point of the bounding sphere, inside it nothing is coarse */
+	const float distance {glm::length(center) - bounds.w * scale};
+	if (distance <= 0.0f)
+	{
+		return 0;
+	}
+
+	size_t selected {0};
+	for (size_t i {1}; i < lods.size(); ++i)
+	{
+		const float pixels {lods[i].error * scale / distance *
+							pixels_per_radian};
+		if (pixels > pixel_error)
+		{
+			break;
+		}
+
+		selected = i;
+	}
+
+	return selected;
+}
+
+float liboceanlight::models::projected_size(const glm::vec4& bounds,
+											const glm::mat4& model_view,
+											float pixels_per_radian)
+{
+	const glm::vec3 center {model_view * glm::vec4 {glm::vec3 {bounds}, 1.0f}};
+	const float scale {
+		std::max({glm::length(glm::vec3 {model_view[0]}),
+				  glm::length(glm::vec3 {model_view[1]}),
+				  glm::length(glm::vec3 {model_view[2]})})};
+
+	const float distance {glm::length(center) - bounds.w * scale};
+	if (distance <= 0.0f)
+	{
+		return std::numeric_limits<float>::infinity();
+	}
+
+	return 2.0f * bounds.w * scale / distance * pixels_per_radian;
+}
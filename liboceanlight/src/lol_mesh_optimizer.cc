@@ -0,0 +1,447 @@
+#include <algorithm>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <liboceanlight/lol_engine.hpp>
+#include <liboceanlight/lol_mesh_optimizer.hpp>
+#include <numeric>
+#include <span>
+#include <vector>
+
+using liboceanlight::engine::vertex;
+
+namespace
+{
+	constexpr uint32_t no_vertex {~0u};
+
+	/* Triangles using each vertex, as offsets into a flat list */
+	struct adjacency
+	{
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> triangles;
+	};
+
+	adjacency build_adjacency(std::span<const uint32_t> indices,
+							  size_t vertex_count)
+	{
+		adjacency adj {};
+		adj.offsets.assign(vertex_count + 1, 0);
+		for (auto index : indices)
+		{
+			++adj.offsets[index + 1];
+		}
+
+		std::partial_sum(adj.offsets.begin(),
+						 adj.offsets.end(),
+						 adj.offsets.begin());
+
+		std::vector<uint32_t> fill {adj.offsets.begin(),
+									adj.offsets.end() - 1};
+		adj.triangles.resize(indices.size());
+		for (size_t i {0}; i < indices.size(); ++i)
+		{
+			adj.triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		return adj;
+	}
+
+	/* FIFO cache simulated with timestamps: a vertex is resident while
+	 * fewer than cache_size misses happened since it was loaded */
+	struct fifo_cache
+	{
+		std::vector<uint32_t> timestamps;
+		uint32_t time;
+		unsigned int size;
+
+		fifo_cache(size_t vertex_count, unsigned int cache_size) :
+			timestamps(vertex_count, 0), time {cache_size + 1},
+			size {cache_size}
+		{
+		}
+
+		unsigned int access(uint32_t index)
+		{
+			if (time - timestamps[index] > size)
+			{
+				timestamps[index] = time++;
+				return 1;
+			}
+
+			return 0;
+		}
+
+		void flush()
+		{
+			time += size + 1;
+		}
+	};
+
+	/* Tipsify's dead-end fallback: the most recently emitted vertex that
+	 * still has live triangles, else the next one in input order */
+	uint32_t next_dead_end(std::vector<uint32_t>& dead_end,
+						   size_t& cursor,
+						   const std::vector<uint32_t>& live)
+	{
+		while (!dead_end.empty())
+		{
+			const uint32_t v {dead_end.back()};
+			dead_end.pop_back();
+			if (live[v] > 0)
+			{
+				return v;
+			}
+		}
+
+		for (; cursor < live.size(); ++cursor)
+		{
+			if (live[cursor] > 0)
+			{
+				return static_cast<uint32_t>(cursor);
+			}
+		}
+
+		return no_vertex;
+	}
+
+	/* Cluster starts (in triangles) where the cache ran cold: every
+	 * corner of the triangle missed */
+	std::vector<uint32_t> hard_boundaries(std::span<const uint32_t> indices,
+										  size_t vertex_count,
+										  unsigned int cache_size)
+	{
+		std::vector<uint32_t> boundaries;
+		fifo_cache cache {vertex_count, cache_size};
+
+		for (size_t t {0}; t < indices.size() / 3; ++t)
+		{
+			const unsigned int misses {cache.access(indices[t * 3 + 0]) +
+									   cache.access(indices[t * 3 + 1]) +
+									   cache.access(indices[t * 3 + 2])};
+			if (t == 0 || misses == 3)
+			{
+				boundaries.push_back(static_cast<uint32_t>(t));
+			}
+		}
+
+		return boundaries;
+	}
+
+	/* Split hard clusters further wherever the running ACMR is already
+	 * within threshold of the cluster's own, which gives the sort more
+	 * freedom at a bounded vertex cache cost */
+	std::vector<uint32_t> soft_boundaries(std::span<const uint32_t> indices,
+										  size_t vertex_count,
+										  std::span<const uint32_t> hard,
+										  float threshold,
+										  unsigned int cache_size)
+	{
+		std::vector<uint32_t> boundaries;
+		fifo_cache cache {vertex_count, cache_size};
+		const auto triangle_count {static_cast<uint32_t>(indices.size() / 3)};
+
+		auto misses {[&](uint32_t t) {
+			return cache.access(indices[t * 3 + 0]) +
+				   cache.access(indices[t * 3 + 1]) +
+				   cache.access(indices[t * 3 + 2]);
+		}};
+
+		for (size_t c {0}; c < hard.size(); ++c)
+		{
+			const uint32_t begin {hard[c]};
+			const uint32_t end {c + 1 < hard.size() ? hard[c + 1]
+													: triangle_count};
+
+			cache.flush();
+			size_t cluster_misses {0};
+			for (uint32_t t {begin}; t < end; ++t)
+			{
+				cluster_misses += misses(t);
+			}
+
+			const double limit {threshold * static_cast<double>(
+												cluster_misses) /
+								static_cast<double>(end - begin)};
+
+			cache.flush();
+			boundaries.push_back(begin);
+			size_t running_misses {0};
+			size_t running_triangles {0};
+			for (uint32_t t {begin}; t < end; ++t)
+			{
+				running_misses += misses(t);
+				++running_triangles;
+
+				if (t + 1 < end && static_cast<double>(running_misses) <=
+									   limit * running_triangles)
+				{
+					boundaries.push_back(t + 1);
+					cache.flush();
+					running_misses = 0;
+					running_triangles = 0;
+				}
+			}
+		}
+
+		return boundaries;
+	}
+} /* namespace */
+
+liboceanlight::models::vertex_cache_stats liboceanlight::models::
+	analyze_vertex_cache(std::span<const uint32_t> indices,
+						 size_t vertex_count,
+						 unsigned int cache_size)
+{
+	vertex_cache_stats stats {};
+	fifo_cache cache {vertex_count, cache_size};
+	std::vector<bool> used(vertex_count, false);
+
+	for (auto index : indices)
+	{
+		stats.transforms += cache.access(index);
+		if (!used[index])
+		{
+			used[index] = true;
+			++stats.vertices;
+		}
+	}
+
+	stats.triangles = indices.size() / 3;
+	return stats;
+}
+
+double liboceanlight::models::acmr(const vertex_cache_stats& stats)
+{
+	return stats.triangles ? static_cast<double>(stats.transforms) /
+								 static_cast<double>(stats.triangles)
+						   : 0.0;
+}
+
+double liboceanlight::models::atvr(const vertex_cache_stats& stats)
+{
+	return stats.vertices ? static_cast<double>(stats.transforms) /
+								static_cast<double>(stats.vertices)
+						  : 0.0;
+}
+
+/* Tipsify (Sander, Nehab, Barczak 2007): fan around a vertex, then move to
+ * the candidate that will still be in cache after its remaining triangles
+ * are emitted, falling back to recently used vertices on a dead end */
+std::vector<uint32_t> liboceanlight::models::optimize_vertex_cache(
+	std::span<const uint32_t> indices,
+	size_t vertex_count,
+	unsigned int cache_size)
+{
+	std::vector<uint32_t> result;
+	if (indices.empty() || vertex_count == 0)
+	{
+		return result;
+	}
+
+	result.reserve(indices.size());
+	const auto adj {build_adjacency(indices, vertex_count)};
+
+	std::vector<uint32_t> live(vertex_count);
+	for (size_t v {0}; v < vertex_count; ++v)
+	{
+		live[v] = adj.offsets[v + 1] - adj.offsets[v];
+	}
+
+	std::vector<uint32_t> timestamps(vertex_count, 0);
+	std::vector<bool> emitted(indices.size() / 3, false);
+	std::vector<uint32_t> dead_end;
+	std::vector<uint32_t> candidates;
+	uint32_t time {cache_size + 1};
+	size_t cursor {0};
+	uint32_t fan {0};
+
+	while (fan != no_vertex)
+	{
+		candidates.clear();
+		for (auto i {adj.offsets[fan]}; i < adj.offsets[fan + 1]; ++i)
+		{
+			const uint32_t t {adj.triangles[i]};
+			if (emitted[t])
+			{
+				continue;
+			}
+
+			for (size_t k {0}; k < 3; ++k)
+			{
+				const uint32_t v {indices[t * 3 + k]};
+				result.push_back(v);
+				dead_end.push_back(v);
+				candidates.push_back(v);
+				--live[v];
+
+				if (time - timestamps[v] > cache_size)
+				{
+					timestamps[v] = time++;
+				}
+			}
+
+			emitted[t] = true;
+		}
+
+		uint32_t best {no_vertex};
+		int best_priority {-1};
+		for (auto v : candidates)
+		{
+			if (live[v] == 0)
+			{
+				continue;
+			}
+
+			/* Prefer the oldest vertex that stays resident while its
+			 * remaining fan is emitted */
+			int priority {0};
+			if (time - timestamps[v] + 2 * live[v] <= cache_size)
+			{
+				priority = static_cast<int>(time - timestamps[v]);
+			}
+
+			if (priority > best_priority)
+			{
+				best = v;
+				best_priority = priority;
+			}
+		}
+
+		fan = best != no_vertex ? best
+								: next_dead_end(dead_end, cursor, live);
+	}
+
+	return result;
+}
+
+/* Sander, Nehab, Barczak 2007 section 4: sort vertex cache friendly
+ * clusters so that outward facing ones on the far side of the centroid
+ * draw first and occlude the rest */
+std::vector<uint32_t> liboceanlight::models::optimize_overdraw(
+	std::span<const uint32_t> indices,
+	std::span<const vertex> vertices,
+	float threshold,
+	unsigned int cache_size)
+{
+	const auto triangle_count {static_cast<uint32_t>(indices.size() / 3)};
+	if (triangle_count == 0)
+	{
+		return {indices.begin(), indices.end()};
+	}
+
+	const auto hard {hard_boundaries(indices, vertices.size(), cache_size)};
+	const auto clusters {soft_boundaries(
+		indices, vertices.size(), hard, threshold, cache_size)};
+
+	glm::vec3 mesh_centroid {0.0f, 0.0f, 0.0f};
+	float mesh_area {0.0f};
+	std::vector<glm::vec3> cluster_centroids(clusters.size());
+	std::vector<glm::vec3> cluster_normals(clusters.size());
+
+	for (size_t c {0}; c < clusters.size(); ++c)
+	{
+		const uint32_t end {c + 1 < clusters.size() ? clusters[c + 1]
+													: triangle_count};
+		glm::vec3 centroid {0.0f, 0.0f, 0.0f};
+		glm::vec3 normal {0.0f, 0.0f, 0.0f};
+		float area {0.0f};
+
+		for (uint32_t t {clusters[c]}; t < end; ++t)
+		{
+			const glm::vec3 a {vertices[indices[t * 3 + 0]].pos};
+			const glm::vec3 b {vertices[indices[t * 3 + 1]].pos};
+			const glm::vec3 d {vertices[indices[t * 3 + 2]].pos};
+
+			/* Area weighted, so slivers do not skew the cluster */
+			const glm::vec3 cross {glm::cross(b - a, d - a)};
+			const float tri_area {glm::length(cross)};
+
+			centroid += (a + b + d) * (tri_area / 3.0f);
+			normal += cross;
+			area += tri_area;
+		}
+
+		mesh_centroid += centroid;
+		mesh_area += area;
+		cluster_centroids[c] = area > 0.0f ? centroid / area : centroid;
+		const float normal_length {glm::length(normal)};
+		cluster_normals[c] = normal_length > 0.0f ? normal / normal_length
+												  : normal;
+	}
+
+	if (mesh_area > 0.0f)
+	{
+		mesh_centroid /= mesh_area;
+	}
+
+	std::vector<float> sort_keys(clusters.size());
+	for (size_t c {0}; c < clusters.size(); ++c)
+	{
+		sort_keys[c] = glm::dot(cluster_centroids[c] - mesh_centroid,
+								cluster_normals[c]);
+	}
+
+	std::vector<uint32_t> order(clusters.size());
+	std::iota(order.begin(), order.end(), 0u);
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t l, uint32_t r) {
+		return sort_keys[l] > sort_keys[r];
+	});
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	for (auto c : order)
+	{
+		const uint32_t end {c + 1 < clusters.size() ? clusters[c + 1]
+													: triangle_count};
+		result.insert(result.end(),
+					  indices.begin() + clusters[c] * 3,
+					  indices.begin() + end * 3);
+	}
+
+	return result;
+}
+
+/* Renumber vertices in first use order so vertex fetch walks memory
+ * forwards; unreferenced vertices are dropped */
+void liboceanlight::models::optimize_vertex_fetch(
+	std::vector<vertex>& vertices,
+	std::vector<uint32_t>& indices)
+{
+	std::vector<uint32_t> remap(vertices.size(), no_vertex);
+	std::vector<vertex> reordered;
+	reordered.reserve(vertices.size());
+
+	for (auto& index : indices)
+	{
+		if (remap[index] == no_vertex)
+		{
+			remap[index] = static_cast<uint32_t>(reordered.size());
+			reordered.push_back(vertices[index]);
+		}
+
+		index = remap[index];
+	}
+
+	vertices = std::move(reordered);
+}
+
+liboceanlight::models::mesh_optimize_stats liboceanlight::models::
+	optimize_mesh(std::vector<vertex>& vertices,
+				  std::vector<uint32_t>& indices)
+{
+	mesh_optimize_stats stats {};
+	stats.before = analyze_vertex_cache(indices, vertices.size());
+
+	/* Only triangle lists can be reordered by triangle */
+	if (indices.size() % 3 != 0)
+	{
+		stats.after = stats.before;
+		return stats;
+	}
+
+	indices = optimize_vertex_cache(indices, vertices.size());
+	indices = optimize_overdraw(indices, vertices);
+	optimize_vertex_fetch(vertices, indices);
+
+	stats.after = analyze_vertex_cache(indices, vertices.size());
+	return stats;
+}
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <future>
+#include <liboceanlight/lol_mipmap.hpp>
+#include <liboceanlight/lol_thread_pool.hpp>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+using liboceanlight::textures::mip_chain;
+using liboceanlight::textures::mip_level;
+
+namespace
+{
+	/* Destination rows per pool job, smaller levels stay on the caller */
+	constexpr uint32_t rows_per_job {64};
+
+	/* Linear values are looked up at 12 bits, finer than an 8 bit sRGB
+	 * step everywhere but the darkest few codes */
+	constexpr size_t linear_steps {4096};
+
+	using srgb_tables = struct lol_srgb_tables_struct
+	{
+		std::array<float, 256> to_linear;
+		std::array<uint8_t, linear_steps> to_srgb;
+	};
+
+	const srgb_tables& get_srgb_tables()
+	{
+		static const srgb_tables tables {[] {
+			srgb_tables t {};
+			for (size_t i {0}; i < t.to_linear.size(); ++i)
+			{
+				const float c {static_cast<float>(i) / 255.0f};
+				t.to_linear[i] = c <= 0.04045f
+									 ? c / 12.92f
+									 : std::pow((c + 0.055f) / 1.055f, 2.4f);
+			}
+
+			for (size_t i {0}; i < t.to_srgb.size(); ++i)
+			{
+				const float l {static_cast<float>(i) / (linear_steps - 1)};
+				const float c {l <= 0.0031308f
+								   ? l * 12.92f
+								   : 1.055f * std::pow(l, 1.0f / 2.4f) -
+										 0.055f};
+				t.to_srgb[i] = static_cast<uint8_t>(std::lround(c * 255.0f));
+			}
+
+			return t;
+		}()};
+		return tables;
+	}
+
+	/* Rows [first_row, last_row) of dst from the 2x2 blocks above them.
+	 * Odd source edges repeat their last texel. */
+	void downsample_rows(const uint8_t* src,
+						 const mip_level& src_level,
+						 uint8_t* dst,
+						 const mip_level& dst_level,
+						 uint32_t first_row,
+						 uint32_t last_row,
+						 bool srgb)
+	{
+		const auto& tables {get_srgb_tables()};
+		const size_t src_pitch {size_t {src_level.width} * 4};
+		const float to_step {(linear_steps - 1) / 4.0f};
+
+		for (uint32_t y {first_row}; y < last_row; ++y)
+		{
+			const uint8_t* row0 {
+				src + std::min(2 * y, src_level.height - 1) * src_pitch};
+			const uint8_t* row1 {
+				src + std::min(2 * y + 1, src_level.height - 1) * src_pitch};
+			uint8_t* out {dst + size_t {y} * dst_level.width * 4};
+
+			for (uint32_t x {0}; x < dst_level.width; ++x)
+			{
+				const size_t x0 {std::min(2 * x, src_level.width - 1) * 4ull};
+				const size_t x1 {
+					std::min(2 * x + 1, src_level.width - 1) * 4ull};
+
+				for (size_t c {0}; c < 4; ++c)
+				{
+					if (srgb && c < 3)
+					{
+						const float sum {tables.to_linear[row0[x0 + c]] +
+										 tables.to_linear[row0[x1 + c]] +
+										 tables.to_linear[row1[x0 + c]] +
+										 tables.to_linear[row1[x1 + c]]};
+						out[x * 4 + c] = tables.to_srgb[static_cast<size_t>(
+							sum * to_step + 0.5f)];
+						continue;
+					}
+
+					out[x * 4 + c] = static_cast<uint8_t>(
+						(row0[x0 + c] + row0[x1 + c] + row1[x0 + c] +
+						 row1[x1 + c] + 2) /
+						4);
+				}
+			}
+		}
+	}
+} /* namespace */
+
+uint32_t liboceanlight::textures::mip_level_count(uint32_t width,
+												  uint32_t height)
+{
+	return std::max(1u,
+					static_cast<uint32_t>(std::bit_width(
+						std::max(width, height))));
+}
+
+std::vector<mip_level> liboceanlight::textures::rgba_mip_levels(
+	uint32_t width,
+	uint32_t height,
+	uint32_t level_count)
+{
+	std::vector<mip_level> levels;
+	size_t total_bytes {0};
+	for (uint32_t i {0}; i < level_count; ++i)
+	{
+		levels.push_back({total_bytes, width, height});
+		total_bytes += size_t {width} * height * 4;
+		width = std::max(width / 2, 1u);
+		height = std::max(height / 2, 1u);
+	}
+
+	return levels;
+}
+
+void liboceanlight::textures::filter_mip_levels(
+	std::span<uint8_t> pixels,
+	std::span<const mip_level> levels,
+	bool srgb,
+	liboceanlight::thread_pool* pool)
+{
+	/* Each level reads the one before, so only rows run in parallel */
+	for (size_t i {1}; i < levels.size(); ++i)
+	{
+		const mip_level& src_level {levels[i - 1]};
+		const mip_level& dst_level {levels[i]};
+		const uint8_t* src {pixels.data() + src_level.offset};
+		uint8_t* dst {pixels.data() + dst_level.offset};
+
+		if (!pool || dst_level.height <= rows_per_job)
+		{
+			downsample_rows(
+				src, src_level, dst, dst_level, 0, dst_level.height, srgb);
+			continue;
+		}
+
+		std::vector<std::future<void>> jobs;
+		for (uint32_t row {0}; row < dst_level.height; row += rows_per_job)
+		{
+			const uint32_t last {
+				std::min(row + rows_per_job, dst_level.height)};
+			jobs.push_back(pool->submit([=, &src_level, &dst_level] {
+				downsample_rows(
+					src, src_level, dst, dst_level, row, last, srgb);
+			}));
+		}
+
+		for (auto& job : jobs)
+		{
+			job.get();
+		}
+	}
+}
+
+mip_chain liboceanlight::textures::build_mip_chain(
+	std::span<const uint8_t> rgba,
+	uint32_t width,
+	uint32_t height,
+	bool srgb,
+	liboceanlight::thread_pool* pool)
+{
+	if (width == 0 || height == 0 ||
+		rgba.size() != size_t {width} * height * 4)
+	{
+		throw std::runtime_error("Mip chain source does not match its size");
+	}
+
+	mip_chain chain {};
+	chain.levels = rgba_mip_levels(
+		width, height, mip_level_count(width, height));
+	const auto& last {chain.levels.back()};
+	chain.pixels.resize(last.offset + size_t {last.width} * last.height * 4);
+	std::copy(rgba.begin(), rgba.end(), chain.pixels.begin());
+
+	filter_mip_levels(chain.pixels, chain.levels, srgb, pool);
+	return chain;
+}
@@ -0,0 +1,426 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <gsl/gsl>
+#include <iomanip>
+#include <iostream>
+#include <liboceanlight/lol_engine.hpp>
+#include <liboceanlight/lol_gltf.hpp>
+#include <liboceanlight/lol_mesh_cache.hpp>
+#include <liboceanlight/lol_mesh_lod.hpp>
+#include <liboceanlight/lol_mesh_optimizer.hpp>
+#include <liboceanlight/lol_models.hpp>
+#include <liboceanlight/lol_obj_parser.hpp>
+#include <liboceanlight/lol_thread_pool.hpp>
+#include <liboceanlight/lol_utility.hpp>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace fs = std::filesystem;
+using liboceanlight::engine::vertex;
+using liboceanlight::models::lol_model;
+using liboceanlight::models::obj_chunk;
+
+namespace
+{
+	using clock_type = std::chrono::high_resolution_clock;
+
+	struct mesh_part
+	{
+		std::vector<vertex> vertices;
+		std::vector<uint32_t> indices;
+		std::vector<liboceanlight::models::mesh_lod> lods;
+		double ms {0.0};
+	};
+
+	/* OBJ files stay mapped and are split into ranges for the chunk
+	 * parse stage, cache hits and already indexed glTF files go
+	 * straight to cooked. The key is of the bytes that were parsed. */
+	struct parsed_model
+	{
+		liboceanlight::mapped_file obj_file;
+		std::vector<std::span<const std::byte>> obj_ranges;
+		liboceanlight::models::mesh_cache_key key;
+		bool cached {false};
+		bool indexed {false};
+		mesh_part cooked;
+		double ms {0.0};
+	};
+
+	bool is_gltf(const fs::path& path)
+	{
+		return path.extension() == ".gltf" || path.extension() == ".glb";
+	}
+
+	double elapsed_ms(clock_type::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(clock_type::now() -
+														 start)
+			.count();
+	}
+
+	template <typename F>
+	auto dispatch(liboceanlight::thread_pool* pool, F&& func)
+	{
+		if (pool)
+		{
+			return pool->submit(std::forward<F>(func));
+		}
+
+		return std::async(std::launch::deferred, std::forward<F>(func));
+	}
+
+	uint64_t cook_flags(const liboceanlight::models::load_options& options)
+	{
+		using namespace liboceanlight::models;
+		return (options.optimize ? mesh_cook_optimized : 0) |
+			   (options.lods ? mesh_cook_lods : 0);
+	}
+
+	void add_cache_stats(liboceanlight::models::vertex_cache_stats& total,
+						 const liboceanlight::models::vertex_cache_stats& part)
+	{
+		total.triangles += part.triangles;
+		total.vertices += part.vertices;
+		total.transforms += part.transforms;
+	}
+
+	/* Without a pool the jobs are deferred and never started, so only
+	 * the ones running on the pool are waited for */
+	template <typename T>
+	void wait_pending(std::vector<std::future<T>>& jobs)
+	{
+		for (auto& job : jobs)
+		{
+			if (job.valid() && job.wait_for(std::chrono::seconds {0}) !=
+								   std::future_status::deferred)
+			{
+				job.wait();
+			}
+		}
+	}
+
+	/* Keyed for the cache only when there is one to write */
+	liboceanlight::mapped_file map_source(
+		const std::string& path,
+		const liboceanlight::models::load_options& options,
+		parsed_model& parsed)
+	{
+		return options.use_cache
+				   ? liboceanlight::models::map_mesh_source(path, parsed.key)
+				   : liboceanlight::mapped_file {path};
+	}
+
+	parsed_model open_model(const std::string& path,
+							const liboceanlight::models::load_options& options)
+	{
+		auto start {clock_type::now()};
+		parsed_model parsed {};
+
+		if (options.use_cache && liboceanlight::models::read_mesh_cache(
+									 path,
+									 cook_flags(options),
+									 parsed.cooked.vertices,
+									 parsed.cooked.indices,
+									 parsed.cooked.lods))
+		{
+			parsed.cached = true;
+		}
+		else if (is_gltf(path))
+		{
+			const auto file {map_source(path, options, parsed)};
+			liboceanlight::models::load_gltf(path,
+											 file.bytes(),
+											 parsed.cooked.vertices,
+											 parsed.cooked.indices);
+			parsed.indexed = true;
+		}
+		else
+		{
+			parsed.obj_file = map_source(path, options, parsed);
+			parsed.obj_ranges = liboceanlight::models::split_obj_chunks(
+				parsed.obj_file.bytes(), options.split_bytes);
+		}
+
+		parsed.ms = elapsed_ms(start);
+		return parsed;
+	}
+
+	struct parsed_chunk
+	{
+		obj_chunk chunk;
+		double ms {0.0};
+	};
+} /* namespace */
+
+bool liboceanlight::models::is_model_file(const std::string& path)
+{
+	return fs::path {path}.extension() == ".obj" || is_gltf(path);
+}
+
+std::vector<std::string> liboceanlight::models::find_model_files(
+	const std::string& dir)
+{
+	std::vector<std::string> files;
+	for (const auto& file : fs::directory_iterator(dir))
+	{
+		if (file.is_regular_file() && is_model_file(file.path().string()))
+		{
+			files.push_back(file.path().filename().string());
+		}
+	}
+
+	/* directory_iterator order is unspecified, keep model_list stable */
+	std::sort(files.begin(), files.end());
+	return files;
+}
+
+liboceanlight::models::load_stats liboceanlight::models::load_model_files(
+	const std::vector<std::string>& paths,
+	std::vector<lol_model>& models,
+	const load_options& options)
+{
+	auto start {clock_type::now()};
+	auto* pool {options.pool};
+	load_stats stats {};
+	stats.threads = pool ? pool->size() : 1;
+
+	/* Jobs read the locals below and the models, so when one throws the
+	 * others are waited for before they are unwound */
+	std::vector<parsed_model> parsed(paths.size());
+	std::vector<std::vector<obj_chunk>> chunks(paths.size());
+	std::vector<double> optimize_ms(paths.size(), 0.0);
+	std::vector<std::future<parsed_model>> open_jobs;
+	std::vector<std::vector<std::future<parsed_chunk>>> chunk_jobs(
+		paths.size());
+	std::vector<std::future<mesh_part>> weld_jobs(paths.size());
+	std::vector<std::future<liboceanlight::models::mesh_optimize_stats>>
+		optimize_jobs(paths.size());
+	std::vector<std::future<double>> cache_jobs;
+	const auto wait_jobs {gsl::finally([&] {
+		wait_pending(open_jobs);
+		for (auto& jobs : chunk_jobs)
+		{
+			wait_pending(jobs);
+		}
+		wait_pending(weld_jobs);
+		wait_pending(optimize_jobs);
+		wait_pending(cache_jobs);
+	})};
+
+	open_jobs.reserve(paths.size());
+	for (const auto& path : paths)
+	{
+		open_jobs.push_back(dispatch(pool, [&path, &options] {
+			return open_model(path, options);
+		}));
+	}
+
+	for (size_t i {0}; i < paths.size(); ++i)
+	{
+		parsed[i] = open_jobs[i].get();
+		stats.work_ms += parsed[i].ms;
+	}
+
+	/* Every chunk of every OBJ file is parsed in parallel, big files
+	 * no longer serialize the stage */
+	for (size_t i {0}; i < paths.size(); ++i)
+	{
+		for (auto range : parsed[i].obj_ranges)
+		{
+			chunk_jobs[i].push_back(dispatch(pool, [range, &path = paths[i]] {
+				auto chunk_start {clock_type::now()};
+				parsed_chunk result {
+					liboceanlight::models::parse_obj_chunk(range, path)};
+				result.ms = elapsed_ms(chunk_start);
+				return result;
+			}));
+		}
+	}
+
+	/* Welding needs a whole file's chunks in order. Collecting them
+	 * here rather than in a pool job means no worker ever blocks on
+	 * another, and file i welds while later files still parse. */
+	for (size_t i {0}; i < paths.size(); ++i)
+	{
+		if (chunk_jobs[i].empty())
+		{
+			continue;
+		}
+
+		for (auto& job : chunk_jobs[i])
+		{
+			auto result {job.get()};
+			stats.work_ms += result.ms;
+			chunks[i].push_back(std::move(result.chunk));
+		}
+
+		parsed[i].obj_file = {};
+
+		weld_jobs[i] = dispatch(pool, [&file_chunks = chunks[i],
+									   &path = paths[i]] {
+			auto weld_start {clock_type::now()};
+			mesh_part part {};
+			liboceanlight::models::weld_obj_chunks(
+				file_chunks, path, part.vertices, part.indices);
+
+			/* Parsed chunks are no longer needed, free them early */
+			std::vector<obj_chunk> {}.swap(file_chunks);
+			part.ms = elapsed_ms(weld_start);
+			return part;
+		});
+	}
+
+	const size_t first_model {models.size()};
+	models.reserve(models.size() + paths.size());
+	for (size_t i {0}; i < paths.size(); ++i)
+	{
+		auto& model {models.emplace_back()};
+		model.name = fs::path(paths[i]).filename().string();
+
+		if (parsed[i].cached || parsed[i].indexed)
+		{
+			model.vertices = std::move(parsed[i].cooked.vertices);
+			model.indices = std::move(parsed[i].cooked.indices);
+			model.lods = std::move(parsed[i].cooked.lods);
+			stats.cache_hits += parsed[i].cached ? 1 : 0;
+		}
+		else if (weld_jobs[i].valid())
+		{
+			auto part {weld_jobs[i].get()};
+			stats.work_ms += part.ms;
+			model.vertices = std::move(part.vertices);
+			model.indices = std::move(part.indices);
+		}
+	}
+
+	for (size_t i {0}; i < paths.size(); ++i)
+	{
+		if (!(options.optimize || options.lods) || parsed[i].cached)
+		{
+			continue;
+		}
+
+		/* Levels index the optimized vertices, so they are built after */
+		auto& model {models[first_model + i]};
+		optimize_jobs[i] = dispatch(
+			pool, [&model, &options, &ms = optimize_ms[i]] {
+				auto optimize_start {clock_type::now()};
+				liboceanlight::models::mesh_optimize_stats result {};
+				if (options.optimize)
+				{
+					result = liboceanlight::models::optimize_mesh(
+						model.vertices, model.indices);
+				}
+
+				if (options.lods)
+				{
+					model.lods = liboceanlight::models::build_lods(
+						model.vertices, model.indices);
+				}
+
+				ms = elapsed_ms(optimize_start);
+				return result;
+			});
+	}
+
+	for (size_t i {0}; i < paths.size(); ++i)
+	{
+		auto& model {models[first_model + i]};
+		std::cout << "Loaded model \"" << model.name << "\"";
+
+		const auto result {
+			optimize_jobs[i].valid()
+				? optimize_jobs[i].get()
+				: liboceanlight::models::mesh_optimize_stats {}};
+		stats.work_ms += optimize_ms[i];
+		model.bounds = liboceanlight::models::mesh_bounds(model.vertices);
+
+		if (!parsed[i].cached && options.optimize)
+		{
+			add_cache_stats(stats.cache_before, result.before);
+			add_cache_stats(stats.cache_after, result.after);
+			++stats.optimized_count;
+
+			std::cout << std::fixed << std::setprecision(2) << " (ACMR "
+					  << acmr(result.before) << " -> " << acmr(result.after)
+					  << ", ATVR " << atvr(result.before) << " -> "
+					  << atvr(result.after) << ")" << std::defaultfloat;
+		}
+
+		if (model.lods.size() > 1)
+		{
+			std::cout << " (" << model.lods.size() << " LODs, "
+					  << model.lods.back().index_count / 3
+					  << " triangles at error " << model.lods.back().error
+					  << ")";
+			stats.lod_count += model.lods.size() - 1;
+		}
+
+		std::cout << (parsed[i].cached ? " (cached)\n" : "\n");
+		stats.vertex_count += model.vertices.size();
+		stats.index_count += model.indices.size();
+		++stats.model_count;
+	}
+
+	if (options.use_cache)
+	{
+		for (size_t i {0}; i < paths.size(); ++i)
+		{
+			if (parsed[i].cached)
+			{
+				continue;
+			}
+
+			const auto& model {models[first_model + i]};
+			cache_jobs.push_back(dispatch(
+				pool,
+				[&path = paths[i], &key = parsed[i].key, &model, &options] {
+					auto cache_start {clock_type::now()};
+					write_mesh_cache(path,
+									 key,
+									 cook_flags(options),
+									 model.vertices,
+									 model.indices,
+									 model.lods);
+					return elapsed_ms(cache_start);
+				}));
+		}
+
+		for (auto& job : cache_jobs)
+		{
+			stats.work_ms += job.get();
+		}
+	}
+
+	stats.wall_ms = elapsed_ms(start);
+	return stats;
+}
+
+void liboceanlight::models::print_load_stats(const load_stats& stats)
+{
+	const double speedup {stats.wall_ms > 0.0 ? stats.work_ms / stats.wall_ms
+											  : 1.0};
+
+	std::cout << std::fixed << std::setprecision(1) << "Loaded "
+			  << stats.model_count << " models (" << stats.vertex_count
+			  << " vertices, " << stats.index_count << " indices) in "
+			  << stats.wall_ms << " ms on " << stats.threads << " threads ("
+			  << stats.work_ms << " ms of work, " << std::setprecision(2)
+			  << speedup << "x speedup, " << stats.cache_hits
+			  << " from mesh cache)\n";
+
+	if (stats.optimized_count > 0)
+	{
+		std::cout << "Optimized " << stats.optimized_count
+				  << " models for a " << vertex_cache_size
+				  << " entry vertex cache: ACMR " << acmr(stats.cache_before)
+				  << " -> " << acmr(stats.cache_after) << ", ATVR "
+				  << atvr(stats.cache_before) << " -> "
+				  << atvr(stats.cache_after) << "\n";
+	}
+
+	std::cout << std::defaultfloat;
+}
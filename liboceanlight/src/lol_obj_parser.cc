@@ -0,0 +1,318 @@
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <liboceanlight/lol_engine.hpp>
+#include <liboceanlight/lol_obj_parser.hpp>
+#include <liboceanlight/lol_utility.hpp>
+#include <liboceanlight/lol_vertex_welder.hpp>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+using liboceanlight::engine::vertex;
+using liboceanlight::models::obj_chunk;
+using liboceanlight::models::obj_corner;
+using liboceanlight::models::obj_no_texcoord;
+
+namespace
+{
+	/* Cursor over one line, never reads past end */
+	struct line_reader
+	{
+		const char* pos;
+		const char* end;
+
+		void skip_space()
+		{
+			while (pos < end && (*pos == ' ' || *pos == '\t'))
+			{
+				++pos;
+			}
+		}
+
+		bool done()
+		{
+			skip_space();
+			return pos == end;
+		}
+
+		float read_float()
+		{
+			skip_space();
+
+			/* from_chars rejects a leading plus sign */
+			if (pos < end && *pos == '+')
+			{
+				++pos;
+			}
+
+			float value {0.0f};
+			const auto [ptr, ec] {std::from_chars(pos, end, value)};
+			if (ec != std::errc {})
+			{
+				throw std::runtime_error("Malformed number");
+			}
+
+			pos = ptr;
+			return value;
+		}
+
+		/* 0 when the field is empty, as in the middle of "1//2" */
+		int32_t read_index()
+		{
+			int32_t value {0};
+			const auto [ptr, ec] {std::from_chars(pos, end, value)};
+			if (ec == std::errc::invalid_argument)
+			{
+				return 0;
+			}
+
+			if (ec != std::errc {})
+			{
+				throw std::runtime_error("Malformed face index");
+			}
+
+			pos = ptr;
+			return value;
+		}
+	};
+
+	/* OBJ indices are 1 based, negative ones count back from the last
+	 * element seen so far */
+	int32_t local_index(int32_t index, size_t count, bool& relative)
+	{
+		if (index == 0)
+		{
+			throw std::runtime_error("Face index 0 is invalid");
+		}
+
+		relative = index < 0;
+		return relative ? static_cast<int32_t>(count) + index : index - 1;
+	}
+
+	void parse_face(line_reader& line, obj_chunk& chunk)
+	{
+		/* Fan triangulation: the first and previous corners of the
+		 * polygon pair up with each new corner */
+		obj_corner first {}, previous {};
+		size_t corner_count {0};
+
+		while (!line.done())
+		{
+			obj_corner corner {};
+			corner.position = local_index(line.read_index(),
+										  chunk.positions.size(),
+										  corner.position_relative);
+			corner.texcoord = obj_no_texcoord;
+
+			if (line.pos < line.end && *line.pos == '/')
+			{
+				++line.pos;
+				const int32_t texcoord {line.read_index()};
+				if (texcoord != 0)
+				{
+					corner.texcoord = local_index(texcoord,
+												  chunk.texcoords.size(),
+												  corner.texcoord_relative);
+				}
+
+				/* Normals are not used */
+				if (line.pos < line.end && *line.pos == '/')
+				{
+					++line.pos;
+					line.read_index();
+				}
+			}
+
+			if (corner_count == 0)
+			{
+				first = corner;
+			}
+			else if (corner_count >= 2)
+			{
+				chunk.corners.push_back(first);
+				chunk.corners.push_back(previous);
+				chunk.corners.push_back(corner);
+			}
+
+			previous = corner;
+			++corner_count;
+		}
+	}
+} /* namespace */
+
+std::vector<std::span<const std::byte>> liboceanlight::models::
+	split_obj_chunks(std::span<const std::byte> bytes, size_t chunk_bytes)
+{
+	std::vector<std::span<const std::byte>> chunks;
+	size_t begin {0};
+
+	while (begin < bytes.size())
+	{
+		size_t end {std::min(bytes.size(), begin + std::max<size_t>(
+													   chunk_bytes, 1))};
+		if (end < bytes.size())
+		{
+			const void* newline {std::memchr(
+				bytes.data() + end, '\n', bytes.size() - end)};
+			end = newline ? static_cast<size_t>(
+								static_cast<const std::byte*>(newline) -
+								bytes.data()) +
+								1
+						  : bytes.size();
+		}
+
+		chunks.push_back(bytes.subspan(begin, end - begin));
+		begin = end;
+	}
+
+	return chunks;
+}
+
+obj_chunk liboceanlight::models::parse_obj_chunk(
+	std::span<const std::byte> bytes,
+	const std::string& path)
+{
+	obj_chunk chunk {};
+	const char* pos {reinterpret_cast<const char*>(bytes.data())};
+	const char* const end {pos + bytes.size()};
+
+	/* Rough reservation, a face line is ~25 bytes of a typical scan */
+	chunk.corners.reserve(bytes.size() / 25 * 3);
+
+	while (pos < end)
+	{
+		/* memchr is vectorized by every libc we build against */
+		const auto* newline {static_cast<const char*>(
+			std::memchr(pos, '\n', static_cast<size_t>(end - pos)))};
+		const char* line_end {newline ? newline : end};
+		const char* next {newline ? newline + 1 : end};
+
+		if (line_end > pos && line_end[-1] == '\r')
+		{
+			--line_end;
+		}
+
+		line_reader line {pos, line_end};
+		line.skip_space();
+
+		try
+		{
+			if (line_end - line.pos >= 2 && line.pos[1] <= ' ')
+			{
+				const char kind {line.pos[0]};
+				line.pos += 2;
+
+				if (kind == 'v')
+				{
+					const float x {line.read_float()};
+					const float y {line.read_float()};
+					const float z {line.read_float()};
+					chunk.positions.push_back({x, y, z});
+				}
+				else if (kind == 'f')
+				{
+					parse_face(line, chunk);
+				}
+			}
+			else if (line_end - line.pos >= 3 && line.pos[0] == 'v' &&
+					 line.pos[1] == 't' && line.pos[2] <= ' ')
+			{
+				line.pos += 3;
+				const float u {line.read_float()};
+				const float v {line.done() ? 0.0f : line.read_float()};
+				chunk.texcoords.push_back({u, v});
+			}
+		}
+		catch (const std::runtime_error& e)
+		{
+			throw std::runtime_error(std::string {e.what()} + " in " + path +
+									 ": " + std::string {pos, line_end});
+		}
+
+		pos = next;
+	}
+
+	return chunk;
+}
+
+void liboceanlight::models::weld_obj_chunks(std::span<const obj_chunk> chunks,
+											const std::string& path,
+											std::vector<vertex>& vertices,
+											std::vector<uint32_t>& indices)
+{
+	/* Absolute indices may point into any earlier chunk, so gather the
+	 * flat arrays first and remember where each chunk starts */
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec2> texcoords;
+	std::vector<int64_t> position_bases, texcoord_bases;
+	size_t corner_count {0};
+
+	for (const auto& chunk : chunks)
+	{
+		position_bases.push_back(static_cast<int64_t>(positions.size()));
+		texcoord_bases.push_back(static_cast<int64_t>(texcoords.size()));
+		positions.insert(positions.end(),
+						 chunk.positions.begin(),
+						 chunk.positions.end());
+		texcoords.insert(texcoords.end(),
+						 chunk.texcoords.begin(),
+						 chunk.texcoords.end());
+		corner_count += chunk.corners.size();
+	}
+
+	const auto position_count {static_cast<int64_t>(positions.size())};
+	const auto texcoord_count {static_cast<int64_t>(texcoords.size())};
+
+	vertex_welder welder {vertices, corner_count};
+	indices.reserve(indices.size() + corner_count);
+
+	for (size_t c {0}; c < chunks.size(); ++c)
+	{
+		for (const auto& corner : chunks[c].corners)
+		{
+			const int64_t position {
+				corner.position +
+				(corner.position_relative ? position_bases[c] : 0)};
+			if (position < 0 || position >= position_count)
+			{
+				throw std::runtime_error("Vertex index out of range in " +
+										 path);
+			}
+
+			vertex v {};
+			v.pos = positions[static_cast<size_t>(position)];
+			v.color = {1.0f, 1.0f, 1.0f};
+
+			/* Flipped to a top-left origin, missing ones read as (0, 0) */
+			v.texcoord = {0.0f, 1.0f};
+			if (corner.texcoord != obj_no_texcoord)
+			{
+				const int64_t texcoord {
+					corner.texcoord +
+					(corner.texcoord_relative ? texcoord_bases[c] : 0)};
+				if (texcoord < 0 || texcoord >= texcoord_count)
+				{
+					throw std::runtime_error(
+						"Texcoord index out of range in " + path);
+				}
+
+				const auto& uv {texcoords[static_cast<size_t>(texcoord)]};
+				v.texcoord = {uv.x, 1.0f - uv.y};
+			}
+
+			indices.push_back(welder.weld(v));
+		}
+	}
+}
+
+void liboceanlight::models::load_obj(const std::string& path,
+									 std::vector<vertex>& vertices,
+									 std::vector<uint32_t>& indices)
+{
+	mapped_file file {path};
+	const std::array chunk {parse_obj_chunk(file.bytes(), path)};
+	weld_obj_chunks(chunk, path, vertices, indices);
+}
@@ -0,0 +1,205 @@
+#include <cstdint>
+#include <iterator>
+#include <liboceanlight/lol_range_allocator.hpp>
+#include <map>
+
+namespace
+{
+	uint64_t align_up(uint64_t offset, uint64_t alignment)
+	{
+		/* Vertex strides are not powers of two */
+		return (offset + alignment - 1) / alignment * alignment;
+	}
+} /* namespace */
+
+liboceanlight::range_allocator::range_allocator(uint64_t capacity) :
+	total {capacity}
+{
+	if (capacity > 0)
+	{
+		insert(0, capacity);
+	}
+}
+
+void liboceanlight::range_allocator::insert(uint64_t offset, uint64_t size)
+{
+	by_offset.emplace(offset, size);
+	by_size.emplace(size, offset);
+}
+
+void liboceanlight::range_allocator::erase(
+	std::map<uint64_t, uint64_t>::iterator range)
+{
+	auto [first, last] {by_size.equal_range(range->second)};
+	for (auto it {first}; it != last; ++it)
+	{
+		if (it->second == range->first)
+		{
+			by_size.erase(it);
+			break;
+		}
+	}
+
+	by_offset.erase(range);
+}
+
+uint64_t liboceanlight::range_allocator::allocate(uint64_t size,
+												  uint64_t alignment)
+{
+	if (size == 0)
+	{
+		return npos;
+	}
+
+	/* Smallest first; padding only rarely pushes it to a larger one */
+	for (auto it {by_size.lower_bound(size)}; it != by_size.end(); ++it)
+	{
+		const uint64_t start {it->second};
+		const uint64_t end {start + it->first};
+		const uint64_t offset {align_up(start, alignment)};
+		if (offset + size > end)
+		{
+			continue;
+		}
+
+		erase(by_offset.find(start));
+		if (offset > start)
+		{
+			insert(start, offset - start);
+		}
+
+		if (offset + size < end)
+		{
+			insert(offset + size, end - offset - size);
+		}
+
+		in_use += size;
+		return offset;
+	}
+
+	return npos;
+}
+
+void liboceanlight::range_allocator::free(uint64_t offset, uint64_t size)
+{
+	in_use -= size;
+	uint64_t start {offset}, end {offset + size};
+
+	auto next {by_offset.lower_bound(offset)};
+	if (next != by_offset.end() && next->first == end)
+	{
+		end += next->second;
+		auto merged {next++};
+		erase(merged);
+	}
+
+	if (next != by_offset.begin())
+	{
+		auto prev {std::prev(next)};
+		if (prev->first + prev->second == start)
+		{
+			start = prev->first;
+			erase(prev);
+		}
+	}
+
+	insert(start, end - start);
+}
+
+void liboceanlight::range_allocator::grow(uint64_t capacity)
+{
+	if (capacity <= total)
+	{
+		return;
+	}
+
+	/* Freeing the new tail merges it with a free range ending there */
+	const uint64_t added {capacity - total};
+	const uint64_t start {total};
+	total = capacity;
+	in_use += added;
+	free(start, added);
+}
+
+liboceanlight::linear_allocator::linear_allocator(uint64_t capacity) :
+	total {capacity}
+{
+}
+
+uint64_t liboceanlight::linear_allocator::allocate(uint64_t size,
+												   uint64_t alignment)
+{
+	const uint64_t offset {align_up(head, alignment)};
+	if (size == 0 || offset + size > total)
+	{
+		return npos;
+	}
+
+	head = offset + size;
+	in_use += size;
+	++live;
+	return offset;
+}
+
+void liboceanlight::linear_allocator::free(uint64_t size)
+{
+	in_use -= size;
+	if (--live == 0)
+	{
+		head = 0;
+	}
+}
+
+liboceanlight::ring_allocator::ring_allocator(uint64_t capacity) :
+	total {capacity}
+{
+}
+
+uint64_t liboceanlight::ring_allocator::allocate(uint64_t size,
+												 uint64_t alignment)
+{
+	/* With nothing in flight, start over at the front */
+	if (head == tail && pending.empty())
+	{
+		head = tail = head + (total - head % total) % total;
+	}
+
+	const uint64_t start {head % total};
+	uint64_t offset {align_up(start, alignment)};
+	uint64_t skipped {offset - start};
+	if (offset + size > total)
+	{
+		skipped = total - start;
+		offset = 0;
+	}
+
+	if (size == 0 || size > total || head + skipped + size - tail > total)
+	{
+		return npos;
+	}
+
+	head += skipped + size;
+	return offset;
+}
+
+void liboceanlight::ring_allocator::submit(uint64_t serial)
+{
+	if (pending.empty() || pending.back().second != head)
+	{
+		pending.emplace_back(serial, head);
+	}
+}
+
+void liboceanlight::ring_allocator::complete(uint64_t serial)
+{
+	while (!pending.empty() && pending.front().first <= serial)
+	{
+		tail = pending.front().second;
+		pending.pop_front();
+	}
+}
+
+uint64_t liboceanlight::ring_allocator::oldest_pending() const
+{
+	return pending.empty() ? 0 : pending.front().first;
+}
@@ -0,0 +1,443 @@
+#include <algorithm>
+#include <cmath>
+#include <config.h>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <liboceanlight/lol_asset_stream.hpp>
+#include <liboceanlight/lol_engine.hpp>
+#include <liboceanlight/lol_engine_init.hpp>
+#include <liboceanlight/lol_engine_shutdown.hpp>
+#include <liboceanlight/lol_hot_reload.hpp>
+#include <liboceanlight/lol_mesh_lod.hpp>
+#include <liboceanlight/lol_mipmap.hpp>
+#include <liboceanlight/lol_models.hpp>
+#include <liboceanlight/lol_streaming.hpp>
+#include <liboceanlight/lol_texture_cache.hpp>
+#include <liboceanlight/lol_texture_residency.hpp>
+#include <memory>
+#include <stb_image.h>
+#include <stop_token>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace liboceanlight::engine;
+
+namespace
+{
+	using liboceanlight::asset_stream;
+	using liboceanlight::models::lol_model;
+
+	lol_model make_placeholder_model(const std::string& name)
+	{
+		lol_model model {};
+		model.name = name;
+		for (int i {0}; i < 8; ++i)
+		{
+			const glm::vec3 pos {(i & 1) ? 0.25f : -0.25f,
+								 (i & 2) ? 0.25f : -0.25f,
+								 (i & 4) ? 0.25f : -0.25f};
+			model.vertices.push_back({pos, glm::vec3 {1.0f}, glm::vec2 {}});
+		}
+
+		model.indices = {4, 6, 2, 4, 2, 0, 1, 3, 7, 1, 7, 5,
+						 1, 5, 4, 1, 4, 0, 2, 6, 7, 2, 7, 3,
+						 2, 3, 1, 2, 1, 0, 4, 5, 7, 4, 7, 6};
+		model.bounds = liboceanlight::models::mesh_bounds(model.vertices);
+		return model;
+	}
+
+	using create_img_task = std::move_only_function<void(texture&)>;
+
+	/* Uploads with create_img between frames, then swaps the image into
+	 * its slot of the texture array and destroys the one it replaces */
+	void push_texture(engine_data& eng_data,
+					  uint32_t slot,
+					  const std::string& path,
+					  size_t bytes,
+					  create_img_task create_img,
+					  asset_stream& stream)
+	{
+		auto upload {[&eng_data,
+					  slot,
+					  path,
+					  create_img = std::move(create_img)]() mutable
+						 -> asset_stream::swap_task {
+			texture fresh {.path = path};
+			create_img(fresh);
+			create_texture_img_view(eng_data, fresh);
+
+			return [&eng_data, slot, fresh]() mutable {
+				std::swap(eng_data.textures.at(slot), fresh);
+				write_texture_descriptor(eng_data, slot);
+				destroy_texture(eng_data, fresh);
+			};
+		}};
+		stream.push({bytes, std::move(upload)});
+	}
+
+	void stream_compressed_texture(engine_data& eng_data,
+								   uint32_t slot,
+								   const std::string& path,
+								   asset_stream& stream)
+	{
+		liboceanlight::textures::compressed_texture cooked {};
+		try
+		{
+			cooked = liboceanlight::textures::cook_texture(
+				path,
+				liboceanlight::textures::texture_kind::color,
+				eng_data.workers.get());
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << "Streaming " << path << " failed, keeping the "
+					  << "placeholder texture: " << e.what() << "\n";
+			stream.skip();
+			return;
+		}
+
+		const size_t bytes {cooked.chain.pixels.size()};
+		push_texture(eng_data,
+					 slot,
+					 path,
+					 bytes,
+					 [&eng_data, cooked = std::move(cooked)](texture& tex) {
+						 create_texture_img_from_mips(
+							 eng_data, tex, cooked.chain, cooked.format);
+					 },
+					 stream);
+	}
+
+	void stream_texture(engine_data& eng_data,
+						uint32_t slot,
+						const std::string& path,
+						asset_stream& stream)
+	{
+		if (use_compressed_textures(eng_data))
+		{
+			stream_compressed_texture(eng_data, slot, path, stream);
+			return;
+		}
+
+		int width {}, height {}, channels {};
+		std::unique_ptr<stbi_uc, decltype(&stbi_image_free)> pixels {
+			stbi_load(
+				path.c_str(), &width, &height, &channels, STBI_rgb_alpha),
+			&stbi_image_free};
+
+		if (!pixels)
+		{
+			std::cerr << "Streaming " << path << " failed, keeping the "
+					  << "placeholder texture\n";
+			stream.skip();
+			return;
+		}
+
+		/* Without GPU blits the mip chain is filtered here, off the
+		 * render thread */
+		const auto w {static_cast<uint32_t>(width)};
+		const auto h {static_cast<uint32_t>(height)};
+		size_t bytes {size_t {w} * h * 4};
+		create_img_task create_img;
+		if (use_gpu_mipmaps(eng_data))
+		{
+			create_img = [&eng_data, pixels = std::move(pixels), w, h](
+							 texture& tex) {
+				create_texture_img_from_pixels(
+					eng_data, tex, pixels.get(), w, h);
+			};
+		}
+		else
+		{
+			auto chain {liboceanlight::textures::build_mip_chain(
+				{pixels.get(), bytes}, w, h, true, eng_data.workers.get())};
+			bytes = chain.pixels.size();
+			create_img = [&eng_data, chain = std::move(chain)](texture& tex) {
+				create_texture_img_from_mips(
+					eng_data, tex, chain, VK_FORMAT_R8G8B8A8_SRGB);
+			};
+		}
+
+		push_texture(
+			eng_data, slot, path, bytes, std::move(create_img), stream);
+	}
+
+	void stream_model(engine_data& eng_data,
+					  const std::string& path,
+					  const liboceanlight::models::load_options& options,
+					  asset_stream& stream)
+	{
+		std::vector<lol_model> loaded;
+		std::vector<std::byte> vertex_data, index_data;
+		try
+		{
+			liboceanlight::models::load_model_files({path}, loaded, options);
+			prepare_model(eng_data, loaded.front());
+			vertex_data = pack_vertex_data(loaded.front());
+			index_data = pack_index_data(loaded.front());
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << "Streaming " << path << " failed, keeping the "
+					  << "placeholder: " << e.what() << "\n";
+			stream.skip();
+			return;
+		}
+
+		/* The loader only touches the CPU side: the queue and command
+		 * pool belong to the render thread */
+		const size_t bytes {vertex_data.size() + index_data.size()};
+		auto upload {[&eng_data,
+					  model = std::move(loaded.front()),
+					  vertex_data = std::move(vertex_data),
+					  index_data = std::move(index_data)]() mutable
+						 -> asset_stream::swap_task {
+			upload_vertices(eng_data, model, vertex_data);
+			upload_indices(eng_data, model, index_data);
+
+			return [&eng_data, model = std::move(model)]() mutable {
+				swap_model(eng_data, model);
+			};
+		}};
+		stream.push({bytes, std::move(upload)});
+	}
+} /* namespace */
+
+void liboceanlight::engine::create_placeholders(engine_data& eng_data)
+{
+	for (const auto& file : models::find_model_files(MODEL_PATH))
+	{
+		const auto name {fs::path(file).filename().string()};
+		auto model {make_placeholder_model(name)};
+		prepare_model(eng_data, model);
+		upload_vertex_buffer(eng_data, model);
+		upload_index_buffer(eng_data, model);
+		eng_data.model_list.push_back(std::move(model));
+	}
+
+	/* Their texture slots sample the placeholder texture until then */
+	assign_materials(eng_data);
+}
+
+void liboceanlight::engine::start_streaming(engine_data& eng_data)
+{
+	if (!eng_data.async_streaming)
+	{
+		return;
+	}
+
+	std::vector<std::string> paths;
+	for (const auto& file : models::find_model_files(MODEL_PATH))
+	{
+		paths.push_back(MODEL_PATH + file);
+	}
+
+	std::vector<std::pair<uint32_t, std::string>> texture_slots;
+	for (size_t slot {0}; slot < eng_data.textures.size(); ++slot)
+	{
+		texture_slots.emplace_back(static_cast<uint32_t>(slot),
+								   eng_data.textures[slot].path);
+	}
+
+	/* Textures first: there are fewer of them than models */
+	auto load {[&eng_data,
+				texture_slots,
+				paths,
+				options = get_model_load_options(eng_data)](
+				   std::stop_token stop,
+				   asset_stream& stream) {
+		for (const auto& [slot, path] : texture_slots)
+		{
+			if (stop.stop_requested())
+			{
+				return;
+			}
+
+			stream_texture(eng_data, slot, path, stream);
+		}
+
+		for (const auto& path : paths)
+		{
+			if (stop.stop_requested())
+			{
+				return;
+			}
+
+			stream_model(eng_data, path, options, stream);
+		}
+	}};
+
+	const size_t asset_count {texture_slots.size() + paths.size()};
+	eng_data.stream = std::make_unique<asset_stream>(asset_count,
+													 std::move(load));
+}
+
+void liboceanlight::engine::process_streaming(engine_data& eng_data)
+{
+	if (!eng_data.stream)
+	{
+		return;
+	}
+
+	retire_list retire;
+	begin_upload_batch(eng_data);
+	for (auto& asset : eng_data.stream->take(eng_data.stream_upload_budget))
+	{
+		retire.push_back(asset.upload());
+	}
+
+	swap_when_uploaded(eng_data, end_upload_batch(eng_data), retire);
+
+	if (eng_data.stream->done())
+	{
+		std::cout << "Streamed all assets in "
+				  << eng_data.stream->elapsed_ms() << " ms\n";
+		eng_data.stream.reset();
+	}
+}
+
+void liboceanlight::engine::update_texture_residency(engine_data& eng_data)
+{
+	if (!eng_data.texture_residency_enabled)
+	{
+		return;
+	}
+
+	/* The sharpest level each slot is drawn with */
+	const auto& textures {eng_data.textures};
+	std::vector<uint32_t> wanted(textures.size(), UINT32_MAX);
+	const glm::mat4 model_view {eng_data.ubo.view * eng_data.ubo.model};
+	const float pixels_per_radian {
+		std::abs(eng_data.ubo.proj[1][1]) * 0.5f *
+		static_cast<float>(eng_data.swap_extent.height)};
+	for (const auto& model : eng_data.model_list)
+	{
+		const uint32_t slot {
+			eng_data.materials.at(model.material_index).texture_index};
+		const auto& source {textures.at(slot).source};
+		if (!source)
+		{
+			continue;
+		}
+
+		const float pixels {liboceanlight::models::projected_size(
+			model.bounds, model_view, pixels_per_radian)};
+		wanted[slot] = std::min(
+			wanted[slot],
+			liboceanlight::textures::screen_mip_level(source->levels,
+													  pixels));
+	}
+
+	/* Textures nothing draws keep only their smallest level */
+	std::vector<uint32_t> slots;
+	std::vector<liboceanlight::textures::residency_request> requests;
+	for (size_t slot {0}; slot < textures.size(); ++slot)
+	{
+		const auto& tex {textures[slot]};
+		if (!tex.source)
+		{
+			continue;
+		}
+
+		/* One still uploading stays as it is until swapped in */
+		const auto smallest {
+			static_cast<uint32_t>(tex.source->levels.size() - 1)};
+		slots.push_back(static_cast<uint32_t>(slot));
+		requests.push_back({tex.source.get(),
+							tex.base_level,
+							tex.swap_pending
+								? tex.base_level
+								: std::min(wanted[slot], smallest)});
+	}
+
+	/* What the textures hold now plus what the heap has left */
+	const auto textures_mem {eng_data.allocator->category_stats().at(
+		static_cast<size_t>(liboceanlight::memory_category::textures))};
+	const size_t budget {
+		std::min<size_t>(eng_data.texture_budget,
+						 textures_mem.bytes + vram_headroom(eng_data))};
+	const auto plan {
+		liboceanlight::textures::plan_residency(requests, budget)};
+
+	/* Dropping levels first frees memory for the loads */
+	std::vector<size_t> changes;
+	for (size_t i {0}; i < requests.size(); ++i)
+	{
+		if (plan[i] != requests[i].resident &&
+			!textures[slots[i]].swap_pending)
+		{
+			changes.push_back(i);
+		}
+	}
+
+	std::stable_partition(changes.begin(), changes.end(), [&](size_t i) {
+		return plan[i] > requests[i].resident;
+	});
+	changes.resize(std::min<size_t>(changes.size(),
+									eng_data.texture_residency_uploads));
+
+	retire_list retire;
+	begin_upload_batch(eng_data);
+	for (const auto i : changes)
+	{
+		const uint32_t slot {slots[i]};
+		auto& tex {eng_data.textures[slot]};
+		texture fresh {.path = tex.path, .source = tex.source};
+		try
+		{
+			upload_texture_levels(
+				eng_data, fresh, *fresh.source, tex.format, plan[i]);
+			create_texture_img_view(eng_data, fresh);
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << "Streaming levels of " << fresh.path
+					  << " failed: " << e.what() << "\n";
+			destroy_texture(eng_data, fresh);
+			continue;
+		}
+
+		tex.swap_pending = true;
+		retire.push_back([&eng_data, slot, fresh]() mutable {
+			std::swap(eng_data.textures.at(slot), fresh);
+			write_texture_descriptor(eng_data, slot);
+			destroy_texture(eng_data, fresh);
+		});
+	}
+
+	swap_when_uploaded(eng_data, end_upload_batch(eng_data), retire);
+}
+
+void liboceanlight::engine::swap_when_uploaded(engine_data& eng_data,
+											   upload_ticket ticket,
+											   retire_list& retire)
+{
+	if (!retire.empty())
+	{
+		eng_data.upload_swaps.emplace_back(ticket, std::move(retire));
+		retire.clear();
+	}
+}
+
+void liboceanlight::engine::swap_uploaded(engine_data& eng_data)
+{
+	auto& swaps {eng_data.upload_swaps};
+	retire_list ready;
+	while (!swaps.empty() && upload_finished(eng_data, swaps.front().first))
+	{
+		for (auto& task : swaps.front().second)
+		{
+			ready.push_back(std::move(task));
+		}
+
+		swaps.pop_front();
+	}
+
+	run_retired(eng_data, ready);
+}
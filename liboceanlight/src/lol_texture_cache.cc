@@ -0,0 +1,434 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <liboceanlight/lol_block_compress.hpp>
+#include <liboceanlight/lol_mipmap.hpp>
+#include <liboceanlight/lol_texture_cache.hpp>
+#include <liboceanlight/lol_utility.hpp>
+#include <memory>
+#include <span>
+#include <stb_image.h>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace fs = std::filesystem;
+using liboceanlight::textures::compressed_texture;
+using liboceanlight::textures::texture_kind;
+using liboceanlight::textures::texture_source;
+
+namespace
+{
+	/* Khronos data format descriptor values for the formats we write */
+	constexpr uint8_t dfd_model_bc4 {131};
+	constexpr uint8_t dfd_model_bc5 {132};
+	constexpr uint8_t dfd_model_bc7 {134};
+	constexpr uint8_t dfd_primaries_bt709 {1};
+	constexpr uint8_t dfd_transfer_linear {1};
+	constexpr uint8_t dfd_transfer_srgb {2};
+
+	/* identifier, nine header words, the index, then the level index */
+	constexpr size_t ktx2_header_bytes {12 + 9 * 4 + 4 * 4 + 2 * 8};
+	constexpr size_t ktx2_level_bytes {3 * 8};
+
+	uint64_t align_up(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	template <typename T> void put(std::vector<uint8_t>& out, T value)
+	{
+		const auto* bytes {reinterpret_cast<const uint8_t*>(&value)};
+		out.insert(out.end(), bytes, bytes + sizeof(T));
+	}
+
+	template <typename T>
+	void put_at(std::vector<uint8_t>& out, size_t offset, T value)
+	{
+		std::memcpy(out.data() + offset, &value, sizeof(T));
+	}
+
+	template <typename T>
+	T get(std::span<const std::byte> bytes, size_t offset)
+	{
+		if (offset + sizeof(T) > bytes.size())
+		{
+			throw std::runtime_error("truncated KTX2");
+		}
+
+		T value {};
+		std::memcpy(&value, bytes.data() + offset, sizeof(T));
+		return value;
+	}
+
+	bool kind_of(VkFormat format, texture_kind& kind)
+	{
+		for (auto k : {texture_kind::color,
+					   texture_kind::normal,
+					   texture_kind::mask})
+		{
+			if (liboceanlight::textures::block_format(k) == format)
+			{
+				kind = k;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/* One basic descriptor block with a sample per stored channel */
+	std::vector<uint8_t> make_dfd(texture_kind kind)
+	{
+		using liboceanlight::textures::block_bytes;
+		struct sample
+		{
+			uint16_t bit_offset;
+			uint8_t channel;
+		};
+
+		std::vector<sample> samples {{0, 0}};
+		uint8_t model {dfd_model_bc7};
+		if (kind == texture_kind::normal)
+		{
+			samples.push_back({64, 1});
+			model = dfd_model_bc5;
+		}
+		else if (kind == texture_kind::mask)
+		{
+			model = dfd_model_bc4;
+		}
+
+		const auto block_size {
+			static_cast<uint16_t>(24 + 16 * samples.size())};
+		const auto bits_per_sample {static_cast<uint8_t>(
+			block_bytes(kind) * 8 / samples.size() - 1)};
+
+		std::vector<uint8_t> dfd;
+		put<uint32_t>(dfd, 4u + block_size);
+		put<uint32_t>(dfd, 0); /* Khronos vendor, basic descriptor */
+		put<uint16_t>(dfd, 2); /* version 1.3 */
+		put<uint16_t>(dfd, block_size);
+		put<uint8_t>(dfd, model);
+		put<uint8_t>(dfd, dfd_primaries_bt709);
+		put<uint8_t>(dfd,
+					 kind == texture_kind::color ? dfd_transfer_srgb
+												 : dfd_transfer_linear);
+		put<uint8_t>(dfd, 0);
+		for (uint8_t dimension : {3, 3, 0, 0})
+		{
+			put<uint8_t>(dfd, dimension);
+		}
+
+		put<uint8_t>(dfd, static_cast<uint8_t>(block_bytes(kind)));
+		dfd.insert(dfd.end(), 7, 0);
+
+		for (const auto& s : samples)
+		{
+			put<uint16_t>(dfd, s.bit_offset);
+			put<uint8_t>(dfd, bits_per_sample);
+			put<uint8_t>(dfd, s.channel);
+			put<uint32_t>(dfd, 0);
+			put<uint32_t>(dfd, 0);
+			put<uint32_t>(dfd, UINT32_MAX);
+		}
+
+		return dfd;
+	}
+
+	int64_t file_mtime(const std::string& path)
+	{
+		return static_cast<int64_t>(
+			fs::last_write_time(path).time_since_epoch().count());
+	}
+
+	uint64_t hash_file(const std::string& path)
+	{
+		liboceanlight::mapped_file file {path};
+		return liboceanlight::hash_bytes(file.bytes());
+	}
+
+	bool source_matches(const texture_source& cooked,
+						const std::string& source,
+						texture_kind kind,
+						bool& mtime_changed)
+	{
+		if (cooked.version != liboceanlight::textures::texture_cache_version ||
+			cooked.kind != static_cast<uint32_t>(kind) ||
+			cooked.size != fs::file_size(source))
+		{
+			return false;
+		}
+
+		mtime_changed = cooked.mtime != file_mtime(source);
+
+		/* Same size but touched: only a content hash can tell */
+		return !mtime_changed || cooked.hash == hash_file(source);
+	}
+} /* namespace */
+
+std::string liboceanlight::textures::texture_cache_path(
+	const std::string& source)
+{
+	return source + ".ktx2";
+}
+
+void liboceanlight::textures::write_ktx2(const std::string& path,
+										 const compressed_texture& texture,
+										 const texture_source& source)
+{
+	texture_kind kind {};
+	if (!kind_of(texture.format, kind) || texture.chain.levels.empty())
+	{
+		throw std::runtime_error("Cannot write this texture as KTX2");
+	}
+
+	const auto& levels {texture.chain.levels};
+	const auto level_count {static_cast<uint32_t>(levels.size())};
+	const auto dfd {make_dfd(kind)};
+
+	std::vector<uint8_t> kvd;
+	const std::string key {texture_source_key};
+	put<uint32_t>(kvd, static_cast<uint32_t>(key.size() + 1 + sizeof(source)));
+	kvd.insert(kvd.end(), key.begin(), key.end());
+	kvd.push_back(0);
+	put(kvd, source);
+	kvd.resize(align_up(kvd.size(), 4));
+
+	const size_t dfd_offset {ktx2_header_bytes +
+							 ktx2_level_bytes * level_count};
+	const size_t kvd_offset {dfd_offset + dfd.size()};
+
+	std::vector<uint8_t> out;
+	out.insert(out.end(), ktx2_identifier.begin(), ktx2_identifier.end());
+	put<uint32_t>(out, texture.format);
+	put<uint32_t>(out, 1); /* typeSize */
+	put<uint32_t>(out, levels.front().width);
+	put<uint32_t>(out, levels.front().height);
+	put<uint32_t>(out, 0); /* pixelDepth */
+	put<uint32_t>(out, 0); /* layerCount */
+	put<uint32_t>(out, 1); /* faceCount */
+	put<uint32_t>(out, level_count);
+	put<uint32_t>(out, 0); /* supercompressionScheme */
+	put<uint32_t>(out, static_cast<uint32_t>(dfd_offset));
+	put<uint32_t>(out, static_cast<uint32_t>(dfd.size()));
+	put<uint32_t>(out, static_cast<uint32_t>(kvd_offset));
+	put<uint32_t>(out, static_cast<uint32_t>(kvd.size()));
+	put<uint64_t>(out, 0);
+	put<uint64_t>(out, 0);
+	out.resize(dfd_offset);
+	out.insert(out.end(), dfd.begin(), dfd.end());
+	out.insert(out.end(), kvd.begin(), kvd.end());
+
+	for (size_t i {levels.size()}; i-- > 0;)
+	{
+		const size_t begin {levels[i].offset};
+		const size_t end {i + 1 < levels.size() ? levels[i + 1].offset
+												: texture.chain.pixels.size()};
+		out.resize(align_up(out.size(), block_bytes(kind)));
+		const size_t level_offset {ktx2_header_bytes + i * ktx2_level_bytes};
+		put_at<uint64_t>(out, level_offset, out.size());
+		put_at<uint64_t>(out, level_offset + 8, end - begin);
+		put_at<uint64_t>(out, level_offset + 16, end - begin);
+		out.insert(out.end(),
+				   texture.chain.pixels.begin() + begin,
+				   texture.chain.pixels.begin() + end);
+	}
+
+	const std::string tmp_path {path + ".tmp"};
+	std::ofstream file {tmp_path, std::ios::binary | std::ios::trunc};
+	if (!file)
+	{
+		throw std::runtime_error("cannot open " + tmp_path);
+	}
+
+	file.write(reinterpret_cast<const char*>(out.data()),
+			   static_cast<std::streamsize>(out.size()));
+	file.close();
+	if (!file)
+	{
+		std::error_code ec {};
+		fs::remove(tmp_path, ec);
+		throw std::runtime_error("write to " + tmp_path + " failed");
+	}
+
+	fs::rename(tmp_path, path);
+}
+
+compressed_texture liboceanlight::textures::read_ktx2(const std::string& path,
+													  texture_source& source)
+{
+	mapped_file file {path};
+	const auto bytes {file.bytes()};
+	if (bytes.size() < ktx2_header_bytes ||
+		std::memcmp(bytes.data(),
+					ktx2_identifier.data(),
+					ktx2_identifier.size()) != 0)
+	{
+		throw std::runtime_error("not a KTX2 file");
+	}
+
+	compressed_texture texture {};
+	texture_kind kind {};
+	texture.format = static_cast<VkFormat>(get<uint32_t>(bytes, 12));
+	uint32_t width {get<uint32_t>(bytes, 20)};
+	uint32_t height {get<uint32_t>(bytes, 24)};
+	const uint32_t level_count {get<uint32_t>(bytes, 40)};
+	if (!kind_of(texture.format, kind) || width == 0 || height == 0 ||
+		get<uint32_t>(bytes, 28) != 0 || get<uint32_t>(bytes, 32) > 1 ||
+		get<uint32_t>(bytes, 36) != 1 || get<uint32_t>(bytes, 44) != 0 ||
+		level_count == 0 || level_count > mip_level_count(width, height))
+	{
+		throw std::runtime_error("unsupported KTX2 layout");
+	}
+
+	for (uint32_t i {0}; i < level_count; ++i)
+	{
+		const size_t entry {ktx2_header_bytes + i * ktx2_level_bytes};
+		const uint64_t offset {get<uint64_t>(bytes, entry)};
+		const uint64_t length {get<uint64_t>(bytes, entry + 8)};
+		const uint64_t expected {size_t {(width + 3) / 4} *
+								 ((height + 3) / 4) * block_bytes(kind)};
+		if (length != expected || offset > bytes.size() ||
+			length > bytes.size() - offset)
+		{
+			throw std::runtime_error("KTX2 level out of range");
+		}
+
+		texture.chain.levels.push_back(
+			{texture.chain.pixels.size(), width, height});
+		const auto* level {
+			reinterpret_cast<const uint8_t*>(bytes.data() + offset)};
+		texture.chain.pixels.insert(
+			texture.chain.pixels.end(), level, level + length);
+		width = std::max(width / 2, 1u);
+		height = std::max(height / 2, 1u);
+	}
+
+	/* Walk the key/value entries for the cooking record */
+	const size_t kvd_offset {get<uint32_t>(bytes, 56)};
+	const size_t kvd_end {kvd_offset + get<uint32_t>(bytes, 60)};
+	const std::string key {texture_source_key};
+	source = {};
+	source.version = 0; /* never matches when the entry is missing */
+	for (size_t entry {kvd_offset}; entry + 4 <= kvd_end;)
+	{
+		const uint32_t length {get<uint32_t>(bytes, entry)};
+		const size_t data {entry + 4};
+		if (length == key.size() + 1 + sizeof(source) &&
+			data + length <= bytes.size() &&
+			std::memcmp(bytes.data() + data, key.c_str(), key.size() + 1) ==
+				0)
+		{
+			source = get<texture_source>(bytes, data + key.size() + 1);
+		}
+
+		entry = align_up(data + length, 4);
+	}
+
+	return texture;
+}
+
+compressed_texture liboceanlight::textures::cook_texture(
+	const std::string& source,
+	texture_kind kind,
+	liboceanlight::thread_pool* pool)
+{
+	const std::string cache_path {texture_cache_path(source)};
+	try
+	{
+		if (fs::exists(cache_path))
+		{
+			texture_source cooked {};
+			bool mtime_changed {false};
+			auto texture {read_ktx2(cache_path, cooked)};
+			if (source_matches(cooked, source, kind, mtime_changed))
+			{
+				if (mtime_changed)
+				{
+					/* Content is identical, remember the new mtime to
+					 * skip hashing */
+					cooked.mtime = file_mtime(source);
+					try
+					{
+						write_ktx2(cache_path, texture, cooked);
+					}
+					catch (const std::exception& e)
+					{
+						std::cerr << "Failed to refresh texture cache "
+								  << cache_path << ": " << e.what() << "\n";
+					}
+				}
+
+				return texture;
+			}
+		}
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "Ignoring texture cache " << cache_path << ": "
+				  << e.what() << "\n";
+	}
+
+	/* Keyed by the bytes decoded, with the mtime taken before mapping
+	 * them, so a save while this cooks is noticed on the next load */
+	const auto start {std::chrono::steady_clock::now()};
+	texture_source cooked {};
+	cooked.kind = static_cast<uint32_t>(kind);
+	cooked.mtime = file_mtime(source);
+	mapped_file file {source};
+	const auto bytes {file.bytes()};
+	cooked.size = bytes.size();
+	cooked.hash = hash_bytes(bytes);
+
+	int width {}, height {}, channels {};
+	std::unique_ptr<stbi_uc, decltype(&stbi_image_free)> pixels {
+		stbi_load_from_memory(
+			reinterpret_cast<const stbi_uc*>(bytes.data()),
+			static_cast<int>(bytes.size()),
+			&width,
+			&height,
+			&channels,
+			STBI_rgb_alpha),
+		&stbi_image_free};
+	file = {};
+	if (!pixels)
+	{
+		throw std::runtime_error("Failed to load texture image " + source);
+	}
+
+	const auto w {static_cast<uint32_t>(width)};
+	const auto h {static_cast<uint32_t>(height)};
+	const auto mips {build_mip_chain({pixels.get(), size_t {w} * h * 4},
+									 w,
+									 h,
+									 kind == texture_kind::color,
+									 pool)};
+	pixels.reset();
+
+	compressed_texture texture {block_format(kind),
+								compress_mip_chain(mips, kind, pool)};
+
+	try
+	{
+		write_ktx2(cache_path, texture, cooked);
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "Failed to write texture cache " << cache_path << ": "
+				  << e.what() << "\n";
+	}
+
+	std::cout << "Cooked " << source << ": " << mips.pixels.size() / 1024
+			  << " KiB of RGBA8 to " << texture.chain.pixels.size() / 1024
+			  << " KiB of blocks in "
+			  << std::chrono::duration<double, std::milli>(
+					 std::chrono::steady_clock::now() - start)
+					 .count()
+			  << " ms\n";
+	return texture;
+}
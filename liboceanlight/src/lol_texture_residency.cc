@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <cmath>
+#include <liboceanlight/lol_mipmap.hpp>
+#include <liboceanlight/lol_texture_residency.hpp>
+#include <queue>
+#include <span>
+#include <utility>
+#include <vector>
+
+using liboceanlight::textures::mip_chain;
+
+namespace
+{
+	size_t level_bytes(const mip_chain& chain, uint32_t level)
+	{
+		const size_t end {level + 1 < chain.levels.size()
+							  ? chain.levels[level + 1].offset
+							  : chain.pixels.size()};
+		return end - chain.levels[level].offset;
+	}
+} /* namespace */
+
+size_t liboceanlight::textures::resident_bytes(const mip_chain& chain,
+											   uint32_t level)
+{
+	return chain.pixels.size() - chain.levels.at(level).offset;
+}
+
+uint32_t liboceanlight::textures::first_level_within(
+	std::span<const mip_level> levels,
+	uint32_t max_size)
+{
+	for (size_t i {0}; i < levels.size(); ++i)
+	{
+		if (std::max(levels[i].width, levels[i].height) <= max_size)
+		{
+			return static_cast<uint32_t>(i);
+		}
+	}
+
+	return static_cast<uint32_t>(levels.size() - 1);
+}
+
+uint32_t liboceanlight::textures::screen_mip_level(
+	std::span<const mip_level> levels,
+	float screen_pixels)
+{
+	const auto size {static_cast<float>(
+		std::max(levels.front().width, levels.front().height))};
+	const auto smallest {static_cast<uint32_t>(levels.size() - 1)};
+	if (screen_pixels >= size)
+	{
+		return 0;
+	}
+
+	if (!(screen_pixels > 1.0f))
+	{
+		return smallest;
+	}
+
+	const auto level {
+		static_cast<uint32_t>(std::floor(std::log2(size / screen_pixels)))};
+	return std::min(level, smallest);
+}
+
+std::vector<uint32_t> liboceanlight::textures::plan_residency(
+	std::span<const residency_request> requests,
+	size_t budget)
+{
+	std::vector<uint32_t> plan(requests.size());
+	size_t total {0};
+	for (size_t i {0}; i < requests.size(); ++i)
+	{
+		const auto& request {requests[i]};
+		const bool keep {request.wanted >= request.resident &&
+						 request.wanted <= request.resident + 1};
+		plan[i] = keep ? request.resident : request.wanted;
+		total += resident_bytes(*request.source, plan[i]);
+	}
+
+	/* Largest top level first */
+	std::priority_queue<std::pair<size_t, size_t>> largest;
+	for (size_t i {0}; i < requests.size(); ++i)
+	{
+		if (plan[i] + 1 < requests[i].source->levels.size())
+		{
+			largest.emplace(level_bytes(*requests[i].source, plan[i]), i);
+		}
+	}
+
+	while (total > budget && !largest.empty())
+	{
+		const size_t i {largest.top().second};
+		largest.pop();
+
+		const mip_chain& source {*requests[i].source};
+		total -= level_bytes(source, plan[i]);
+		++plan[i];
+		if (plan[i] + 1 < source.levels.size())
+		{
+			largest.emplace(level_bytes(source, plan[i]), i);
+		}
+	}
+
+	return plan;
+}
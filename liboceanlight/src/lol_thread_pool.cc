@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <liboceanlight/lol_thread_pool.hpp>
+#include <mutex>
+#include <thread>
+
+liboceanlight::thread_pool::thread_pool(unsigned int thread_count)
+{
+	if (thread_count == 0)
+	{
+		thread_count = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	workers.reserve(thread_count);
+	for (unsigned int i {0}; i < thread_count; ++i)
+	{
+		workers.emplace_back([this] { worker_loop(); });
+	}
+}
+
+liboceanlight::thread_pool::~thread_pool() noexcept
+{
+	{
+		std::scoped_lock lock {tasks_mtx};
+		stopping = true;
+	}
+
+	tasks_cv.notify_all();
+	workers.clear();
+}
+
+unsigned int liboceanlight::thread_pool::size() const
+{
+	return static_cast<unsigned int>(workers.size());
+}
+
+void liboceanlight::thread_pool::enqueue(std::move_only_function<void()> task)
+{
+	{
+		std::scoped_lock lock {tasks_mtx};
+		tasks.push_back(std::move(task));
+	}
+
+	tasks_cv.notify_one();
+}
+
+void liboceanlight::thread_pool::worker_loop()
+{
+	while (true)
+	{
+		std::move_only_function<void()> task;
+
+		{
+			std::unique_lock lock {tasks_mtx};
+			tasks_cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+
+			if (tasks.empty())
+			{
+				return;
+			}
+
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+
+		task();
+	}
+}
@@ -1,12 +1,26 @@
+#include <bit>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <liboceanlight/lol_utility.hpp>
 #include <map>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <vulkan/vulkan_core.h>
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif /* _WIN32 */
+
 std::string liboceanlight::queue_flags_to_string(const VkQueueFlags& flags)
 {
 	std::stringstream formatted;
@@ -54,3 +68,210 @@ int liboceanlight::test_func(int a, int b)
 {
 	return a + b;
 }
+
+namespace
+{
+	constexpr uint64_t prime64_1 {0x9E3779B185EBCA87ull};
+	constexpr uint64_t prime64_2 {0xC2B2AE3D27D4EB4Full};
+	constexpr uint64_t prime64_3 {0x165667B19E3779F9ull};
+	constexpr uint64_t prime64_4 {0x85EBCA77C2B2AE63ull};
+	constexpr uint64_t prime64_5 {0x27D4EB2F165667C5ull};
+
+	template <typename T> T read_le(const std::byte* p)
+	{
+		T value {};
+		std::memcpy(&value, p, sizeof(T));
+		if constexpr (std::endian::native == std::endian::big)
+		{
+			value = std::byteswap(value);
+		}
+		return value;
+	}
+
+	uint64_t xxh_round(uint64_t acc, uint64_t input)
+	{
+		acc += input * prime64_2;
+		acc = std::rotl(acc, 31);
+		return acc * prime64_1;
+	}
+
+	uint64_t xxh_merge_round(uint64_t acc, uint64_t val)
+	{
+		acc ^= xxh_round(0, val);
+		return acc * prime64_1 + prime64_4;
+	}
+} /* namespace */
+
+uint64_t liboceanlight::hash_bytes(std::span<const std::byte> data,
+								   uint64_t seed)
+{
+	const std::byte* p {data.data()};
+	const std::byte* const end {p + data.size()};
+	uint64_t h {};
+
+	if (data.size() >= 32)
+	{
+		uint64_t v1 {seed + prime64_1 + prime64_2};
+		uint64_t v2 {seed + prime64_2};
+		uint64_t v3 {seed};
+		uint64_t v4 {seed - prime64_1};
+
+		for (; p + 32 <= end; p += 32)
+		{
+			v1 = xxh_round(v1, read_le<uint64_t>(p));
+			v2 = xxh_round(v2, read_le<uint64_t>(p + 8));
+			v3 = xxh_round(v3, read_le<uint64_t>(p + 16));
+			v4 = xxh_round(v4, read_le<uint64_t>(p + 24));
+		}
+
+		h = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) +
+			std::rotl(v4, 18);
+		h = xxh_merge_round(h, v1);
+		h = xxh_merge_round(h, v2);
+		h = xxh_merge_round(h, v3);
+		h = xxh_merge_round(h, v4);
+	}
+	else
+	{
+		h = seed + prime64_5;
+	}
+
+	h += static_cast<uint64_t>(data.size());
+
+	for (; p + 8 <= end; p += 8)
+	{
+		h ^= xxh_round(0, read_le<uint64_t>(p));
+		h = std::rotl(h, 27) * prime64_1 + prime64_4;
+	}
+
+	if (p + 4 <= end)
+	{
+		h ^= static_cast<uint64_t>(read_le<uint32_t>(p)) * prime64_1;
+		h = std::rotl(h, 23) * prime64_2 + prime64_3;
+		p += 4;
+	}
+
+	for (; p < end; ++p)
+	{
+		h ^= static_cast<uint64_t>(*p) * prime64_5;
+		h = std::rotl(h, 11) * prime64_1;
+	}
+
+	h ^= h >> 33;
+	h *= prime64_2;
+	h ^= h >> 29;
+	h *= prime64_3;
+	h ^= h >> 32;
+	return h;
+}
+
+liboceanlight::mapped_file::mapped_file(const std::string& filename)
+{
+#ifdef _WIN32
+	file_handle = CreateFileA(filename.c_str(),
+							  GENERIC_READ,
+							  FILE_SHARE_READ,
+							  nullptr,
+							  OPEN_EXISTING,
+							  FILE_FLAG_SEQUENTIAL_SCAN,
+							  nullptr);
+
+	if (file_handle == INVALID_HANDLE_VALUE)
+	{
+		file_handle = nullptr;
+		throw std::runtime_error("Failed to open file " + filename);
+	}
+
+	LARGE_INTEGER file_size {};
+	GetFileSizeEx(file_handle, &file_size);
+	data_size = static_cast<size_t>(file_size.QuadPart);
+
+	if (data_size == 0)
+	{
+		return;
+	}
+
+	mapping_handle = CreateFileMappingA(file_handle,
+										nullptr,
+										PAGE_READONLY,
+										0,
+										0,
+										nullptr);
+	if (!mapping_handle)
+	{
+		unmap();
+		throw std::runtime_error("Failed to map file " + filename);
+	}
+
+	data_pointer = static_cast<const std::byte*>(
+		MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+#else
+	const int fd {open(filename.c_str(), O_RDONLY)};
+	if (fd < 0)
+	{
+		throw std::runtime_error("Failed to open file " + filename);
+	}
+
+	struct stat st {};
+	if (fstat(fd, &st) != 0)
+	{
+		close(fd);
+		throw std::runtime_error("Failed to stat file " + filename);
+	}
+
+	data_size = static_cast<size_t>(st.st_size);
+	if (data_size == 0)
+	{
+		close(fd);
+		return;
+	}
+
+	void* addr {mmap(nullptr, data_size, PROT_READ, MAP_PRIVATE, fd, 0)};
+	close(fd);
+
+	if (addr == MAP_FAILED)
+	{
+		data_size = 0;
+		throw std::runtime_error("Failed to map file " + filename);
+	}
+
+	data_pointer = static_cast<const std::byte*>(addr);
+#endif /* _WIN32 */
+
+	if (!data_pointer)
+	{
+		unmap();
+		throw std::runtime_error("Failed to map file " + filename);
+	}
+}
+
+void liboceanlight::mapped_file::unmap() noexcept
+{
+#ifdef _WIN32
+	if (data_pointer)
+	{
+		UnmapViewOfFile(data_pointer);
+	}
+
+	if (mapping_handle)
+	{
+		CloseHandle(mapping_handle);
+	}
+
+	if (file_handle)
+	{
+		CloseHandle(file_handle);
+	}
+
+	file_handle = nullptr;
+	mapping_handle = nullptr;
+#else
+	if (data_pointer)
+	{
+		munmap(const_cast<std::byte*>(data_pointer), data_size);
+	}
+#endif /* _WIN32 */
+
+	data_pointer = nullptr;
+	data_size = 0;
+}
@@ -0,0 +1,101 @@
+#include <cmath>
+#include <glm/glm.hpp>
+#include <liboceanlight/lol_engine.hpp>
+#include <liboceanlight/lol_vertex_format.hpp>
+#include <liboceanlight/lol_vertex_packing.hpp>
+#include <span>
+#include <vector>
+
+using liboceanlight::engine::packed_vertex;
+using liboceanlight::engine::vertex;
+using liboceanlight::engine::vertex_format;
+
+static_assert(sizeof(packed_vertex) == 12, "packed_vertex must be 12 bytes");
+
+namespace
+{
+	uint16_t quantize_unorm16(float value, float offset, float extent)
+	{
+		if (extent <= 0.0f)
+		{
+			return 0;
+		}
+
+		const float t {(value - offset) / extent};
+		return static_cast<uint16_t>(
+			std::lround(std::fmin(std::fmax(t, 0.0f), 1.0f) * 65535.0f));
+	}
+} /* namespace */
+
+vertex_format liboceanlight::models::choose_vertex_format(
+	std::span<const vertex> vertices,
+	vertex_format preferred)
+{
+	if (preferred == vertex_format::full || vertices.empty())
+	{
+		return vertex_format::full;
+	}
+
+	const glm::vec3 white {1.0f, 1.0f, 1.0f};
+	glm::vec2 lo {vertices.front().texcoord};
+	glm::vec2 hi {vertices.front().texcoord};
+	for (const auto& v : vertices)
+	{
+		if (v.color != white)
+		{
+			return vertex_format::full;
+		}
+
+		lo = glm::min(lo, v.texcoord);
+		hi = glm::max(hi, v.texcoord);
+	}
+
+	const glm::vec2 span {hi - lo};
+	return span.x > packed_texcoord_span || span.y > packed_texcoord_span
+			   ? vertex_format::full
+			   : preferred;
+}
+
+std::vector<packed_vertex> liboceanlight::models::pack_vertices(
+	std::span<const vertex> vertices,
+	liboceanlight::engine::vertex_quantization& quantization)
+{
+	std::vector<packed_vertex> packed(vertices.size());
+	if (vertices.empty())
+	{
+		quantization = {};
+		return packed;
+	}
+
+	glm::vec3 lo {vertices.front().pos};
+	glm::vec3 hi {vertices.front().pos};
+	glm::vec2 uv_lo {vertices.front().texcoord};
+	glm::vec2 uv_hi {vertices.front().texcoord};
+	for (const auto& v : vertices)
+	{
+		lo = glm::min(lo, v.pos);
+		hi = glm::max(hi, v.pos);
+		uv_lo = glm::min(uv_lo, v.texcoord);
+		uv_hi = glm::max(uv_hi, v.texcoord);
+	}
+
+	const glm::vec3 extent {hi - lo};
+	const glm::vec2 uv_extent {uv_hi - uv_lo};
+	quantization.offset = {lo, 0.0f};
+	quantization.scale = {extent, 0.0f};
+	quantization.texcoord = {uv_lo, uv_extent};
+
+	for (size_t i {0}; i < vertices.size(); ++i)
+	{
+		const auto& v {vertices[i]};
+		packed[i].pos = {quantize_unorm16(v.pos.x, lo.x, extent.x),
+						 quantize_unorm16(v.pos.y, lo.y, extent.y),
+						 quantize_unorm16(v.pos.z, lo.z, extent.z),
+						 0};
+		packed[i].texcoord = {
+			quantize_unorm16(v.texcoord.x, uv_lo.x, uv_extent.x),
+			quantize_unorm16(v.texcoord.y, uv_lo.y, uv_extent.y)};
+	}
+
+	return packed;
+}
@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <liboceanlight/lol_engine.hpp>
+#include <liboceanlight/lol_vertex_welder.hpp>
+#include <vector>
+
+using liboceanlight::engine::vertex;
+
+static_assert(sizeof(vertex) == 32, "vertex must be tightly packed");
+
+uint64_t liboceanlight::models::hash_vertex(const vertex& v)
+{
+	std::array<uint64_t, 4> words {};
+	std::memcpy(words.data(), &v, sizeof(vertex));
+
+	uint64_t h {0x9E3779B97F4A7C15ull};
+	for (auto word : words)
+	{
+		h = std::rotl((h ^ word) * 0xBF58476D1CE4E5B9ull, 29);
+	}
+
+	/* splitmix64 finalizer */
+	h ^= h >> 30;
+	h *= 0xBF58476D1CE4E5B9ull;
+	h ^= h >> 27;
+	h *= 0x94D049BB133111EBull;
+	h ^= h >> 31;
+	return h;
+}
+
+liboceanlight::models::vertex_welder::vertex_welder(std::vector<vertex>& out,
+													size_t index_count) :
+	vertices(out)
+{
+	/* Meshes average four to six corners per unique vertex, so this fits
+	 * what out already holds plus the new vertices under the growth load
+	 * factor, without growing in the common case */
+	rehash(std::bit_ceil(std::max<size_t>(
+		16, (out.size() + index_count / 2) * 4 / 3 + 1)));
+	vertices.reserve(vertices.size() + index_count / 4);
+}
+
+void liboceanlight::models::vertex_welder::rehash(size_t capacity)
+{
+	slots.assign(capacity, slot {0, 0});
+	mask = capacity - 1;
+
+	for (size_t i {0}; i < vertices.size(); ++i)
+	{
+		const uint64_t h {hash_vertex(vertices[i])};
+		size_t pos {h & mask};
+		while (slots[pos].index_plus_one != 0)
+		{
+			pos = (pos + 1) & mask;
+		}
+
+		slots[pos] = {static_cast<uint32_t>(h >> 32),
+					  static_cast<uint32_t>(i + 1)};
+	}
+}
+
+uint32_t liboceanlight::models::vertex_welder::weld(const vertex& v)
+{
+	if ((vertices.size() + 1) * 4 > slots.size() * 3)
+	{
+		rehash(slots.size() * 2);
+	}
+
+	const uint64_t h {hash_vertex(v)};
+	const auto tag {static_cast<uint32_t>(h >> 32)};
+
+	for (size_t pos {h & mask};; pos = (pos + 1) & mask)
+	{
+		slot& s {slots[pos]};
+		if (s.index_plus_one == 0)
+		{
+			vertices.push_back(v);
+			s = {tag, static_cast<uint32_t>(vertices.size())};
+			return s.index_plus_one - 1;
+		}
+
+		if (s.tag == tag &&
+			std::memcmp(&vertices[s.index_plus_one - 1], &v, sizeof(v)) == 0)
+		{
+			return s.index_plus_one - 1;
+		}
+	}
+}
@@ -0,0 +1,701 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <gtest/gtest.h>
+#include <liboceanlight/lol_engine.hpp>
+#include <liboceanlight/lol_gltf.hpp>
+#include <liboceanlight/lol_index_packing.hpp>
+#include <liboceanlight/lol_mesh_cache.hpp>
+#include <liboceanlight/lol_mesh_lod.hpp>
+#include <liboceanlight/lol_mesh_optimizer.hpp>
+#include <liboceanlight/lol_models.hpp>
+#include <liboceanlight/lol_obj_parser.hpp>
+#include <liboceanlight/lol_thread_pool.hpp>
+#include <liboceanlight/lol_vertex_packing.hpp>
+#include <liboceanlight/lol_vertex_welder.hpp>
+#include <random>
+#include <span>
+#include <vector>
+
+using liboceanlight::engine::vertex;
+
+namespace
+{
+	vertex make_vertex(float x, float y, float z, float u, float v)
+	{
+		vertex result {};
+		result.pos = {x, y, z};
+		result.color = {1.0f, 1.0f, 1.0f};
+		result.texcoord = {u, v};
+		return result;
+	}
+
+	/* n by n quad grid with its triangles in a shuffled order */
+	void make_shuffled_grid(uint32_t n,
+							std::vector<vertex>& vertices,
+							std::vector<uint32_t>& indices)
+	{
+		for (uint32_t y {0}; y <= n; ++y)
+		{
+			for (uint32_t x {0}; x <= n; ++x)
+			{
+				vertices.push_back(make_vertex(static_cast<float>(x),
+											   static_cast<float>(y),
+											   0.0f,
+											   0.0f,
+											   0.0f));
+			}
+		}
+
+		std::vector<std::array<uint32_t, 3>> triangles;
+		for (uint32_t y {0}; y < n; ++y)
+		{
+			for (uint32_t x {0}; x < n; ++x)
+			{
+				const uint32_t i {y * (n + 1) + x};
+				triangles.push_back({i, i + 1, i + n + 1});
+				triangles.push_back({i + 1, i + n + 2, i + n + 1});
+			}
+		}
+
+		std::shuffle(triangles.begin(), triangles.end(), std::mt19937 {42});
+		for (const auto& triangle : triangles)
+		{
+			indices.insert(indices.end(), triangle.begin(), triangle.end());
+		}
+	}
+
+	/* Triangles as sorted position triples, independent of index order */
+	std::vector<std::array<float, 6>> triangle_set(
+		const std::vector<vertex>& vertices,
+		const std::vector<uint32_t>& indices)
+	{
+		std::vector<std::array<float, 6>> result;
+		for (size_t t {0}; t + 2 < indices.size(); t += 3)
+		{
+			std::array<std::array<float, 2>, 3> corners {};
+			for (size_t k {0}; k < 3; ++k)
+			{
+				const auto& pos {vertices[indices[t + k]].pos};
+				corners[k] = {pos.x, pos.y};
+			}
+
+			/* Rotate so the smallest corner comes first, keeping winding */
+			const auto first {std::min_element(corners.begin(),
+											   corners.end())};
+			std::rotate(corners.begin(), first, corners.end());
+			result.push_back({corners[0][0],
+							  corners[0][1],
+							  corners[1][0],
+							  corners[1][1],
+							  corners[2][0],
+							  corners[2][1]});
+		}
+
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+
+	void append_u32(std::string& out, uint32_t value)
+	{
+		out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	/* GLB container around a JSON document and a binary chunk */
+	void write_glb(const std::string& path,
+				   std::string json,
+				   std::string bin)
+	{
+		json.resize((json.size() + 3) & ~size_t {3}, ' ');
+		bin.resize((bin.size() + 3) & ~size_t {3}, '\0');
+
+		std::string glb {"glTF"};
+		append_u32(glb, 2);
+		append_u32(glb,
+				   static_cast<uint32_t>(12 + 8 + json.size() + 8 +
+										 bin.size()));
+		append_u32(glb, static_cast<uint32_t>(json.size()));
+		append_u32(glb, 0x4E4F534A);
+		glb += json;
+		append_u32(glb, static_cast<uint32_t>(bin.size()));
+		append_u32(glb, 0x004E4942);
+		glb += bin;
+
+		std::ofstream file {path, std::ios::binary};
+		file.write(glb.data(), static_cast<std::streamsize>(glb.size()));
+	}
+} /* namespace */
+
+TEST(vertex_welder_tests, identical_vertices_share_an_index)
+{
+	std::vector<vertex> vertices;
+	liboceanlight::models::vertex_welder welder {vertices, 6};
+
+	const auto a {welder.weld(make_vertex(0.0f, 0.0f, 0.0f, 0.0f, 0.0f))};
+	const auto b {welder.weld(make_vertex(1.0f, 0.0f, 0.0f, 1.0f, 0.0f))};
+	const auto c {welder.weld(make_vertex(0.0f, 0.0f, 0.0f, 0.0f, 0.0f))};
+
+	EXPECT_EQ(a, c);
+	EXPECT_NE(a, b);
+	EXPECT_EQ(vertices.size(), 2);
+}
+
+TEST(vertex_welder_tests, texcoord_seams_stay_separate)
+{
+	std::vector<vertex> vertices;
+	liboceanlight::models::vertex_welder welder {vertices, 2};
+
+	const auto a {welder.weld(make_vertex(0.0f, 1.0f, 0.0f, 0.0f, 0.0f))};
+	const auto b {welder.weld(make_vertex(0.0f, 1.0f, 0.0f, 1.0f, 0.0f))};
+
+	EXPECT_NE(a, b);
+	EXPECT_EQ(vertices.size(), 2);
+}
+
+TEST(vertex_welder_tests, grows_past_the_presized_capacity)
+{
+	std::vector<vertex> vertices;
+	liboceanlight::models::vertex_welder welder {vertices, 0};
+
+	const uint32_t n {10000};
+	for (uint32_t i {0}; i < n; ++i)
+	{
+		EXPECT_EQ(welder.weld(make_vertex(static_cast<float>(i),
+										  0.0f,
+										  0.0f,
+										  0.0f,
+										  0.0f)),
+				  i);
+	}
+
+	for (uint32_t i {0}; i < n; ++i)
+	{
+		EXPECT_EQ(welder.weld(make_vertex(static_cast<float>(i),
+										  0.0f,
+										  0.0f,
+										  0.0f,
+										  0.0f)),
+				  i);
+	}
+
+	EXPECT_EQ(vertices.size(), n);
+}
+
+TEST(vertex_welder_tests, welds_onto_a_filled_output)
+{
+	/* More vertices already in out than a table sized for the corners
+	 * alone would hold */
+	std::vector<vertex> vertices;
+	for (uint32_t i {0}; i < 100; ++i)
+	{
+		vertices.push_back(
+			make_vertex(static_cast<float>(i), 0.0f, 0.0f, 0.0f, 0.0f));
+	}
+
+	liboceanlight::models::vertex_welder welder {vertices, 3};
+	EXPECT_EQ(welder.weld(vertices[42]), 42u);
+	EXPECT_EQ(welder.weld(make_vertex(0.0f, 1.0f, 0.0f, 0.0f, 0.0f)), 100u);
+	EXPECT_EQ(vertices.size(), 101u);
+}
+
+TEST(vertex_welder_tests, hash_is_bit_exact)
+{
+	const auto positive {make_vertex(0.0f, 0.0f, 0.0f, 0.0f, 0.0f)};
+	const auto negative {make_vertex(-0.0f, 0.0f, 0.0f, 0.0f, 0.0f)};
+
+	EXPECT_EQ(liboceanlight::models::hash_vertex(positive),
+			  liboceanlight::models::hash_vertex(positive));
+	EXPECT_NE(liboceanlight::models::hash_vertex(positive),
+			  liboceanlight::models::hash_vertex(negative));
+}
+
+TEST(mesh_optimizer_tests, analyze_counts_fifo_misses)
+{
+	/* Two triangles sharing an edge: four transforms */
+	const std::vector<uint32_t> indices {0, 1, 2, 2, 1, 3};
+	const auto stats {liboceanlight::models::analyze_vertex_cache(indices, 4)};
+
+	EXPECT_EQ(stats.triangles, 2);
+	EXPECT_EQ(stats.vertices, 4);
+	EXPECT_EQ(stats.transforms, 4);
+	EXPECT_DOUBLE_EQ(liboceanlight::models::acmr(stats), 2.0);
+	EXPECT_DOUBLE_EQ(liboceanlight::models::atvr(stats), 1.0);
+}
+
+TEST(mesh_optimizer_tests, optimize_mesh_improves_acmr)
+{
+	std::vector<vertex> vertices;
+	std::vector<uint32_t> indices;
+	make_shuffled_grid(64, vertices, indices);
+
+	const auto expected {triangle_set(vertices, indices)};
+	const auto stats {liboceanlight::models::optimize_mesh(vertices, indices)};
+
+	EXPECT_GT(liboceanlight::models::acmr(stats.before), 2.5);
+	EXPECT_LT(liboceanlight::models::acmr(stats.after), 1.0);
+	EXPECT_LT(liboceanlight::models::atvr(stats.after), 1.5);
+	EXPECT_EQ(triangle_set(vertices, indices), expected);
+}
+
+TEST(mesh_optimizer_tests, vertex_fetch_follows_first_use)
+{
+	std::vector<vertex> vertices {
+		make_vertex(0.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+		make_vertex(1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+		make_vertex(2.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+		make_vertex(3.0f, 0.0f, 0.0f, 0.0f, 0.0f)};
+	std::vector<uint32_t> indices {3, 1, 0};
+
+	liboceanlight::models::optimize_vertex_fetch(vertices, indices);
+
+	/* The unreferenced vertex is dropped */
+	ASSERT_EQ(vertices.size(), 3);
+	EXPECT_EQ(indices, (std::vector<uint32_t> {0, 1, 2}));
+	EXPECT_EQ(vertices[0].pos.x, 3.0f);
+	EXPECT_EQ(vertices[1].pos.x, 1.0f);
+	EXPECT_EQ(vertices[2].pos.x, 0.0f);
+}
+
+TEST(vertex_format_tests, layouts_generate_attribute_descs)
+{
+	using liboceanlight::engine::packed_vertex;
+
+	constexpr auto full {vertex::get_attribute_descs()};
+	static_assert(full[1].location == 1 && full[1].offset == 12);
+	static_assert(vertex::get_binding_desc().stride == 32);
+
+	constexpr auto packed {packed_vertex::get_attribute_descs()};
+	static_assert(packed.size() == 2);
+	static_assert(packed_vertex::get_binding_desc().stride == 12);
+
+	EXPECT_EQ(packed[0].format, VK_FORMAT_R16G16B16A16_UNORM);
+	EXPECT_EQ(packed[1].location, 2);
+	EXPECT_EQ(packed[1].format, VK_FORMAT_R16G16_UNORM);
+	EXPECT_EQ(packed[1].offset, 8);
+}
+
+TEST(vertex_format_tests, pack_vertices_dequantizes_within_bounds)
+{
+	const std::vector<vertex> vertices {
+		make_vertex(-1.0f, 2.0f, 0.5f, 0.0f, 0.25f),
+		make_vertex(3.0f, 4.0f, 0.5f, 1.0f, 0.75f),
+		make_vertex(0.3f, 2.7f, 0.5f, 0.5f, 1.0f)};
+
+	liboceanlight::engine::vertex_quantization quant {};
+	const auto packed {liboceanlight::models::pack_vertices(vertices, quant)};
+	ASSERT_EQ(packed.size(), vertices.size());
+
+	for (size_t i {0}; i < vertices.size(); ++i)
+	{
+		for (int axis {0}; axis < 3; ++axis)
+		{
+			const float unorm {packed[i].pos[axis] / 65535.0f};
+			const float pos {quant.offset[axis] + unorm * quant.scale[axis]};
+			EXPECT_NEAR(pos, vertices[i].pos[axis], 1e-4f);
+		}
+
+		for (int axis {0}; axis < 2; ++axis)
+		{
+			const float unorm {packed[i].texcoord[axis] / 65535.0f};
+			const float uv {quant.texcoord[axis] +
+							unorm * quant.texcoord[axis + 2]};
+			EXPECT_NEAR(uv, vertices[i].texcoord[axis], 1e-4f);
+		}
+	}
+}
+
+TEST(vertex_format_tests, texcoords_stay_within_an_eighth_of_a_texel)
+{
+	/* The widest span still packed, at the 2048 texel size the limit is
+	 * set for */
+	constexpr float texels {2048.0f};
+	const float span {liboceanlight::models::packed_texcoord_span};
+	std::mt19937 rng {7};
+	std::uniform_real_distribution<float> uv {-3.0f, -3.0f + span};
+	std::vector<vertex> vertices {make_vertex(0, 0, 0, -3.0f, -3.0f),
+								  make_vertex(1, 1, 1, -3.0f + span, 1.0f)};
+	for (int i {0}; i < 4096; ++i)
+	{
+		vertices.push_back(make_vertex(0, 0, 0, uv(rng), uv(rng)));
+	}
+
+	ASSERT_EQ(liboceanlight::models::choose_vertex_format(
+				  vertices, liboceanlight::engine::vertex_format::packed),
+			  liboceanlight::engine::vertex_format::packed);
+
+	liboceanlight::engine::vertex_quantization quant {};
+	const auto packed {liboceanlight::models::pack_vertices(vertices, quant)};
+	float worst {0.0f};
+	for (size_t i {0}; i < vertices.size(); ++i)
+	{
+		for (int axis {0}; axis < 2; ++axis)
+		{
+			const float unorm {packed[i].texcoord[axis] / 65535.0f};
+			const float uv {quant.texcoord[axis] +
+							unorm * quant.texcoord[axis + 2]};
+			worst = std::max(
+				worst, std::fabs(uv - vertices[i].texcoord[axis]) * texels);
+		}
+	}
+
+	/* Half a quantization step, and a little float rounding */
+	EXPECT_LE(worst, 0.13f);
+}
+
+TEST(vertex_format_tests, tiled_texcoords_stay_full)
+{
+	using liboceanlight::engine::vertex_format;
+	std::vector<vertex> vertices {make_vertex(0.0f, 0.0f, 0.0f, 0.5f, 0.5f)};
+
+	EXPECT_EQ(liboceanlight::models::choose_vertex_format(
+				  vertices, vertex_format::packed),
+			  vertex_format::packed);
+
+	vertices.push_back(make_vertex(0.0f, 0.0f, 0.0f, 16.0f, 0.0f));
+	EXPECT_EQ(liboceanlight::models::choose_vertex_format(
+				  vertices, vertex_format::packed),
+			  vertex_format::full);
+}
+
+TEST(index_packing_tests, small_meshes_use_one_16_bit_draw)
+{
+	liboceanlight::models::lol_model model {};
+	model.indices = {0, 1, 2, 2, 1, 3};
+
+	liboceanlight::models::choose_index_type(model, true, 64);
+
+	EXPECT_EQ(model.index_type, VK_INDEX_TYPE_UINT16);
+	ASSERT_EQ(model.draws.size(), 1);
+	EXPECT_EQ(model.draws[0].index_count, 6);
+	EXPECT_EQ(model.draws[0].vertex_offset, 0);
+}
+
+TEST(index_packing_tests, large_meshes_split_into_rebased_draws)
+{
+	/* Triangle strips of fresh vertices, 100000 vertices in total */
+	std::vector<uint32_t> indices;
+	for (uint32_t v {0}; v + 2 < 100000; ++v)
+	{
+		indices.insert(indices.end(), {v, v + 1, v + 2});
+	}
+
+	const auto draws {liboceanlight::models::split_index16(indices)};
+	ASSERT_EQ(draws.size(), 2);
+	EXPECT_EQ(draws[0].first_index, 0);
+	EXPECT_EQ(draws[1].first_index, draws[0].index_count);
+	EXPECT_EQ(draws[0].index_count + draws[1].index_count, indices.size());
+
+	const auto packed {
+		liboceanlight::models::pack_indices16(indices, draws)};
+	for (const auto& draw : draws)
+	{
+		for (uint32_t i {draw.first_index};
+			 i < draw.first_index + draw.index_count;
+			 ++i)
+		{
+			ASSERT_EQ(packed[i] + static_cast<uint32_t>(draw.vertex_offset),
+					  indices[i]);
+		}
+	}
+}
+
+TEST(index_packing_tests, falls_back_to_32_bit)
+{
+	liboceanlight::models::lol_model model {};
+	model.indices = {0, 70000, 1};
+
+	liboceanlight::models::choose_index_type(model, true, 64);
+	EXPECT_EQ(model.index_type, VK_INDEX_TYPE_UINT32);
+	ASSERT_EQ(model.draws.size(), 1);
+	EXPECT_EQ(model.draws[0].index_count, 3);
+
+	model.indices = {0, 1, 2};
+	liboceanlight::models::choose_index_type(model, false, 64);
+	EXPECT_EQ(model.index_type, VK_INDEX_TYPE_UINT32);
+}
+
+TEST(gltf_tests, loads_indexed_primitives_with_node_transforms)
+{
+	const std::array<float, 9> positions {
+		0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f};
+	const std::array<uint16_t, 3> triangle {0, 1, 2};
+
+	std::string bin(sizeof(positions) + sizeof(triangle), '\0');
+	std::memcpy(bin.data(), positions.data(), sizeof(positions));
+	std::memcpy(bin.data() + sizeof(positions),
+				triangle.data(),
+				sizeof(triangle));
+
+	const std::string json {
+		R"({"asset":{"version":"2.0"},"scene":0,)"
+		R"("scenes":[{"nodes":[0]}],)"
+		R"("nodes":[{"translation":[1,2,3],"children":[1]},{"mesh":0}],)"
+		R"("meshes":[{"primitives":[{"attributes":{"POSITION":0},)"
+		R"("indices":1}]}],)"
+		R"("buffers":[{"byteLength":42}],)"
+		R"("bufferViews":[{"buffer":0,"byteOffset":0,"byteLength":36},)"
+		R"({"buffer":0,"byteOffset":36,"byteLength":6}],)"
+		R"("accessors":[{"bufferView":0,"componentType":5126,"count":3,)"
+		R"("type":"VEC3","min":[0,0,0],"max":[1,1,0]},)"
+		R"({"bufferView":1,"componentType":5123,"count":3,)"
+		R"("type":"SCALAR"}]})"};
+
+	const auto path {(std::filesystem::temp_directory_path() /
+					  "lol_mesh_test_triangle.glb")
+						 .string()};
+	write_glb(path, json, bin);
+
+	std::vector<vertex> vertices;
+	std::vector<uint32_t> indices;
+	liboceanlight::models::load_gltf(path, vertices, indices);
+	std::filesystem::remove(path);
+
+	ASSERT_EQ(vertices.size(), 3);
+	EXPECT_EQ(indices, (std::vector<uint32_t> {0, 1, 2}));
+
+	/* The parent's translation is baked into the child's mesh */
+	EXPECT_FLOAT_EQ(vertices[1].pos.x, 2.0f);
+	EXPECT_FLOAT_EQ(vertices[1].pos.y, 2.0f);
+	EXPECT_FLOAT_EQ(vertices[1].pos.z, 3.0f);
+	EXPECT_FLOAT_EQ(vertices[2].pos.y, 3.0f);
+}
+
+TEST(obj_parser_tests, chunk_size_does_not_change_the_mesh)
+{
+	/* A quad with relative indices and an n-gon that fans into two
+	 * triangles, plus comments, CRLF and a missing final newline */
+	const std::string obj {"# quad\r\n"
+						   "v 0 0 0\r\nv 1 0 0\r\nv 1 1 0\r\nv 0 1 0\r\n"
+						   "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+						   "vn 0 0 1\n"
+						   "f -4/-4/1 -3/-3/1 -2/-2/1 -1/-1/1\n"
+						   "v +2 0 0\n"
+						   "f 2//1 5//1 3//1"};
+	const std::span<const std::byte> bytes {
+		reinterpret_cast<const std::byte*>(obj.data()), obj.size()};
+
+	std::vector<vertex> expected_vertices;
+	std::vector<uint32_t> expected_indices;
+	for (size_t chunk_bytes : {size_t {1}, size_t {7}, obj.size()})
+	{
+		std::vector<liboceanlight::models::obj_chunk> chunks;
+		for (auto range :
+			 liboceanlight::models::split_obj_chunks(bytes, chunk_bytes))
+		{
+			chunks.push_back(
+				liboceanlight::models::parse_obj_chunk(range, "test.obj"));
+		}
+
+		std::vector<vertex> vertices;
+		std::vector<uint32_t> indices;
+		liboceanlight::models::weld_obj_chunks(
+			chunks, "test.obj", vertices, indices);
+
+		if (expected_indices.empty())
+		{
+			expected_vertices = vertices;
+			expected_indices = indices;
+			continue;
+		}
+
+		ASSERT_EQ(vertices.size(), expected_vertices.size());
+		EXPECT_EQ(std::memcmp(vertices.data(),
+							  expected_vertices.data(),
+							  vertices.size() * sizeof(vertex)),
+				  0);
+		EXPECT_EQ(indices, expected_indices);
+	}
+
+	/* Four textured corners plus three untextured ones */
+	ASSERT_EQ(expected_vertices.size(), 7);
+	EXPECT_EQ(expected_indices,
+			  (std::vector<uint32_t> {0, 1, 2, 0, 2, 3, 4, 5, 6}));
+	EXPECT_FLOAT_EQ(expected_vertices[2].texcoord.y, 0.0f);
+	EXPECT_FLOAT_EQ(expected_vertices[5].pos.x, 2.0f);
+}
+
+TEST(obj_parser_tests, bad_chunk_fails_the_load_cleanly)
+{
+	/* Many chunks parsing on a pool when one of them throws: the load
+	 * must wait for the others before unwinding what they read */
+	const auto path {(std::filesystem::temp_directory_path() /
+					  "lol_bad_chunk.obj")
+						 .string()};
+	{
+		std::ofstream file {path};
+		for (int i {0}; i < 4000; ++i)
+		{
+			file << "v " << i << " 0 0\nv " << i << " 1 0\nv " << i
+				 << " 0 1\nf -3 -2 -1\n";
+			if (i == 1000)
+			{
+				file << "f 0 1 2\n";
+			}
+		}
+	}
+
+	liboceanlight::thread_pool pool {4};
+	liboceanlight::models::load_options options {};
+	options.pool = &pool;
+	options.split_bytes = 256;
+	options.use_cache = false;
+	options.optimize = false;
+	options.lods = false;
+
+	std::vector<liboceanlight::models::lol_model> models;
+	EXPECT_THROW(
+		liboceanlight::models::load_model_files({path}, models, options),
+		std::runtime_error);
+	std::filesystem::remove(path);
+}
+
+TEST(mesh_lod_tests, flat_grid_simplifies_without_error)
+{
+	std::vector<vertex> vertices;
+	std::vector<uint32_t> indices;
+	make_shuffled_grid(32, vertices, indices);
+
+	float error {-1.0f};
+	const auto simplified {liboceanlight::models::simplify_mesh(
+		indices, vertices, indices.size() / 8, 1.0f, error)};
+
+	EXPECT_LE(simplified.size(), indices.size() / 8);
+	EXPECT_LT(error, 1e-3f);
+
+	/* Still covers the grid, facing the same way */
+	float area {0.0f};
+	for (size_t i {0}; i < simplified.size(); i += 3)
+	{
+		const auto& p0 {vertices[simplified[i]].pos};
+		const auto& p1 {vertices[simplified[i + 1]].pos};
+		const auto& p2 {vertices[simplified[i + 2]].pos};
+		const float z {glm::cross(p1 - p0, p2 - p0).z};
+		EXPECT_GT(z, 0.0f);
+		area += 0.5f * z;
+	}
+	EXPECT_NEAR(area, 32.0f * 32.0f, 1e-2f);
+}
+
+TEST(mesh_lod_tests, lod_chain_shrinks_and_accumulates_error)
+{
+	std::vector<vertex> vertices;
+	std::vector<uint32_t> indices;
+	make_shuffled_grid(64, vertices, indices);
+	for (auto& v : vertices)
+	{
+		v.pos.z = std::sin(v.pos.x * 0.3f) * std::cos(v.pos.y * 0.2f);
+	}
+
+	const size_t full {indices.size()};
+	const auto lods {liboceanlight::models::build_lods(vertices, indices)};
+
+	ASSERT_GT(lods.size(), 2);
+	EXPECT_EQ(lods[0].first_index, 0);
+	EXPECT_EQ(lods[0].index_count, full);
+	EXPECT_EQ(lods[0].error, 0.0f);
+	for (size_t i {1}; i < lods.size(); ++i)
+	{
+		EXPECT_EQ(lods[i].first_index,
+				  lods[i - 1].first_index + lods[i - 1].index_count);
+		EXPECT_LT(lods[i].index_count, lods[i - 1].index_count);
+		EXPECT_GT(lods[i].error, lods[i - 1].error);
+	}
+	EXPECT_EQ(indices.size(),
+			  lods.back().first_index + lods.back().index_count);
+}
+
+TEST(mesh_lod_tests, selection_coarsens_with_distance)
+{
+	const std::vector<liboceanlight::models::mesh_lod> lods {
+		{0, 300, 0.0f}, {300, 150, 0.01f}, {450, 60, 0.1f}};
+	const glm::vec4 bounds {0.0f, 0.0f, 0.0f, 1.0f};
+	const float pixels_per_radian {500.0f};
+
+	auto at {[&](float distance) {
+		glm::mat4 model_view {1.0f};
+		model_view[3] = glm::vec4 {0.0f, 0.0f, -distance, 1.0f};
+		return liboceanlight::models::select_lod(
+			lods, bounds, model_view, pixels_per_radian, 1.0f);
+	}};
+
+	EXPECT_EQ(at(0.5f), 0);
+	EXPECT_EQ(at(3.0f), 0);
+	EXPECT_EQ(at(10.0f), 1);
+	EXPECT_EQ(at(100.0f), 2);
+}
+
+TEST(mesh_cache_tests, round_trips_and_rejects_stale_sources)
+{
+	namespace fs = std::filesystem;
+	const auto path {(fs::temp_directory_path() / "lol_cached.obj").string()};
+	const auto write_source {[&](const char* text) {
+		std::ofstream file {path, std::ios::binary | std::ios::trunc};
+		file << text;
+	}};
+	write_source("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n");
+
+	std::vector<vertex> vertices;
+	std::vector<uint32_t> indices;
+	make_shuffled_grid(4, vertices, indices);
+	const std::vector<liboceanlight::models::mesh_lod> lods {
+		{0, static_cast<uint32_t>(indices.size()), 0.0f}, {0, 6, 0.1f}};
+
+	liboceanlight::models::mesh_cache_key key {};
+	liboceanlight::models::map_mesh_source(path, key);
+	liboceanlight::models::write_mesh_cache(
+		path, key, 0, vertices, indices, lods);
+
+	std::vector<vertex> cached_vertices;
+	std::vector<uint32_t> cached_indices;
+	std::vector<liboceanlight::models::mesh_lod> cached_lods;
+	const auto read {[&](uint64_t cook_flags) {
+		return liboceanlight::models::read_mesh_cache(path,
+													  cook_flags,
+													  cached_vertices,
+													  cached_indices,
+													  cached_lods);
+	}};
+	ASSERT_TRUE(read(0));
+	ASSERT_EQ(cached_vertices.size(), vertices.size());
+	EXPECT_EQ(std::memcmp(cached_vertices.data(),
+						  vertices.data(),
+						  vertices.size() * sizeof(vertex)),
+			  0);
+	EXPECT_EQ(cached_indices, indices);
+	ASSERT_EQ(cached_lods.size(), lods.size());
+	EXPECT_EQ(cached_lods[1].index_count, 6u);
+	EXPECT_FALSE(read(liboceanlight::models::mesh_cook_lods));
+
+	/* Touched with the same bytes is still current */
+	fs::last_write_time(path,
+						fs::last_write_time(path) + std::chrono::seconds {2});
+	EXPECT_TRUE(read(0));
+
+	/* Same size, new bytes and mtime */
+	write_source("v 0 0 0\nv 2 0 0\nv 0 1 0\nf 1 2 3\n");
+	fs::last_write_time(path,
+						fs::last_write_time(path) + std::chrono::seconds {4});
+	EXPECT_FALSE(read(0));
+
+	/* An index past the end of the vertices */
+	auto bad_indices {indices};
+	bad_indices.back() = static_cast<uint32_t>(vertices.size());
+	liboceanlight::models::map_mesh_source(path, key);
+	liboceanlight::models::write_mesh_cache(
+		path, key, 0, vertices, bad_indices, lods);
+	EXPECT_FALSE(read(0));
+
+	/* A LOD past the end of the indices */
+	liboceanlight::models::map_mesh_source(path, key);
+	liboceanlight::models::write_mesh_cache(
+		path, key, 0, vertices, indices, {{6, 1000, 0.0f}});
+	EXPECT_FALSE(read(0));
+
+	fs::remove(path);
+	fs::remove(liboceanlight::models::mesh_cache_path(path));
+}
@@ -0,0 +1,318 @@
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <liboceanlight/lol_block_compress.hpp>
+#include <liboceanlight/lol_image_batch.hpp>
+#include <liboceanlight/lol_mipmap.hpp>
+#include <liboceanlight/lol_texture_cache.hpp>
+#include <liboceanlight/lol_texture_residency.hpp>
+#include <liboceanlight/lol_thread_pool.hpp>
+#include <random>
+#include <vector>
+
+using liboceanlight::textures::build_mip_chain;
+using liboceanlight::textures::mip_level_count;
+
+TEST(mipmap_tests, level_count_reaches_one_texel)
+{
+	EXPECT_EQ(mip_level_count(1, 1), 1u);
+	EXPECT_EQ(mip_level_count(1024, 512), 11u);
+	EXPECT_EQ(mip_level_count(3, 5), 3u);
+}
+
+TEST(mipmap_tests, box_filters_each_level)
+{
+	/* 2x2 of 10, 20, 30, 50 in every channel */
+	std::vector<uint8_t> rgba;
+	for (uint8_t value : {10, 20, 30, 50})
+	{
+		rgba.insert(rgba.end(), 4, value);
+	}
+
+	const auto chain {build_mip_chain(rgba, 2, 2, false, nullptr)};
+	ASSERT_EQ(chain.levels.size(), 2u);
+	EXPECT_EQ(chain.levels[1].offset, 16u);
+	EXPECT_EQ(chain.levels[1].width, 1u);
+	EXPECT_EQ(chain.pixels.size(), 20u);
+	for (size_t c {0}; c < 4; ++c)
+	{
+		EXPECT_EQ(chain.pixels[16 + c], 28);
+	}
+}
+
+TEST(mipmap_tests, srgb_averages_in_linear_space)
+{
+	/* Black and white average to linear 0.5, which is sRGB 188. Alpha
+	 * is linear and averages to 128. */
+	const std::vector<uint8_t> rgba {0, 0, 0, 0, 255, 255, 255, 255,
+									 0, 0, 0, 0, 255, 255, 255, 255};
+	const auto chain {build_mip_chain(rgba, 2, 2, true, nullptr)};
+	EXPECT_EQ(chain.pixels[16], 188);
+	EXPECT_EQ(chain.pixels[19], 128);
+}
+
+TEST(mipmap_tests, pool_matches_the_calling_thread)
+{
+	constexpr uint32_t width {300}, height {200};
+	std::mt19937 rng {7};
+	std::uniform_int_distribution<int> byte {0, 255};
+	std::vector<uint8_t> rgba(width * height * 4);
+	for (auto& value : rgba)
+	{
+		value = static_cast<uint8_t>(byte(rng));
+	}
+
+	liboceanlight::thread_pool pool {4};
+	const auto serial {build_mip_chain(rgba, width, height, true, nullptr)};
+	const auto parallel {build_mip_chain(rgba, width, height, true, &pool)};
+	EXPECT_EQ(serial.levels.size(), mip_level_count(width, height));
+	EXPECT_EQ(serial.pixels, parallel.pixels);
+}
+
+namespace
+{
+	using liboceanlight::textures::texel_block;
+
+	/* Reference decode of the BC7 mode 6 blocks the encoder emits */
+	std::array<uint8_t, 64> decode_bc7_mode6(
+		const std::array<uint8_t, 16>& block)
+	{
+		size_t position {0};
+		auto take {[&](size_t bits) {
+			uint32_t value {0};
+			for (size_t i {0}; i < bits; ++i, ++position)
+			{
+				value |= ((block[position / 8] >> (position % 8)) & 1u) << i;
+			}
+
+			return value;
+		}};
+
+		EXPECT_EQ(take(7), 1u << 6);
+		std::array<std::array<uint32_t, 2>, 4> endpoints {};
+		for (auto& channel : endpoints)
+		{
+			channel = {take(7), take(7)};
+		}
+
+		const uint32_t p0 {take(1)}, p1 {take(1)};
+		constexpr std::array<uint32_t, 16> weights {
+			0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+		std::array<uint8_t, 64> texels {};
+		for (size_t t {0}; t < 16; ++t)
+		{
+			const uint32_t w {weights[take(t == 0 ? 3 : 4)]};
+			for (size_t c {0}; c < 4; ++c)
+			{
+				const uint32_t e0 {endpoints[c][0] * 2 + p0};
+				const uint32_t e1 {endpoints[c][1] * 2 + p1};
+				texels[t * 4 + c] = static_cast<uint8_t>(
+					((64 - w) * e0 + w * e1 + 32) >> 6);
+			}
+		}
+
+		return texels;
+	}
+} /* namespace */
+
+TEST(block_compress_tests, bc7_gradient_round_trips_closely)
+{
+	texel_block block {};
+	for (size_t t {0}; t < 16; ++t)
+	{
+		block[t * 4 + 0] = static_cast<uint8_t>(200 - t * 8);
+		block[t * 4 + 1] = static_cast<uint8_t>(40 + t * 5);
+		block[t * 4 + 2] = static_cast<uint8_t>(90);
+		block[t * 4 + 3] = static_cast<uint8_t>(255 - t * 3);
+	}
+
+	const auto decoded {decode_bc7_mode6(
+		liboceanlight::textures::encode_bc7_block(block))};
+	for (size_t i {0}; i < block.size(); ++i)
+	{
+		EXPECT_NEAR(decoded[i], block[i], 4) << "byte " << i;
+	}
+}
+
+TEST(block_compress_tests, bc4_keeps_the_extremes)
+{
+	texel_block block {};
+	for (size_t t {0}; t < 16; ++t)
+	{
+		block[t * 4] = static_cast<uint8_t>(t * 17);
+	}
+
+	const auto bc4 {liboceanlight::textures::encode_bc4_block(block, 0)};
+	EXPECT_EQ(bc4[0], 255);
+	EXPECT_EQ(bc4[1], 0);
+
+	/* Texel 0 is the low endpoint, index 1 */
+	EXPECT_EQ(bc4[2] & 7, 1);
+}
+
+TEST(texture_cache_tests, ktx2_round_trips)
+{
+	namespace fs = std::filesystem;
+	using namespace liboceanlight::textures;
+
+	std::vector<uint8_t> rgba(6 * 5 * 4);
+	for (size_t i {0}; i < rgba.size(); ++i)
+	{
+		rgba[i] = static_cast<uint8_t>(i * 7);
+	}
+
+	const auto mips {build_mip_chain(rgba, 6, 5, true, nullptr)};
+	const compressed_texture texture {
+		block_format(texture_kind::color),
+		compress_mip_chain(mips, texture_kind::color, nullptr)};
+	ASSERT_EQ(texture.chain.levels.size(), 3u);
+	EXPECT_EQ(texture.chain.levels[1].offset, 4u * 16);
+
+	texture_source source {};
+	source.size = 1234;
+	source.hash = 0xfeed;
+	const auto path {(fs::temp_directory_path() / "lol_test.ktx2").string()};
+	write_ktx2(path, texture, source);
+
+	texture_source read_source {};
+	const auto read {read_ktx2(path, read_source)};
+	fs::remove(path);
+
+	EXPECT_EQ(read.format, VK_FORMAT_BC7_SRGB_BLOCK);
+	EXPECT_EQ(read.chain.pixels, texture.chain.pixels);
+	ASSERT_EQ(read.chain.levels.size(), 3u);
+	EXPECT_EQ(read.chain.levels[2].width, 1u);
+	EXPECT_EQ(read_source.version, texture_cache_version);
+	EXPECT_EQ(read_source.size, 1234u);
+	EXPECT_EQ(read_source.hash, 0xfeedu);
+}
+
+TEST(image_batch_tests, slices_are_aligned_and_hold_every_level)
+{
+	using liboceanlight::textures::staged_image;
+
+	std::vector<staged_image> images(3);
+	images[0].levels = liboceanlight::textures::rgba_mip_levels(5, 3, 3);
+	images[0].size = 5 * 3 * 4 + 2 * 1 * 4 + 1 * 1 * 4;
+	images[1].levels = liboceanlight::textures::rgba_mip_levels(2, 2, 1);
+	images[1].size = 2 * 2 * 4;
+	images[2].size = 0; /* an image whose header could not be read */
+
+	ASSERT_EQ(images[0].levels.size(), 3u);
+	EXPECT_EQ(images[0].levels[1].offset, 60u);
+	EXPECT_EQ(images[0].levels[2].offset, 68u);
+	EXPECT_EQ(images[0].levels[2].width, 1u);
+
+	const size_t total {
+		liboceanlight::textures::layout_image_batch(images, 16)};
+	EXPECT_EQ(images[0].offset, 0u);
+	EXPECT_EQ(images[1].offset, 80u);
+	EXPECT_EQ(total, 96u);
+}
+
+TEST(image_batch_tests, unreadable_images_are_left_out)
+{
+	namespace fs = std::filesystem;
+	using liboceanlight::textures::staged_image;
+
+	std::vector<staged_image> images(1);
+	images[0].path = (fs::temp_directory_path() / "lol_missing.png").string();
+	liboceanlight::textures::read_image_headers(images, true, nullptr);
+	EXPECT_EQ(images[0].width, 0u);
+
+	std::vector<uint8_t> staging(16, 0xab);
+	liboceanlight::textures::decode_image_batch(images, staging, nullptr);
+	EXPECT_FALSE(images[0].decoded);
+	EXPECT_EQ(staging.front(), 0xab);
+}
+
+namespace
+{
+	liboceanlight::textures::mip_chain rgba_chain(uint32_t size)
+	{
+		liboceanlight::textures::mip_chain chain {};
+		chain.levels = liboceanlight::textures::rgba_mip_levels(
+			size, size, mip_level_count(size, size));
+		const auto& last {chain.levels.back()};
+		chain.pixels.resize(last.offset + size_t {last.width} * last.height *
+											  4);
+		return chain;
+	}
+} /* namespace */
+
+TEST(texture_residency_tests, levels_follow_screen_size)
+{
+	using liboceanlight::textures::screen_mip_level;
+
+	const auto chain {rgba_chain(256)};
+	EXPECT_EQ(liboceanlight::textures::first_level_within(chain.levels, 64),
+			  2u);
+	EXPECT_EQ(screen_mip_level(chain.levels, 1000.0f), 0u);
+	EXPECT_EQ(screen_mip_level(chain.levels, 128.0f), 1u);
+	EXPECT_EQ(screen_mip_level(chain.levels, 100.0f), 1u);
+	EXPECT_EQ(screen_mip_level(chain.levels, 0.0f), 8u);
+}
+
+TEST(texture_residency_tests, budget_drops_the_largest_levels_first)
+{
+	using liboceanlight::textures::plan_residency;
+	using liboceanlight::textures::resident_bytes;
+
+	const auto large {rgba_chain(256)};
+	const auto small {rgba_chain(64)};
+	const std::vector<liboceanlight::textures::residency_request> requests {
+		{&large, 2, 0},
+		{&small, 0, 0}};
+
+	const auto everything {plan_residency(requests, SIZE_MAX)};
+	EXPECT_EQ(everything, (std::vector<uint32_t> {0, 0}));
+
+	/* The large texture loses its top level before the small one loses
+	 * anything */
+	const size_t budget {resident_bytes(large, 1) + resident_bytes(small, 0)};
+	EXPECT_EQ(plan_residency(requests, budget),
+			  (std::vector<uint32_t> {1, 0}));
+
+	/* Each keeps at least its smallest level */
+	const auto starved {plan_residency(requests, 0)};
+	EXPECT_EQ(starved, (std::vector<uint32_t> {8, 6}));
+}
+
+TEST(texture_residency_tests, one_level_too_many_is_kept)
+{
+	const auto chain {rgba_chain(64)};
+	const std::vector<liboceanlight::textures::residency_request> requests {
+		{&chain, 2, 3},
+		{&chain, 2, 4}};
+
+	EXPECT_EQ(liboceanlight::textures::plan_residency(requests, SIZE_MAX),
+			  (std::vector<uint32_t> {2, 4}));
+}
+
+TEST(image_batch_tests, large_levels_split_between_rows)
+{
+	const auto levels {liboceanlight::textures::rgba_mip_levels(8, 8, 4)};
+	const size_t size {(64 + 16 + 4 + 1) * 4};
+
+	/* 32 bytes is one row of the largest level; each smaller level fits
+	 * in a piece */
+	const auto pieces {
+		liboceanlight::textures::split_image_copy(levels, size, 1, 64)};
+	ASSERT_EQ(pieces.size(), 4u + 1u + 1u + 1u);
+	EXPECT_EQ(pieces[1].offset, 64u);
+	EXPECT_EQ(pieces[1].y, 2u);
+	EXPECT_EQ(pieces[1].height, 2u);
+	EXPECT_EQ(pieces[4].level, 1u);
+	EXPECT_EQ(pieces[4].size, 64u);
+	EXPECT_EQ(pieces[6].offset + pieces[6].size, size);
+
+	/* A band of blocks never ends past the level */
+	const std::vector<liboceanlight::textures::mip_level> bc7 {{0, 10, 10}};
+	const auto blocks {
+		liboceanlight::textures::split_image_copy(bc7, 9 * 16, 4, 48)};
+	ASSERT_EQ(blocks.size(), 3u);
+	EXPECT_EQ(blocks[2].y, 8u);
+	EXPECT_EQ(blocks[2].height, 2u);
+	EXPECT_EQ(blocks[2].offset, 96u);
+}
@@ -1,6 +1,17 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
 #include <gtest/gtest.h>
+#include <latch>
+#include <liboceanlight/lol_asset_stream.hpp>
 #include <liboceanlight/lol_engine.hpp>
+#include <liboceanlight/lol_file_watcher.hpp>
+#include <liboceanlight/lol_range_allocator.hpp>
 #include <liboceanlight/lol_utility.hpp>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
 
 // Demonstrate some basic assertions.
 TEST(HelloTest, BasicAssertions)
@@ -17,6 +28,84 @@ TEST(basic_tests, test_func_returns_a_plus_b)
 	EXPECT_EQ(liboceanlight::test_func(a, b), a + b);
 }
 
+TEST(hash_tests, hash_bytes_matches_xxh64_reference)
+{
+	const std::string abc {"abc"};
+	std::vector<std::byte> sequence(100);
+	for (size_t i {0}; i < sequence.size(); ++i)
+	{
+		sequence[i] = static_cast<std::byte>(i);
+	}
+
+	EXPECT_EQ(liboceanlight::hash_bytes({}), 0xEF46DB3751D8E999ull);
+	EXPECT_EQ(liboceanlight::hash_bytes(std::as_bytes(std::span {abc})),
+			  0x44BC2CF5AD770999ull);
+	EXPECT_EQ(liboceanlight::hash_bytes(sequence), 0x6AC1E58032166597ull);
+}
+
+TEST(hash_tests, hash_bytes_depends_on_seed)
+{
+	const std::string abc {"abc"};
+	auto bytes {std::as_bytes(std::span {abc})};
+	EXPECT_NE(liboceanlight::hash_bytes(bytes, 0),
+			  liboceanlight::hash_bytes(bytes, 1));
+}
+
+TEST(file_watcher_tests, reports_written_and_renamed_files)
+{
+	namespace fs = std::filesystem;
+	const auto dir {fs::temp_directory_path() / "lol_file_watcher_test"};
+	fs::remove_all(dir);
+	fs::create_directories(dir);
+
+	liboceanlight::file_watcher watcher {};
+	watcher.watch(dir.string());
+	EXPECT_TRUE(watcher.poll().empty());
+
+	std::ofstream {dir / "model.obj"} << "v 0 0 0\n";
+	std::ofstream {dir / "shader.spv.tmp"} << "spirv";
+	fs::rename(dir / "shader.spv.tmp", dir / "shader.spv");
+
+#ifndef __linux__
+	std::this_thread::sleep_for(liboceanlight::file_watcher::scan_interval);
+#endif /* __linux__ */
+	const auto changed {watcher.poll()};
+	fs::remove_all(dir);
+
+	EXPECT_NE(std::find(changed.begin(),
+						changed.end(),
+						(dir / "model.obj").string()),
+			  changed.end());
+	EXPECT_NE(std::find(changed.begin(),
+						changed.end(),
+						(dir / "shader.spv").string()),
+			  changed.end());
+}
+
+TEST(asset_stream_tests, take_stays_within_the_byte_budget)
+{
+	std::latch loaded {1};
+	liboceanlight::asset_stream stream {
+		4, [&](std::stop_token, liboceanlight::asset_stream& s) {
+			for (size_t bytes : {10, 10, 30})
+			{
+				s.push({bytes, [] { return [] {}; }});
+			}
+
+			s.skip();
+			loaded.count_down();
+		}};
+	loaded.wait();
+
+	EXPECT_EQ(stream.take(25).size(), 2u);
+	EXPECT_FALSE(stream.done());
+
+	/* Over budget on its own, still taken so nothing starves */
+	EXPECT_EQ(stream.take(25).size(), 1u);
+	EXPECT_TRUE(stream.done());
+	EXPECT_TRUE(stream.take(25).empty());
+}
+
 /*
 const char** glfwGetRequiredInstanceExtensions(uint32_t* count)
 {
@@ -42,3 +131,109 @@ TEST(basic_tests, create_instance_creates_instance)
 		liboceanlight::engine::create_instance(inst_data, dbg_data));
 	EXPECT_TRUE(inst_data.vulkan_instance);*/
 }
+
+TEST(range_allocator_tests, freed_neighbours_merge)
+{
+	liboceanlight::range_allocator ranges {1024};
+	const auto a {ranges.allocate(256)};
+	const auto b {ranges.allocate(256)};
+	const auto c {ranges.allocate(256)};
+	EXPECT_EQ(a, 0u);
+	EXPECT_EQ(b, 256u);
+	EXPECT_EQ(c, 512u);
+	EXPECT_EQ(ranges.allocate(512), liboceanlight::range_allocator::npos);
+
+	ranges.free(a, 256);
+	ranges.free(c, 256);
+	EXPECT_EQ(ranges.free_ranges(), 2u);
+	ranges.free(b, 256);
+	EXPECT_EQ(ranges.free_ranges(), 1u);
+	EXPECT_TRUE(ranges.empty());
+	EXPECT_EQ(ranges.allocate(1024), 0u);
+}
+
+TEST(range_allocator_tests, picks_the_smallest_fit_and_aligns)
+{
+	liboceanlight::range_allocator ranges {1024};
+	const auto a {ranges.allocate(100)};
+	ranges.allocate(10);
+	const auto b {ranges.allocate(40)};
+	ranges.allocate(10);
+	ranges.free(a, 100);
+	ranges.free(b, 40);
+
+	/* The 40 byte hole, not the 100 byte one or the tail */
+	EXPECT_EQ(ranges.allocate(32), b);
+
+	const auto aligned {ranges.allocate(16, 256)};
+	EXPECT_EQ(aligned % 256, 0u);
+	EXPECT_EQ(ranges.used(), 10u + 32u + 10u + 16u);
+}
+
+TEST(range_allocator_tests, aligns_to_vertex_strides)
+{
+	/* Geometry pools align to the 12 and 32 byte vertex strides */
+	liboceanlight::range_allocator ranges {1024};
+	EXPECT_EQ(ranges.allocate(5), 0u);
+	EXPECT_EQ(ranges.allocate(24, 12), 12u);
+	EXPECT_EQ(ranges.allocate(64, 32), 64u);
+	EXPECT_EQ(ranges.allocate(12, 12), 36u);
+}
+
+TEST(range_allocator_tests, grow_keeps_ranges_and_merges_the_tail)
+{
+	liboceanlight::range_allocator ranges {1024};
+	const auto a {ranges.allocate(512)};
+	const auto b {ranges.allocate(256)};
+	EXPECT_EQ(ranges.allocate(512), liboceanlight::range_allocator::npos);
+
+	/* The free 256 bytes at the end run on into the new space */
+	ranges.grow(2048);
+	EXPECT_EQ(ranges.capacity(), 2048u);
+	EXPECT_EQ(ranges.used(), 768u);
+	EXPECT_EQ(ranges.free_ranges(), 1u);
+	EXPECT_EQ(ranges.allocate(1280), 768u);
+
+	ranges.free(a, 512);
+	ranges.free(b, 256);
+	ranges.free(768, 1280);
+	EXPECT_TRUE(ranges.empty());
+	EXPECT_EQ(ranges.allocate(2048), 0u);
+}
+
+TEST(range_allocator_tests, linear_resets_when_empty)
+{
+	liboceanlight::linear_allocator linear {256};
+	EXPECT_EQ(linear.allocate(100), 0u);
+	EXPECT_EQ(linear.allocate(100, 64), 128u);
+	EXPECT_EQ(linear.allocate(100), liboceanlight::linear_allocator::npos);
+
+	linear.free(100);
+	EXPECT_EQ(linear.allocate(100), liboceanlight::linear_allocator::npos);
+	linear.free(100);
+	EXPECT_TRUE(linear.empty());
+	EXPECT_EQ(linear.allocate(200), 0u);
+}
+
+TEST(range_allocator_tests, ring_reuses_completed_submissions)
+{
+	liboceanlight::ring_allocator ring {256};
+	EXPECT_EQ(ring.allocate(100), 0u);
+	ring.submit(1);
+	EXPECT_EQ(ring.allocate(100, 64), 128u);
+	ring.submit(2);
+
+	/* Would wrap onto the first submission's bytes */
+	EXPECT_EQ(ring.allocate(100), liboceanlight::ring_allocator::npos);
+	EXPECT_EQ(ring.oldest_pending(), 1u);
+
+	ring.complete(1);
+	EXPECT_EQ(ring.allocate(100), 0u);
+	ring.submit(3);
+	ring.complete(3);
+	EXPECT_EQ(ring.oldest_pending(), 0u);
+	EXPECT_EQ(ring.used(), 0u);
+
+	/* An idle ring starts over, so the whole of it fits */
+	EXPECT_EQ(ring.allocate(256), 0u);
+}